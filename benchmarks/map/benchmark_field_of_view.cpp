@@ -0,0 +1,230 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "map/field_of_view.h"
+
+namespace {
+
+constexpr int max_obstacle_difference = 1; //as in MapSight
+
+/// A window of the map around a sight source, with randomly placed obstacles
+struct sight_window final
+{
+	explicit sight_window(const int range, const int footprint_size, const int obstacle_percent)
+		: range(range), footprint_size(footprint_size), size(footprint_size + range * 2), obstacles(size * size, 0)
+	{
+		std::mt19937 random_engine(1);
+		std::uniform_int_distribution<int> percent_distribution(0, 99);
+
+		for (unsigned char &obstacle : this->obstacles) {
+			obstacle = percent_distribution(random_engine) < obstacle_percent ? 1 : 0;
+		}
+	}
+
+	/// Call a function for each tile of the sight circle stretched over the footprint, in the middle of the window, as MapSight does
+	template <typename function_type>
+	void for_each_sight_tile(const function_type &function) const
+	{
+		const int pos = this->range;
+
+		for (int y = 0; y < this->size; ++y) {
+			int offset_x = this->range;
+			if (y < pos) {
+				offset_x = static_cast<int>(std::sqrt((this->range + 1) * (this->range + 1) - (y - pos) * (y - pos) - 1));
+			} else if (y >= pos + this->footprint_size) {
+				offset_x = static_cast<int>(std::sqrt((this->range + 1) * (this->range + 1) - (y - pos - this->footprint_size + 1) * (y - pos - this->footprint_size + 1) - 1));
+			}
+
+			for (int x = std::max(0, pos - offset_x); x < std::min(this->size, pos + this->footprint_size + offset_x); ++x) {
+				function(x, y);
+			}
+		}
+	}
+
+	/// Check the line between two tiles as CheckObstaclesBetweenTiles does, walking it step by step
+	bool check_obstacles_between_tiles(const int unit_x, const int unit_y, const int goal_x, const int goal_y) const
+	{
+		const int delta_x = std::abs(goal_x - unit_x);
+		const int delta_y = std::abs(goal_y - unit_y);
+		const int sign_x = unit_x < goal_x ? 1 : -1;
+		const int sign_y = unit_y < goal_y ? 1 : -1;
+		int error = delta_x - delta_y;
+		int x = unit_x;
+		int y = unit_y;
+
+		while (x != goal_x || y != goal_y) {
+			const int error2 = error * 2;
+
+			if (error2 > -delta_y) {
+				error -= delta_y;
+				x += sign_x;
+			}
+			if (error2 < delta_x) {
+				error += delta_x;
+				y += sign_y;
+			}
+
+			if (x < 0 || y < 0 || x >= this->size || y >= this->size) {
+				continue;
+			}
+
+			if (this->obstacles[x + y * this->size] != 0 && (x != goal_x || y != goal_y) && (std::abs(x - goal_x) > max_obstacle_difference || std::abs(y - goal_y) > max_obstacle_difference)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// Get the visible tiles with the rule MapSight used before the field of view: a tile is visible if the line from any tile of the footprint to it is clear
+	std::vector<unsigned char> get_visible_tiles_by_line_checks() const
+	{
+		std::vector<unsigned char> visible(this->size * this->size, 0);
+
+		this->for_each_sight_tile([&](const int x, const int y) {
+			for (int footprint_x = 0; footprint_x < this->footprint_size; ++footprint_x) {
+				for (int footprint_y = 0; footprint_y < this->footprint_size; ++footprint_y) {
+					if (this->check_obstacles_between_tiles(this->range + footprint_x, this->range + footprint_y, x, y)) {
+						visible[x + y * this->size] = 1;
+						return;
+					}
+				}
+			}
+		});
+
+		return visible;
+	}
+
+	/// Get the visible tiles with the field of view, as MapSight does
+	std::vector<unsigned char> get_visible_tiles_by_field_of_view() const
+	{
+		wyrmgus::field_of_view field_of_view(0, 0, this->size, this->size);
+
+		for (int y = 0; y < this->size; ++y) {
+			for (int x = 0; x < this->size; ++x) {
+				if (this->obstacles[x + y * this->size] != 0) {
+					field_of_view.set_obstacle(x, y);
+				}
+			}
+		}
+
+		field_of_view.set_footprint(this->range, this->range, this->footprint_size, this->footprint_size, max_obstacle_difference);
+
+		std::vector<unsigned char> visible(this->size * this->size, 0);
+		this->for_each_sight_tile([&](const int x, const int y) {
+			visible[x + y * this->size] = field_of_view.is_visible(x, y) ? 1 : 0;
+		});
+
+		return visible;
+	}
+
+	const int range;
+	const int footprint_size;
+	const int size;
+	std::vector<unsigned char> obstacles;
+};
+
+/**
+**	@brief	Check that the field of view gives the same visible tiles as the line checks, reporting the tiles which differ
+*/
+bool compare_visible_tiles(benchmark::State &state, const sight_window &window)
+{
+	const std::vector<unsigned char> old_visible = window.get_visible_tiles_by_line_checks();
+	const std::vector<unsigned char> new_visible = window.get_visible_tiles_by_field_of_view();
+
+	int sight_tiles = 0;
+	int visible_tiles = 0;
+	int extra_tiles = 0;
+	int missed_tiles = 0;
+	window.for_each_sight_tile([&](const int x, const int y) {
+		const int index = x + y * window.size;
+		++sight_tiles;
+		visible_tiles += old_visible[index];
+		extra_tiles += (new_visible[index] && !old_visible[index]) ? 1 : 0;
+		missed_tiles += (old_visible[index] && !new_visible[index]) ? 1 : 0;
+	});
+
+	state.counters["sight_tiles"] = sight_tiles;
+	state.counters["visible_tiles"] = visible_tiles;
+	state.counters["extra_tiles"] = extra_tiles;
+	state.counters["missed_tiles"] = missed_tiles;
+
+	if (extra_tiles != 0 || missed_tiles != 0) {
+		state.SkipWithError("The field of view doesn't give the same visible tiles as the line checks.");
+		return false;
+	}
+
+	return true;
+}
+
+/**
+**	@brief	Find the visible tiles of a sight source in the middle of a window with randomly placed obstacles, by checking the line from each tile of the footprint to each tile in sight
+**
+**	The arguments are the sight range, the footprint size and the obstacle density in percent.
+*/
+void field_of_view_line_checks(benchmark::State &state)
+{
+	const sight_window window(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+
+	if (!compare_visible_tiles(state, window)) {
+		return;
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(window.get_visible_tiles_by_line_checks().data());
+	}
+}
+
+/**
+**	@brief	Find the visible tiles of a sight source in the middle of a window with randomly placed obstacles, with the field of view
+**
+**	The arguments are the sight range, the footprint size and the obstacle density in percent.
+*/
+void field_of_view_cast(benchmark::State &state)
+{
+	const sight_window window(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+
+	if (!compare_visible_tiles(state, window)) {
+		return;
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(window.get_visible_tiles_by_field_of_view().data());
+	}
+}
+
+}
+
+BENCHMARK(field_of_view_line_checks)->ArgsProduct({{4, 8, 12}, {1, 4}, {0, 20, 35}});
+BENCHMARK(field_of_view_cast)->ArgsProduct({{4, 8, 12}, {1, 4}, {0, 20, 35}});
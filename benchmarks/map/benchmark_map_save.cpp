@@ -0,0 +1,580 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/binary_stream.h"
+
+namespace {
+
+/// The data saved for a map tile, with the same fields as tile::Save and tile::save_binary
+struct tile_record final
+{
+	using transition_tiles = std::vector<std::pair<const std::string *, short>>;
+
+	bool operator ==(const tile_record &other) const = default;
+
+	const std::string *terrain = nullptr;
+	const std::string *overlay_terrain = nullptr;
+	const std::string *terrain_feature = nullptr;
+	bool overlay_terrain_damaged = false;
+	bool overlay_terrain_destroyed = false;
+	const std::string *seen_terrain = nullptr;
+	const std::string *seen_overlay_terrain = nullptr;
+	short solid_tile = 0;
+	short overlay_solid_tile = 0;
+	short seen_solid_tile = 0;
+	short seen_overlay_solid_tile = 0;
+	short value = 0;
+	unsigned char cost = 0;
+	int landmass = 0;
+	const std::string *settlement = nullptr;
+	transition_tiles transition_tiles_list;
+	transition_tiles overlay_transition_tiles;
+	transition_tiles seen_transition_tiles;
+	transition_tiles seen_overlay_transition_tiles;
+	uint64_t explored_players = 0;
+	uint64_t flags = 0;
+};
+
+/// The data entries which tiles refer to by identifier, standing in for terrain types, terrain features and sites
+class identifier_table final
+{
+public:
+	identifier_table()
+	{
+		for (const char *identifier : {"grass", "dirt", "dry_mud", "snow", "ice", "rock_floor", "water", "shallow_water", "pine_tree", "oak_tree", "rock", "wall", "river", "stream", "hamlet", "town", "fort"}) {
+			this->identifiers.emplace(identifier, identifier);
+		}
+	}
+
+	/// Get the entry with the identifier, or null for an empty one; unknown identifiers are an error, as for the data entry get() functions
+	const std::string *get(const std::string &identifier) const
+	{
+		if (identifier.empty()) {
+			return nullptr;
+		}
+
+		const auto find_iterator = this->identifiers.find(identifier);
+		if (find_iterator == this->identifiers.end()) {
+			throw std::runtime_error("Invalid identifier: \"" + identifier + "\".");
+		}
+
+		return &find_iterator->second;
+	}
+
+private:
+	std::map<std::string, std::string> identifiers;
+};
+
+const identifier_table &get_identifiers()
+{
+	static const identifier_table table;
+	return table;
+}
+
+const std::pair<uint64_t, const char *> flag_names[] = {
+	{1 << 1, "land"}, {1 << 2, "coast"}, {1 << 3, "water"}, {1 << 29, "space"}, {1 << 28, "underground"}, {1 << 4, "no-building"},
+	{1 << 5, "block"}, {1 << 7, "wall"}, {1 << 8, "rock"}, {1 << 9, "wood"}, {1 << 6, "air-unpassable"}, {1 << 23, "desert"},
+	{1 << 22, "dirt"}, {1 << 25, "ice"}, {1 << 19, "grass"}, {1 << 26, "gravel"}, {1 << 20, "mud"}, {1 << 16, "railroad"},
+	{1 << 15, "road"}, {1 << 17, "no-rail"}, {1 << 24, "snow"}, {1 << 21, "stone_floor"}, {1 << 27, "stumps"}, {1 << 10, "ground"},
+	{1 << 12, "air"}, {1 << 11, "sea"}, {1 << 13, "building"}, {1 << 14, "item"}, {1 << 18, "bridge"}
+};
+
+/// Generate the tile records of a map layer, with mostly plain terrain, forests and water bodies, transitions at their borders and a few explored areas
+std::vector<tile_record> generate_layer(const int size)
+{
+	const identifier_table &identifiers = get_identifiers();
+	std::mt19937 rng(size);
+	std::uniform_int_distribution<int> percent_distribution(0, 99);
+
+	const std::string *base_terrains[] = {identifiers.get("grass"), identifiers.get("dirt"), identifiers.get("snow"), identifiers.get("shallow_water")};
+	const std::string *overlay_terrains[] = {identifiers.get("pine_tree"), identifiers.get("rock"), identifiers.get("water")};
+
+	std::vector<tile_record> records(size * size);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			tile_record &record = records[x + y * size];
+
+			//large patches, so that transitions only occur at their borders
+			const int region = ((x / 24) * 7 + (y / 24) * 13) % 11;
+			record.terrain = base_terrains[region % 4];
+			record.solid_tile = static_cast<short>(percent_distribution(rng) % 12);
+			record.flags = (1 << 1) | (region % 4 == 2 ? (1 << 24) : (1 << 19));
+			record.landmass = 1 + region / 4;
+
+			if (region >= 8) {
+				record.overlay_terrain = overlay_terrains[region - 8];
+				record.overlay_solid_tile = static_cast<short>(percent_distribution(rng) % 8);
+				record.flags |= (1 << 5) | (1 << 9);
+				record.value = 100;
+			}
+
+			if (x % 24 == 0 || y % 24 == 0) {
+				record.transition_tiles_list.emplace_back(base_terrains[(region + 1) % 4], static_cast<short>(percent_distribution(rng)));
+				if (record.overlay_terrain != nullptr) {
+					record.overlay_transition_tiles.emplace_back(record.overlay_terrain, static_cast<short>(percent_distribution(rng)));
+				}
+			}
+
+			if (x < size / 3 && y < size / 3) {
+				record.explored_players = 1;
+				record.seen_terrain = record.terrain;
+				record.seen_overlay_terrain = record.overlay_terrain;
+				record.seen_solid_tile = record.solid_tile;
+				record.seen_overlay_solid_tile = record.overlay_solid_tile;
+				record.seen_transition_tiles = record.transition_tiles_list;
+				record.seen_overlay_transition_tiles = record.overlay_transition_tiles;
+			}
+
+			if (x % 97 == 5 && y % 89 == 7) {
+				record.settlement = identifiers.get("hamlet");
+				record.terrain_feature = identifiers.get("river");
+			}
+		}
+	}
+
+	return records;
+}
+
+/**
+**	@brief	Write the records in the text format, as tile::Save does
+*/
+std::string save_fields_text(const std::vector<tile_record> &records)
+{
+	std::string text;
+	char buffer[1024];
+
+	const auto identifier = [](const std::string *entry) {
+		return entry != nullptr ? entry->c_str() : "";
+	};
+
+	const auto append_transition_tiles = [&](const char *tag, const tile_record::transition_tiles &transition_tiles) {
+		for (const auto &[terrain, tile_number] : transition_tiles) {
+			snprintf(buffer, sizeof(buffer), ", \"%s\", \"%s\", %d", tag, terrain->c_str(), tile_number);
+			text += buffer;
+		}
+	};
+
+	text += "  {\n";
+	for (const tile_record &record : records) {
+		snprintf(buffer, sizeof(buffer), "  {\"%s\", \"%s\", \"%s\", %s, %s, \"%s\", \"%s\", %d, %d, %d, %d, %2d, %2d, %2d, \"%s\"", identifier(record.terrain), identifier(record.overlay_terrain), identifier(record.terrain_feature), record.overlay_terrain_damaged ? "true" : "false", record.overlay_terrain_destroyed ? "true" : "false", identifier(record.seen_terrain), identifier(record.seen_overlay_terrain), record.solid_tile, record.overlay_solid_tile, record.seen_solid_tile, record.seen_overlay_solid_tile, record.value, record.cost, record.landmass, identifier(record.settlement));
+		text += buffer;
+
+		append_transition_tiles("transition-tile", record.transition_tiles_list);
+		append_transition_tiles("overlay-transition-tile", record.overlay_transition_tiles);
+		append_transition_tiles("seen-transition-tile", record.seen_transition_tiles);
+		append_transition_tiles("seen-overlay-transition-tile", record.seen_overlay_transition_tiles);
+
+		for (int i = 0; i < 64; ++i) {
+			if (record.explored_players & (static_cast<uint64_t>(1) << i)) {
+				snprintf(buffer, sizeof(buffer), ", \"explored\", %d", i);
+				text += buffer;
+			}
+		}
+
+		for (const auto &[flag, name] : flag_names) {
+			if (record.flags & flag) {
+				text += ", \"";
+				text += name;
+				text += "\"";
+			}
+		}
+
+		text += "},\n";
+	}
+	text += "  },\n";
+
+	return text;
+}
+
+/**
+**	@brief	Read the records from the text format
+**
+**	This tokenizes the tile tables and handles their values as the Lua tile loading function does; the cost of the Lua interpreter building a table for each tile comes on top of this in the game.
+*/
+std::vector<tile_record> load_fields_text(const std::string &text)
+{
+	const identifier_table &identifiers = get_identifiers();
+	std::vector<tile_record> records;
+
+	size_t position = text.find('{') + 1;
+	std::vector<std::string> tokens;
+
+	while (true) {
+		const size_t table_start = text.find('{', position);
+		if (table_start == std::string::npos) {
+			break;
+		}
+
+		const size_t table_end = text.find('}', table_start);
+		tokens.clear();
+
+		for (size_t i = table_start + 1; i < table_end;) {
+			const char c = text[i];
+			if (c == '"') {
+				const size_t string_end = text.find('"', i + 1);
+				tokens.emplace_back(text, i + 1, string_end - i - 1);
+				i = string_end + 1;
+			} else if (c == ',' || c == ' ') {
+				++i;
+			} else {
+				const size_t token_end = text.find_first_of(",}", i);
+				tokens.emplace_back(text, i, token_end - i);
+				i = token_end;
+			}
+		}
+
+		position = table_end + 1;
+
+		tile_record &record = records.emplace_back();
+		record.terrain = identifiers.get(tokens[0]);
+		record.overlay_terrain = identifiers.get(tokens[1]);
+		record.terrain_feature = identifiers.get(tokens[2]);
+		record.overlay_terrain_damaged = tokens[3] == "true";
+		record.overlay_terrain_destroyed = tokens[4] == "true";
+		record.seen_terrain = identifiers.get(tokens[5]);
+		record.seen_overlay_terrain = identifiers.get(tokens[6]);
+		record.solid_tile = static_cast<short>(std::stoi(tokens[7]));
+		record.overlay_solid_tile = static_cast<short>(std::stoi(tokens[8]));
+		record.seen_solid_tile = static_cast<short>(std::stoi(tokens[9]));
+		record.seen_overlay_solid_tile = static_cast<short>(std::stoi(tokens[10]));
+		record.value = static_cast<short>(std::stoi(tokens[11]));
+		record.cost = static_cast<unsigned char>(std::stoi(tokens[12]));
+		record.landmass = std::stoi(tokens[13]);
+		record.settlement = identifiers.get(tokens[14]);
+
+		for (size_t i = 15; i < tokens.size(); ++i) {
+			const std::string &tag = tokens[i];
+			if (tag == "transition-tile" || tag == "overlay-transition-tile" || tag == "seen-transition-tile" || tag == "seen-overlay-transition-tile") {
+				tile_record::transition_tiles &transition_tiles = tag == "transition-tile" ? record.transition_tiles_list : (tag == "overlay-transition-tile" ? record.overlay_transition_tiles : (tag == "seen-transition-tile" ? record.seen_transition_tiles : record.seen_overlay_transition_tiles));
+				const std::string *terrain = identifiers.get(tokens[i + 1]);
+				transition_tiles.emplace_back(terrain, static_cast<short>(std::stoi(tokens[i + 2])));
+				i += 2;
+			} else if (tag == "explored") {
+				record.explored_players |= static_cast<uint64_t>(1) << std::stoi(tokens[i + 1]);
+				++i;
+			} else {
+				bool found = false;
+				for (const auto &[flag, name] : flag_names) {
+					if (tag == name) {
+						record.flags |= flag;
+						found = true;
+						break;
+					}
+				}
+
+				if (!found) {
+					throw std::runtime_error("Unsupported tag: " + tag);
+				}
+			}
+		}
+	}
+
+	return records;
+}
+
+void save_transition_tiles_binary(wyrmgus::binary_writer &writer, const tile_record::transition_tiles &transition_tiles)
+{
+	writer.write_uint32(static_cast<uint32_t>(transition_tiles.size()));
+
+	for (const auto &[terrain, tile_number] : transition_tiles) {
+		writer.write_identifier(*terrain);
+		writer.write_int16(tile_number);
+	}
+}
+
+void load_transition_tiles_binary(wyrmgus::binary_reader &reader, tile_record::transition_tiles &transition_tiles)
+{
+	const uint32_t count = reader.read_uint32();
+
+	for (uint32_t i = 0; i < count; ++i) {
+		const std::string *terrain = get_identifiers().get(reader.read_identifier());
+		const short tile_number = reader.read_int16();
+		transition_tiles.emplace_back(terrain, tile_number);
+	}
+}
+
+constexpr int fields_binary_compression_level = 1; //as in CMapLayer
+
+const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string encode_base64(const std::vector<unsigned char> &data)
+{
+	std::string encoded;
+	encoded.reserve((data.size() + 2) / 3 * 4);
+
+	for (size_t i = 0; i < data.size(); i += 3) {
+		const uint32_t chunk = (data[i] << 16) | ((i + 1 < data.size() ? data[i + 1] : 0) << 8) | (i + 2 < data.size() ? data[i + 2] : 0);
+		encoded += base64_chars[(chunk >> 18) & 63];
+		encoded += base64_chars[(chunk >> 12) & 63];
+		encoded += i + 1 < data.size() ? base64_chars[(chunk >> 6) & 63] : '=';
+		encoded += i + 2 < data.size() ? base64_chars[chunk & 63] : '=';
+	}
+
+	return encoded;
+}
+
+std::vector<unsigned char> decode_base64(const std::string &encoded)
+{
+	int values[256];
+	std::fill(std::begin(values), std::end(values), -1);
+	for (int i = 0; i < 64; ++i) {
+		values[static_cast<unsigned char>(base64_chars[i])] = i;
+	}
+
+	std::vector<unsigned char> data;
+	data.reserve(encoded.size() / 4 * 3);
+
+	uint32_t chunk = 0;
+	int bits = 0;
+	for (const char c : encoded) {
+		const int value = values[static_cast<unsigned char>(c)];
+		if (value == -1) {
+			continue;
+		}
+
+		chunk = (chunk << 6) | value;
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			data.push_back(static_cast<unsigned char>(chunk >> bits));
+		}
+	}
+
+	return data;
+}
+
+/**
+**	@brief	Write the records in the binary format, as CMapLayer::save_fields_binary does
+**
+**	The buffer is compressed with zlib at the same level, as qCompress does, and written as base64 lines.
+*/
+std::string save_fields_binary(const std::vector<tile_record> &records, const int size)
+{
+	wyrmgus::binary_writer writer;
+	writer.write_uint32(0x4C49544D); //"MTIL"
+	writer.write_uint32(1);
+	writer.write_int32(size);
+	writer.write_int32(size);
+
+	for (const tile_record &record : records) {
+		writer.write_identifier(record.terrain != nullptr ? *record.terrain : "");
+		writer.write_identifier(record.overlay_terrain != nullptr ? *record.overlay_terrain : "");
+		writer.write_identifier(record.terrain_feature != nullptr ? *record.terrain_feature : "");
+		writer.write_uint8((record.overlay_terrain_damaged ? 1 : 0) | (record.overlay_terrain_destroyed ? 2 : 0));
+		writer.write_identifier(record.seen_terrain != nullptr ? *record.seen_terrain : "");
+		writer.write_identifier(record.seen_overlay_terrain != nullptr ? *record.seen_overlay_terrain : "");
+		writer.write_int16(record.solid_tile);
+		writer.write_int16(record.overlay_solid_tile);
+		writer.write_int16(record.seen_solid_tile);
+		writer.write_int16(record.seen_overlay_solid_tile);
+		writer.write_int16(record.value);
+		writer.write_uint8(record.cost);
+		writer.write_int32(record.landmass);
+		writer.write_identifier(record.settlement != nullptr ? *record.settlement : "");
+		save_transition_tiles_binary(writer, record.transition_tiles_list);
+		save_transition_tiles_binary(writer, record.overlay_transition_tiles);
+		save_transition_tiles_binary(writer, record.seen_transition_tiles);
+		save_transition_tiles_binary(writer, record.seen_overlay_transition_tiles);
+		writer.write_uint64(record.explored_players);
+		writer.write_uint64(record.flags);
+	}
+
+	const std::string &data = writer.get_data();
+	uLongf compressed_size = compressBound(static_cast<uLong>(data.size()));
+	std::vector<unsigned char> compressed_data(4 + compressed_size);
+
+	//qCompress prefixes the data with its uncompressed size, in big-endian order
+	compressed_data[0] = static_cast<unsigned char>(data.size() >> 24);
+	compressed_data[1] = static_cast<unsigned char>(data.size() >> 16);
+	compressed_data[2] = static_cast<unsigned char>(data.size() >> 8);
+	compressed_data[3] = static_cast<unsigned char>(data.size());
+	compress2(compressed_data.data() + 4, &compressed_size, reinterpret_cast<const Bytef *>(data.data()), static_cast<uLong>(data.size()), fields_binary_compression_level);
+	compressed_data.resize(4 + compressed_size);
+
+	const std::string encoded_data = encode_base64(compressed_data);
+
+	static constexpr size_t line_length = 4096;
+
+	std::string text = "  {\n";
+	for (size_t i = 0; i < encoded_data.size(); i += line_length) {
+		text += "  \"";
+		text.append(encoded_data, i, line_length);
+		text += "\",\n";
+	}
+	text += "  },\n";
+
+	return text;
+}
+
+/**
+**	@brief	Read the records from the binary format, as CMapLayer::load_fields_binary does
+*/
+std::vector<tile_record> load_fields_binary(const std::string &text)
+{
+	const identifier_table &identifiers = get_identifiers();
+
+	//concatenate the lines, as the Lua loading function does
+	std::string encoded_data;
+	for (size_t position = text.find('"'); position != std::string::npos; position = text.find('"', position)) {
+		const size_t line_end = text.find('"', position + 1);
+		encoded_data.append(text, position + 1, line_end - position - 1);
+		position = line_end + 1;
+	}
+
+	const std::vector<unsigned char> compressed_data = decode_base64(encoded_data);
+	uLongf data_size = (static_cast<uLongf>(compressed_data[0]) << 24) | (compressed_data[1] << 16) | (compressed_data[2] << 8) | compressed_data[3];
+	std::string data(data_size, '\0');
+	if (uncompress(reinterpret_cast<Bytef *>(data.data()), &data_size, compressed_data.data() + 4, static_cast<uLong>(compressed_data.size() - 4)) != Z_OK) {
+		throw std::runtime_error("Failed to decompress the map field data.");
+	}
+
+	wyrmgus::binary_reader reader(data.data(), data.size());
+	reader.read_uint32();
+	reader.read_uint32();
+	const int width = reader.read_int32();
+	const int height = reader.read_int32();
+
+	std::vector<tile_record> records(width * height);
+	for (tile_record &record : records) {
+		record.terrain = identifiers.get(reader.read_identifier());
+		record.overlay_terrain = identifiers.get(reader.read_identifier());
+		record.terrain_feature = identifiers.get(reader.read_identifier());
+		const uint8_t overlay_state = reader.read_uint8();
+		record.overlay_terrain_damaged = (overlay_state & 1) != 0;
+		record.overlay_terrain_destroyed = (overlay_state & 2) != 0;
+		record.seen_terrain = identifiers.get(reader.read_identifier());
+		record.seen_overlay_terrain = identifiers.get(reader.read_identifier());
+		record.solid_tile = reader.read_int16();
+		record.overlay_solid_tile = reader.read_int16();
+		record.seen_solid_tile = reader.read_int16();
+		record.seen_overlay_solid_tile = reader.read_int16();
+		record.value = reader.read_int16();
+		record.cost = reader.read_uint8();
+		record.landmass = reader.read_int32();
+		record.settlement = identifiers.get(reader.read_identifier());
+		load_transition_tiles_binary(reader, record.transition_tiles_list);
+		load_transition_tiles_binary(reader, record.overlay_transition_tiles);
+		load_transition_tiles_binary(reader, record.seen_transition_tiles);
+		load_transition_tiles_binary(reader, record.seen_overlay_transition_tiles);
+		record.explored_players = reader.read_uint64();
+		record.flags = reader.read_uint64();
+	}
+
+	if (!reader.is_at_end()) {
+		throw std::runtime_error("The map field data has trailing bytes.");
+	}
+
+	return records;
+}
+
+/**
+**	@brief	Check that the records of a generated layer come back the same from both formats, and that the binary format gives the same records as the text one
+*/
+bool check_round_trip(benchmark::State &state, const std::vector<tile_record> &records, const int size)
+{
+	const std::vector<tile_record> text_records = load_fields_text(save_fields_text(records));
+	const std::vector<tile_record> binary_records = load_fields_binary(save_fields_binary(records, size));
+
+	if (text_records != records) {
+		state.SkipWithError("The text format doesn't round-trip the tile records.");
+		return false;
+	}
+
+	if (binary_records != text_records) {
+		state.SkipWithError("The binary format doesn't give the same tile records as the text format.");
+		return false;
+	}
+
+	return true;
+}
+
+/**
+**	@brief	Save the fields of a generated map layer, in the text or binary format
+**
+**	The arguments are the size of the map layer, and whether to use the binary format.
+*/
+void map_fields_save(benchmark::State &state)
+{
+	const int size = static_cast<int>(state.range(0));
+	const bool binary = state.range(1) != 0;
+	const std::vector<tile_record> records = generate_layer(size);
+
+	if (!check_round_trip(state, records, size)) {
+		return;
+	}
+
+	size_t saved_size = 0;
+	for (auto _ : state) {
+		const std::string saved_data = binary ? save_fields_binary(records, size) : save_fields_text(records);
+		saved_size = saved_data.size();
+		benchmark::DoNotOptimize(saved_data.data());
+	}
+
+	state.counters["saved_bytes"] = static_cast<double>(saved_size);
+}
+
+/**
+**	@brief	Load the fields of a generated map layer, in the text or binary format
+**
+**	The arguments are the size of the map layer, and whether to use the binary format.
+*/
+void map_fields_load(benchmark::State &state)
+{
+	const int size = static_cast<int>(state.range(0));
+	const bool binary = state.range(1) != 0;
+	const std::vector<tile_record> records = generate_layer(size);
+
+	if (!check_round_trip(state, records, size)) {
+		return;
+	}
+
+	const std::string saved_data = binary ? save_fields_binary(records, size) : save_fields_text(records);
+
+	for (auto _ : state) {
+		const std::vector<tile_record> loaded_records = binary ? load_fields_binary(saved_data) : load_fields_text(saved_data);
+		benchmark::DoNotOptimize(loaded_records.data());
+	}
+}
+
+}
+
+BENCHMARK(map_fields_save)->ArgsProduct({{256, 512}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(map_fields_load)->ArgsProduct({{256, 512}, {0, 1}})->Unit(benchmark::kMillisecond);
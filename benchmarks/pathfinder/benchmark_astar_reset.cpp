@@ -0,0 +1,359 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "util/generation_stamped_array.h"
+
+namespace {
+
+/// Same layout as the nodes of the A* cost matrix
+struct node final
+{
+	int cost_from_start;
+	short int cost_to_goal;
+	char in_goal;
+	char direction;
+};
+
+constexpr int map_size = 512;
+constexpr int max_close_set_ratio = 4; //as in the A* pathfinder
+constexpr int max_open_set_ratio = 8;
+constexpr int cache_not_set = -5;
+
+/**
+**	@brief	The reset of the A* data as it was before generation stamping
+**
+**	The nodes touched by a search were recorded in a close set, which was used to reset them afterwards, unless it grew up to its threshold,
+**	in which case the whole matrix was cleared. The move cost cache was filled whole before every search.
+*/
+class threshold_reset final
+{
+public:
+	explicit threshold_reset(const int tile_count)
+		: tile_count(tile_count), threshold(tile_count / max_close_set_ratio),
+		matrix(std::make_unique<node[]>(tile_count)), close_set(std::make_unique<int[]>(tile_count / max_close_set_ratio)),
+		cost_cache(std::make_unique<int[]>(tile_count))
+	{
+	}
+
+	void reset()
+	{
+		if (this->close_set_size >= this->threshold) {
+			memset(this->matrix.get(), 0, sizeof(node) * this->tile_count);
+		} else {
+			for (int i = 0; i < this->close_set_size; ++i) {
+				node &node = this->matrix[this->close_set[i]];
+				node.cost_from_start = 0;
+				node.in_goal = 0;
+			}
+		}
+
+		this->close_set_size = 0;
+		std::fill_n(this->cost_cache.get(), this->tile_count, cache_not_set);
+	}
+
+	node &get_node(const int index)
+	{
+		return this->matrix[index];
+	}
+
+	void add_to_close(const int index)
+	{
+		if (this->close_set_size < this->threshold) {
+			this->close_set[this->close_set_size++] = index;
+		}
+	}
+
+	template <typename function_type>
+	int get_cost(const int index, const function_type &cost_function)
+	{
+		int &cost = this->cost_cache[index];
+		if (cost == cache_not_set) {
+			cost = cost_function(index);
+		}
+		return cost;
+	}
+
+private:
+	const int tile_count;
+	const int threshold;
+	std::unique_ptr<node[]> matrix;
+	std::unique_ptr<int[]> close_set;
+	int close_set_size = 0;
+	std::unique_ptr<int[]> cost_cache;
+};
+
+/// The reset of the A* data by starting a new generation of the matrix and of the move cost cache
+class generation_reset final
+{
+public:
+	explicit generation_reset(const int tile_count) : matrix(tile_count), cost_cache(tile_count)
+	{
+	}
+
+	void reset()
+	{
+		this->matrix.next_generation();
+		this->cost_cache.next_generation();
+	}
+
+	node &get_node(const int index)
+	{
+		return this->matrix.get(index, [](node &node) {
+			node.cost_from_start = 0;
+			node.in_goal = 0;
+		});
+	}
+
+	void add_to_close([[maybe_unused]] const int index)
+	{
+		//the nodes don't need to be tracked, as a new generation invalidates all of them
+	}
+
+	template <typename function_type>
+	int get_cost(const int index, const function_type &cost_function)
+	{
+		return this->cost_cache.get(index, [index, &cost_function](int &cost) {
+			cost = cost_function(index);
+		});
+	}
+
+private:
+	wyrmgus::generation_stamped_array<node> matrix;
+	wyrmgus::generation_stamped_array<int> cost_cache;
+};
+
+/**
+**	@brief	Touch the nodes of a search and their move costs, and then reset them
+**
+**	The argument is the number of nodes touched by each search.
+*/
+template <typename reset_type>
+void astar_reset(benchmark::State &state)
+{
+	const int touched_nodes = static_cast<int>(state.range(0));
+	reset_type reset(map_size * map_size);
+
+	for (auto _ : state) {
+		reset.reset();
+
+		for (int i = 0; i < touched_nodes; ++i) {
+			const int index = i * 7 % (map_size * map_size);
+			node &node = reset.get_node(index);
+			if (node.cost_from_start == 0) {
+				reset.add_to_close(index);
+			}
+			node.cost_from_start = i + 1;
+			node.cost_to_goal = static_cast<short int>(reset.get_cost(index, [](const int index) { return index & 1; }));
+		}
+
+		benchmark::ClobberMemory();
+	}
+}
+
+/// A generated map layer, where each tile is either passable or an obstacle
+struct replay_map final
+{
+	explicit replay_map(const int size, const unsigned int seed) : size(size), obstacles(size * size, 0)
+	{
+		//clumps of obstacles, like forests and rocks
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> pos_distribution(0, size - 1);
+		std::uniform_int_distribution<int> radius_distribution(1, 6);
+		for (int i = 0; i < size * size / 64; ++i) {
+			const int center_x = pos_distribution(rng);
+			const int center_y = pos_distribution(rng);
+			const int radius = radius_distribution(rng);
+			for (int y = std::max(center_y - radius, 0); y <= std::min(center_y + radius, size - 1); ++y) {
+				for (int x = std::max(center_x - radius, 0); x <= std::min(center_x + radius, size - 1); ++x) {
+					if ((x - center_x) * (x - center_x) + (y - center_y) * (y - center_y) <= radius * radius) {
+						this->obstacles[x + y * size] = 1;
+					}
+				}
+			}
+		}
+	}
+
+	const int size;
+	std::vector<char> obstacles;
+};
+
+/**
+**	@brief	Search for a path with the A* algorithm as the pathfinder does, with the same matrix, close set and move cost cache accesses
+**
+**	@return	The cost of the path, or -1 if none was found
+*/
+template <typename reset_type>
+int find_path(reset_type &reset, const replay_map &map, const int start_index, const int goal_index)
+{
+	static constexpr int heading_x[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+	static constexpr int heading_y[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+	reset.reset();
+
+	const int goal_x = goal_index % map.size;
+	const int goal_y = goal_index / map.size;
+	const auto get_cost_to_goal = [&](const int index) {
+		return std::max(std::abs(index % map.size - goal_x), std::abs(index / map.size - goal_y));
+	};
+	const auto cost_move_to = [&map](const int index) {
+		return map.obstacles[index] ? -1 : 0;
+	};
+
+	reset.get_node(goal_index).in_goal = 1;
+	reset.add_to_close(goal_index);
+
+	using open_entry = std::pair<int, int>; //total cost, node index
+	std::priority_queue<open_entry, std::vector<open_entry>, std::greater<open_entry>> open_set;
+	const size_t max_open_set_size = static_cast<size_t>(map.size * map.size / max_open_set_ratio);
+
+	node &start_node = reset.get_node(start_index);
+	start_node.cost_from_start = 1;
+	reset.add_to_close(start_index);
+	open_set.emplace(1 + get_cost_to_goal(start_index), start_index);
+
+	while (!open_set.empty()) {
+		const auto [total_cost, index] = open_set.top();
+		open_set.pop();
+
+		const node &current = reset.get_node(index);
+		if (current.in_goal) {
+			return current.cost_from_start - 1;
+		}
+
+		const int cost_from_start = current.cost_from_start;
+		if (total_cost != cost_from_start + get_cost_to_goal(index)) {
+			continue; //outdated entry
+		}
+
+		const int x = index % map.size;
+		const int y = index / map.size;
+		for (int i = 0; i < 8; ++i) {
+			const int adjacent_x = x + heading_x[i];
+			const int adjacent_y = y + heading_y[i];
+			if (adjacent_x < 0 || adjacent_y < 0 || adjacent_x >= map.size || adjacent_y >= map.size) {
+				continue;
+			}
+
+			const int adjacent_index = adjacent_x + adjacent_y * map.size;
+			const int move_cost = reset.get_cost(adjacent_index, cost_move_to);
+			if (move_cost < 0) {
+				continue;
+			}
+
+			node &adjacent = reset.get_node(adjacent_index);
+			const int new_cost = cost_from_start + 1 + move_cost;
+			if (adjacent.cost_from_start == 0) {
+				reset.add_to_close(adjacent_index);
+			} else if (new_cost >= adjacent.cost_from_start) {
+				continue;
+			}
+
+			adjacent.cost_from_start = new_cost;
+			adjacent.direction = static_cast<char>(i);
+			adjacent.cost_to_goal = static_cast<short int>(get_cost_to_goal(adjacent_index));
+			open_set.emplace(new_cost + adjacent.cost_to_goal, adjacent_index);
+
+			if (open_set.size() >= max_open_set_size) {
+				return -1;
+			}
+		}
+	}
+
+	return -1;
+}
+
+/**
+**	@brief	Replay a fixed list of path requests on a generated map, reporting the time per request and its 99th percentile
+**
+**	The argument is the size of the map. The requests mix short and long paths, as unit orders do.
+*/
+template <typename reset_type>
+void astar_replay(benchmark::State &state)
+{
+	static constexpr int request_count = 500;
+
+	const int size = static_cast<int>(state.range(0));
+	const replay_map map(size, 42);
+
+	std::vector<std::pair<int, int>> requests;
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> pos_distribution(0, size - 1);
+	std::uniform_int_distribution<int> range_distribution(4, size / 2);
+	while (static_cast<int>(requests.size()) < request_count) {
+		const int start_x = pos_distribution(rng);
+		const int start_y = pos_distribution(rng);
+		const int range = range_distribution(rng);
+		const int goal_x = std::clamp(start_x + std::uniform_int_distribution<int>(-range, range)(rng), 0, size - 1);
+		const int goal_y = std::clamp(start_y + std::uniform_int_distribution<int>(-range, range)(rng), 0, size - 1);
+		const int start_index = start_x + start_y * size;
+		const int goal_index = goal_x + goal_y * size;
+		if (map.obstacles[start_index] || map.obstacles[goal_index] || start_index == goal_index) {
+			continue;
+		}
+		requests.emplace_back(start_index, goal_index);
+	}
+
+	reset_type reset(size * size);
+	std::vector<double> request_times;
+	request_times.reserve(request_count * 64);
+
+	for (auto _ : state) {
+		for (const auto &[start_index, goal_index] : requests) {
+			const auto start_time = std::chrono::steady_clock::now();
+			benchmark::DoNotOptimize(find_path(reset, map, start_index, goal_index));
+			request_times.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count());
+		}
+	}
+
+	std::sort(request_times.begin(), request_times.end());
+	double total_time = 0;
+	for (const double request_time : request_times) {
+		total_time += request_time;
+	}
+
+	state.counters["ns_per_request"] = total_time / request_times.size();
+	state.counters["p99_ns"] = request_times[request_times.size() * 99 / 100];
+	state.SetItemsProcessed(state.iterations() * request_count);
+}
+
+}
+
+BENCHMARK_TEMPLATE(astar_reset, generation_reset)->Arg(256)->Arg(4096)->Arg(65536);
+BENCHMARK_TEMPLATE(astar_reset, threshold_reset)->Arg(256)->Arg(4096)->Arg(65536);
+BENCHMARK_TEMPLATE(astar_replay, generation_reset)->Arg(128)->Arg(512)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(astar_replay, threshold_reset)->Arg(128)->Arg(512)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,148 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "util/color_kernels.h"
+
+namespace {
+
+//the default player color has eight shades which are replaced on each player color variant of a graphic
+constexpr size_t player_color_count = 8;
+
+std::vector<unsigned char> create_pixel_data(const size_t pixel_count, const std::vector<uint32_t> &old_rgbs)
+{
+	std::mt19937 random_engine(1);
+	std::uniform_int_distribution<int> byte_distribution(0, 255);
+	std::uniform_int_distribution<int> percent_distribution(0, 99);
+	std::uniform_int_distribution<size_t> color_distribution(0, old_rgbs.size() - 1);
+
+	std::vector<unsigned char> data(pixel_count * 4);
+	for (size_t i = 0; i < pixel_count; ++i) {
+		//about a fifth of the pixels of a unit sprite have a player color
+		uint32_t rgb = 0;
+		if (percent_distribution(random_engine) < 20) {
+			rgb = old_rgbs[color_distribution(random_engine)];
+		} else {
+			rgb = wyrmgus::image::get_pixel_value(byte_distribution(random_engine), byte_distribution(random_engine), byte_distribution(random_engine), 0);
+		}
+
+		data[i * 4] = static_cast<unsigned char>(rgb & 0xFF);
+		data[i * 4 + 1] = static_cast<unsigned char>((rgb >> 8) & 0xFF);
+		data[i * 4 + 2] = static_cast<unsigned char>((rgb >> 16) & 0xFF);
+		data[i * 4 + 3] = static_cast<unsigned char>(byte_distribution(random_engine));
+	}
+
+	return data;
+}
+
+std::vector<uint32_t> create_rgbs(const int base)
+{
+	std::vector<uint32_t> rgbs;
+	for (size_t z = 0; z < player_color_count; ++z) {
+		const int shade = static_cast<int>(z) * 24;
+		rgbs.push_back(wyrmgus::image::get_pixel_value(base + shade, shade, 255 - base - shade, 0));
+	}
+	return rgbs;
+}
+
+/**
+**	@brief	Replace the player colors of a square image
+**
+**	The first argument is the image side length, and the second is whether the vectorized kernel is used.
+*/
+void color_kernel_replace_colors(benchmark::State &state)
+{
+	const size_t side = static_cast<size_t>(state.range(0));
+	const bool vectorized = state.range(1) != 0;
+	const size_t pixel_count = side * side;
+
+	const std::vector<uint32_t> old_rgbs = create_rgbs(0);
+	const std::vector<uint32_t> new_rgbs = create_rgbs(16);
+	const std::vector<unsigned char> source_data = create_pixel_data(pixel_count, old_rgbs);
+	std::vector<unsigned char> data;
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		data = source_data;
+		state.ResumeTiming();
+
+		size_t i = 0;
+#ifdef WYRMGUS_IMAGE_SSE2
+		if (vectorized) {
+			i = wyrmgus::image::replace_colors_sse2(data.data(), pixel_count, old_rgbs.data(), new_rgbs.data(), old_rgbs.size());
+		}
+#endif
+		wyrmgus::image::replace_colors_scalar(data.data(), i, pixel_count, old_rgbs.data(), new_rgbs.data(), old_rgbs.size());
+		benchmark::DoNotOptimize(data.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(pixel_count) * 4);
+}
+
+/**
+**	@brief	Apply a time of day color modification to a square image
+**
+**	The first argument is the image side length, and the second is whether the vectorized kernel is used.
+*/
+void color_kernel_apply_color_modification(benchmark::State &state)
+{
+	const size_t side = static_cast<size_t>(state.range(0));
+	const bool vectorized = state.range(1) != 0;
+	const size_t pixel_count = side * side;
+
+	std::vector<unsigned char> data = create_pixel_data(pixel_count, create_rgbs(0));
+
+	//alternate between a dusk and a dawn modification, so that the data does not saturate over the iterations
+	int sign = 1;
+
+	for (auto _ : state) {
+		size_t i = 0;
+#ifdef WYRMGUS_IMAGE_SSE2
+		if (vectorized) {
+			i = wyrmgus::image::apply_color_modification_sse2(data.data(), pixel_count, -20 * sign, -20 * sign, 10 * sign);
+		}
+#endif
+		wyrmgus::image::apply_color_modification_scalar(data.data(), i, pixel_count, -20 * sign, -20 * sign, 10 * sign);
+		benchmark::DoNotOptimize(data.data());
+		benchmark::ClobberMemory();
+		sign = -sign;
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(pixel_count) * 4);
+}
+
+}
+
+BENCHMARK(color_kernel_replace_colors)->ArgsProduct({{32, 256, 1024}, {0, 1}});
+BENCHMARK(color_kernel_apply_color_modification)->ArgsProduct({{32, 256, 1024}, {0, 1}});
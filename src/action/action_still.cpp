@@ -508,6 +508,28 @@ bool AutoAttack(CUnit &unit)
 }
 
 
+/**
+**	@brief	Get the number of the following cycles in which executing the order would only count down the unit's animation wait
+**
+**	Idle units would otherwise look for something to do in each cycle, so they sleep through at most max_idle_sleep_cycles.
+*/
+int COrder_Still::get_sleep_cycles(const CUnit &unit) const
+{
+	if (this->State != SUB_STILL_STANDBY || unit.Removed || unit.Variable[STUN_INDEX].Value > 0 || unit.Anim.Wait <= 0) {
+		return 0;
+	}
+
+	if (unit.get_animation_set() == nullptr || unit.Anim.CurrAnim != unit.get_animation_set()->Still.get()) {
+		return 0;
+	}
+
+	if (unit.Anim.Unbreakable) {
+		return unit.Anim.Wait;
+	}
+
+	return std::min(unit.Anim.Wait, COrder_Still::max_idle_sleep_cycles);
+}
+
 /* virtual */ void COrder_Still::Execute(CUnit &unit)
 {
 	// If unit is not bunkered and removed, wait
@@ -528,7 +550,8 @@ bool AutoAttack(CUnit &unit)
 			if (unit.Variable[STUN_INDEX].Value == 0) { //only show the idle animation when still if the unit is not stunned
 				UnitShowAnimation(unit, unit.get_animation_set()->Still.get());
 			}
-			if (SyncRand(100000) == 0) {
+			//the idle sound has the same chance of playing in each cycle, including the ones the unit slept through
+			if (SyncRand(100000) <= unit.Sleep.SkippedCycles) {
 				PlayUnitSound(unit, wyrmgus::unit_sound_type::idle);
 			}
 			unit.StepCount = 0;
@@ -74,6 +74,7 @@
 #include "unit/unit_find.h"
 #include "unit/unit_manager.h"
 #include "unit/unit_type.h"
+#include "unit/unit_wakeup_scheduler.h"
 #include "util/random.h"
 
 unsigned SyncHash; /// Hash calculated to find sync failures
@@ -82,11 +83,112 @@ unsigned SyncHash; /// Hash calculated to find sync failures
 --  Functions
 ----------------------------------------------------------------------------*/
 
+/**
+**	@brief	Pool of memory blocks for orders, with a free list for each size class
+*/
+class order_memory_pool final
+{
+public:
+	static constexpr size_t size_granularity = 16;
+	static constexpr size_t max_pooled_size = 512;
+	static constexpr size_t max_free_blocks = 4096; //the maximum quantity of free blocks kept for each size class
+
+	/// Get the pool of the current thread, or null if it has already been destroyed
+	static order_memory_pool *get()
+	{
+		//orders can still be destroyed after the thread's pool, e.g. together with static objects on exit, and then go through the global allocator
+		if (order_memory_pool::destroyed) {
+			return nullptr;
+		}
+
+		//each thread has its own pool, so that no locking is needed; it is destroyed together with the thread
+		static thread_local order_memory_pool pool;
+		return &pool;
+	}
+
+	~order_memory_pool()
+	{
+		for (const std::vector<void *> &free_blocks : this->free_blocks) {
+			for (void *block : free_blocks) {
+				::operator delete(block);
+			}
+		}
+
+		order_memory_pool::destroyed = true;
+	}
+
+	void *allocate(const size_t size)
+	{
+		if (size == 0 || size > order_memory_pool::max_pooled_size) {
+			return ::operator new(size);
+		}
+
+		const size_t size_class = order_memory_pool::get_size_class(size);
+		std::vector<void *> &free_blocks = this->free_blocks[size_class];
+
+		if (!free_blocks.empty()) {
+			void *block = free_blocks.back();
+			free_blocks.pop_back();
+			return block;
+		}
+
+		return ::operator new((size_class + 1) * order_memory_pool::size_granularity);
+	}
+
+	void deallocate(void *block, const size_t size)
+	{
+		if (size == 0 || size > order_memory_pool::max_pooled_size) {
+			::operator delete(block);
+			return;
+		}
+
+		std::vector<void *> &free_blocks = this->free_blocks[order_memory_pool::get_size_class(size)];
+
+		if (free_blocks.size() >= order_memory_pool::max_free_blocks) {
+			::operator delete(block);
+			return;
+		}
+
+		free_blocks.push_back(block);
+	}
+
+private:
+	static size_t get_size_class(const size_t size)
+	{
+		return (size - 1) / order_memory_pool::size_granularity;
+	}
+
+	std::vector<void *> free_blocks[order_memory_pool::max_pooled_size / order_memory_pool::size_granularity];
+
+	static inline thread_local bool destroyed = false;
+};
+
 COrder::~COrder()
 {
 	Goal.Reset();
 }
 
+void *COrder::operator new(const size_t size)
+{
+	order_memory_pool *pool = order_memory_pool::get();
+	if (pool == nullptr) {
+		return ::operator new(size);
+	}
+
+	return pool->allocate(size);
+}
+
+void COrder::operator delete(void *ptr, const size_t size)
+{
+	order_memory_pool *pool = order_memory_pool::get();
+	if (pool == nullptr) {
+		::operator delete(ptr);
+		return;
+	}
+
+	pool->deallocate(ptr, size);
+}
+
 void COrder::SetGoal(CUnit *const new_goal)
 {
 	Goal = new_goal;
@@ -357,10 +459,17 @@ static void HandleBuffsEachCycle(CUnit &unit)
 		}
 	}
 	
-	const int SpellEffects[] = {BLOODLUST_INDEX, HASTE_INDEX, SLOW_INDEX, INVISIBLE_INDEX, UNHOLYARMOR_INDEX, POISON_INDEX, STUN_INDEX, BLEEDING_INDEX, LEADERSHIP_INDEX, BLESSING_INDEX, INSPIRE_INDEX, PRECISION_INDEX, REGENERATION_INDEX, BARKSKIN_INDEX, INFUSION_INDEX, TERROR_INDEX, WITHER_INDEX, DEHYDRATION_INDEX, HYDRATING_INDEX};
+	static constexpr int SpellEffects[] = {BLOODLUST_INDEX, HASTE_INDEX, SLOW_INDEX, INVISIBLE_INDEX, UNHOLYARMOR_INDEX, POISON_INDEX, STUN_INDEX, BLEEDING_INDEX, LEADERSHIP_INDEX, BLESSING_INDEX, INSPIRE_INDEX, PRECISION_INDEX, REGENERATION_INDEX, BARKSKIN_INDEX, INFUSION_INDEX, TERROR_INDEX, WITHER_INDEX, DEHYDRATION_INDEX, HYDRATING_INDEX};
 	//  decrease spells effects time.
 	for (unsigned int i = 0; i < sizeof(SpellEffects) / sizeof(int); ++i) {
-		unit.Variable[SpellEffects[i]].Increase = -1;
+		wyrmgus::unit_variable &variable = unit.Variable[SpellEffects[i]];
+		variable.Increase = -1;
+
+		//most units have no active spell effects, and decreasing an effect which has already run out would change nothing
+		if (variable.Value == 0 && variable.Max >= 0) {
+			continue;
+		}
+
 		IncreaseVariable(unit, SpellEffects[i]);
 	}
 	
@@ -551,6 +660,28 @@ static void HandleUnitAction(CUnit &unit)
 	unit.Orders[0]->Execute(unit);
 }
 
+/**
+**  Get the number of the following cycles in which a unit waiting with its still animation would only count down its wait timers.
+**
+**  This is the case for orders which begin their execution by showing the still animation and counting down the unit's action wait while it is set.
+**
+**  @param unit  The unit.
+**
+**  @return      The number of cycles the unit can sleep through.
+*/
+int GetWaitingSleepCycles(const CUnit &unit)
+{
+	if (!unit.Wait || !unit.Waiting || unit.Anim.Wait <= 0) {
+		return 0;
+	}
+
+	if (unit.get_animation_set() == nullptr || unit.Anim.CurrAnim != unit.get_animation_set()->Still.get()) {
+		return 0;
+	}
+
+	return std::min(static_cast<int>(unit.Wait), unit.Anim.Wait);
+}
+
 template <typename UNITP_ITERATOR>
 static void UnitActionsEachSecond(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 {
@@ -630,6 +761,9 @@ static void DumpUnitInfo(CUnit &unit)
 template <typename UNITP_ITERATOR>
 static void UnitActionsEachCycle(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 {
+	wyrmgus::unit_wakeup_scheduler *wakeup_scheduler = wyrmgus::unit_wakeup_scheduler::get();
+	wakeup_scheduler->wake_due_units();
+
 	for (UNITP_ITERATOR it = begin; it != end; ++it) {
 		CUnit &unit = **it;
 
@@ -656,10 +790,15 @@ static void UnitActionsEachCycle(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 			continue;
 		}
 
-		try {
-			HandleUnitAction(unit);
-		} catch (AnimationDie_Exception &) {
-			AnimationDie_OnCatch(unit);
+		//sleeping units would only count down their wait timers, which is done for the skipped cycles when they wake
+		if (!wakeup_scheduler->handle_sleep(unit)) {
+			try {
+				HandleUnitAction(unit);
+			} catch (AnimationDie_Exception &) {
+				AnimationDie_OnCatch(unit);
+			}
+
+			wakeup_scheduler->try_sleep(unit);
 		}
 
 		if (EnableUnitDebug) {
@@ -707,7 +846,9 @@ void UnitActions()
 {
 	const bool isASecondCycle = !(GameCycle % CYCLES_PER_SECOND);
 	// Unit list may be modified during loop... so make a copy
-	std::vector<CUnit *> table(UnitManager.begin(), UnitManager.end());
+	//the copy's storage is kept between cycles, so that it doesn't need to be allocated again every cycle
+	static std::vector<CUnit *> table;
+	table.assign(UnitManager.begin(), UnitManager.end());
 
 	// Check for things that only happen every second
 	if (isASecondCycle) {
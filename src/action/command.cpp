@@ -38,6 +38,7 @@
 #include "diplomacy_state.h"
 #include "map/map.h"
 #include "map/map_layer.h"
+#include "map/minimap.h"
 #include "map/tile.h"
 #include "map/tileset.h"
 #include "pathfinder.h"
@@ -53,6 +54,7 @@
 #include "unit/unit_manager.h"
 #include "unit/unit_type.h"
 #include "unit/unit_type_type.h"
+#include "unit/unit_wakeup_scheduler.h"
 #include "upgrade/upgrade.h"
 #include "vassalage_type.h"
 
@@ -110,6 +112,7 @@ static std::unique_ptr<COrder> *GetNextOrder(CUnit &unit, int flush)
 	if (unit.Orders.size() == maxOrderCount) {
 		return nullptr;
 	}
+	wyrmgus::unit_wakeup_scheduler::get()->wake(unit);
 	unit.Orders.push_back(nullptr);
 	return &unit.Orders.back();
 }
@@ -128,6 +131,7 @@ static void RemoveOrder(CUnit &unit, unsigned int order)
 	if (unit.Orders.empty()) {
 		unit.Orders.push_back(COrder::NewActionStill());
 	}
+	wyrmgus::unit_wakeup_scheduler::get()->wake(unit);
 }
 
 static void ClearNewAction(CUnit &unit)
@@ -1056,6 +1060,7 @@ void CommandTrainUnit(CUnit &unit, const wyrmgus::unit_type &type, int player, i
 		Assert(unit.CriticalOrder == nullptr);
 		
 		unit.CriticalOrder = COrder::NewActionTrain(unit, type, player);
+		wyrmgus::unit_wakeup_scheduler::get()->wake(unit);
 		return;
 	}
 	//Wyrmgus end
@@ -1167,6 +1172,7 @@ void CommandTransformIntoType(CUnit &unit, wyrmgus::unit_type &type)
 	Assert(unit.CriticalOrder == nullptr);
 
 	unit.CriticalOrder = COrder::NewActionTransformInto(type);
+	wyrmgus::unit_wakeup_scheduler::get()->wake(unit);
 }
 
 /**
@@ -1416,20 +1422,21 @@ void CommandSharedVision(int player, bool state, int opponent)
 				wyrmgus::tile &mf = *CMap::Map.Field(i, z);
 				const std::unique_ptr<wyrmgus::tile_player_info> &mfp = mf.player_info;
 
-				if (mfp->Visible[player] && !mfp->Visible[opponent] && !CPlayer::Players[player]->is_revealed()) {
-					mfp->Visible[opponent] = 1;
+				if (mfp->get_visible(player) && !mfp->get_visible(opponent) && !CPlayer::Players[player]->is_revealed()) {
+					mfp->set_visible(opponent, 1);
 					if (opponent == CPlayer::GetThisPlayer()->Index) {
 						CMap::Map.MarkSeenTile(mf);
 					}
 				}
-				if (mfp->Visible[opponent] && !mfp->Visible[player] && !CPlayer::Players[opponent]->is_revealed()) {
-					mfp->Visible[player] = 1;
+				if (mfp->get_visible(opponent) && !mfp->get_visible(player) && !CPlayer::Players[opponent]->is_revealed()) {
+					mfp->set_visible(player, 1);
 					if (player == CPlayer::GetThisPlayer()->Index) {
 						CMap::Map.MarkSeenTile(mf);
 					}
 				}
 			}
 		}
+		UI.get_minimap()->invalidate_fog();
 		//Wyrmgus end
 	}
 
@@ -165,6 +165,7 @@
 #include "unit/unit_manager.h"
 #include "unit/unit_type.h"
 #include "unit/unit_type_type.h"
+#include "unit/unit_wakeup_scheduler.h"
 #include "upgrade/upgrade.h"
 #include "util/vector_random_util.h"
 #include "util/vector_util.h"
@@ -246,20 +247,13 @@ static void AiCheckUnits()
 		const int x = AiPlayer->UnitTypeRequests[i].Count;
 		const wyrmgus::unit_class *unit_class = AiPlayer->UnitTypeRequests[i].Type->get_unit_class();
 
-		// Add equivalent units
-		int e = AiPlayer->Player->GetUnitTypeAiActiveCount(AiPlayer->UnitTypeRequests[i].Type);
+		// Add equivalent units, and the other units of the same class
+		int e = unit_class != nullptr ? AiPlayer->Player->get_unit_class_ai_active_count(unit_class) : AiPlayer->Player->GetUnitTypeAiActiveCount(AiPlayer->UnitTypeRequests[i].Type);
 		if (t < AiHelpers.Equiv.size()) {
 			for (unsigned int j = 0; j < AiHelpers.Equiv[t].size(); ++j) {
 				e += AiPlayer->Player->GetUnitTypeAiActiveCount(AiHelpers.Equiv[t][j]);
 			}
 		}
-		if (unit_class != nullptr) {
-			for (const wyrmgus::unit_type *class_unit_type : unit_class->get_unit_types()) {
-				if (class_unit_type != AiPlayer->UnitTypeRequests[i].Type) {
-					e += AiPlayer->Player->GetUnitTypeAiActiveCount(class_unit_type);
-				}
-			}
-		}
 		const int requested = x - e - counter[t];
 		if (requested > 0) {  // Request it.
 			//Wyrmgus start
@@ -974,6 +968,7 @@ void AiHelpMe(CUnit *attacker, CUnit &defender)
 					//Wyrmgus start
 					const int delay = i; // To avoid lot of CPU consuption, send them with a small time difference.
 
+					wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(aiunit);
 					aiunit.Wait += delay;
 					//Wyrmgus end
 					
@@ -1063,6 +1058,7 @@ void AiHelpMe(CUnit *attacker, CUnit &defender)
 					if (shouldAttack) {
 						const int delay = j; // To avoid lot of CPU consuption, send them with a small time difference.
 
+						wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(aiunit);
 						aiunit.Wait += delay;
 						
 						CommandAttack(aiunit, attacker->tilePos, attacker, FlushCommands, attacker->MapLayer);
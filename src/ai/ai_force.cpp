@@ -48,6 +48,7 @@
 #include "unit/unit_find.h"
 #include "unit/unit_type.h"
 #include "unit/unit_type_type.h"
+#include "unit/unit_wakeup_scheduler.h"
 
 static constexpr int AIATTACK_RANGE = 0;
 static constexpr int AIATTACK_ALLMAP = 1;
@@ -678,6 +679,7 @@ bool AiForce::CheckTransporters(const Vec2i &pos, int z)
 		}
 		
 		const int delay = i; // To avoid lot of CPU consuption, send them with a small time difference.
+		wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(ai_unit);
 		ai_unit.Wait += delay;
 
 		for (size_t j = 0; j != transporters.size(); ++j) {
@@ -687,6 +689,7 @@ bool AiForce::CheckTransporters(const Vec2i &pos, int z)
 				continue;
 			}
 			
+			wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(*ai_transporter);
 			ai_transporter->Wait += delay;
 		
 			CommandBoard(ai_unit, *ai_transporter, FlushCommands);
@@ -722,6 +725,7 @@ bool AiForce::CheckTransporters(const Vec2i &pos, int z)
 			}
 			
 			const int delay = i; // To avoid lot of CPU consuption, send them with a small time difference.
+			wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(*ai_unit.Container);
 			ai_unit.Container->Wait += delay;
 			//tell the transporter to unload to the goal pos
 			CommandUnload(*ai_unit.Container, pos, nullptr, FlushCommands, z, goal_landmass);
@@ -967,6 +971,7 @@ void AiForce::Attack(const Vec2i &pos, int z)
 
 			//Wyrmgus start
 //			unit->Wait = delay;
+			wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(*unit);
 			unit->Wait += delay;
 			//Wyrmgus end
 			if (unit->IsAgressive()) {
@@ -1156,19 +1161,12 @@ void AiForceManager::CheckUnits(int *counter)
 			const unsigned int t = aiut.Type->Slot;
 			const wyrmgus::unit_class *unit_class = aiut.Type->get_unit_class();
 			const int wantedCount = aiut.Want;
-			int e = AiPlayer->Player->GetUnitTypeAiActiveCount(wyrmgus::unit_type::get_all()[t]);
+			int e = unit_class != nullptr ? AiPlayer->Player->get_unit_class_ai_active_count(unit_class) : AiPlayer->Player->GetUnitTypeAiActiveCount(aiut.Type);
 			if (t < AiHelpers.Equiv.size()) {
 				for (unsigned int k = 0; k < AiHelpers.Equiv[t].size(); ++k) {
 					e += AiPlayer->Player->GetUnitTypeAiActiveCount(AiHelpers.Equiv[t][k]);
 				}
 			}
-			if (unit_class != nullptr) {
-				for (const wyrmgus::unit_type *class_unit_type : unit_class->get_unit_types()) {
-					if (class_unit_type != aiut.Type) {
-						e += AiPlayer->Player->GetUnitTypeAiActiveCount(class_unit_type);
-					}
-				}
-			}
 			const int requested = wantedCount - (e + counter[t] - attacking[t]);
 
 			if (requested > 0) {  // Request it.
@@ -1544,6 +1542,7 @@ void AiForce::Update()
 				
 				//Wyrmgus start
 //				trans.Wait = delay;
+				wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(trans);
 				trans.Wait += delay;
 				//Wyrmgus end
 				CommandUnload(trans, this->GoalPos, nullptr, FlushCommands, this->GoalMapLayer);
@@ -1673,6 +1672,7 @@ void AiForce::Update()
 
 				//Wyrmgus start
 //				aiunit.Wait = delay;
+				wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(aiunit);
 				aiunit.Wait += delay;
 				//Wyrmgus end
 				if (aiunit.IsAgressive()) {
@@ -1777,6 +1777,7 @@ void AiForce::Update()
 
 		//Wyrmgus start
 //		aiunit.Wait = delay;
+		wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(aiunit);
 		aiunit.Wait += delay;
 		//Wyrmgus end
 		if (leader) {
@@ -2012,6 +2013,7 @@ void AiForceManager::Update()
 
 							//Wyrmgus start
 //							unit->Wait = delay;
+							wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply(*unit);
 							unit->Wait += delay;
 							//Wyrmgus end
 							//Wyrmgus start
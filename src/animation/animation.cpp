@@ -60,6 +60,7 @@
 #include "spell/spell.h"
 #include "unit/unit.h"
 #include "unit/unit_type.h"
+#include "util/string_util.h"
 
 struct LabelsStruct {
 	CAnimation *Anim;
@@ -90,194 +91,222 @@ int UnitShowAnimation(CUnit &unit, const CAnimation *anim)
 	return UnitShowAnimationScaled(unit, anim, 8);
 }
 
+namespace wyrmgus {
+
 /**
-**  Parse player number in animation frame
-**
-**  @param unit      Unit of the animation.
-**  @param parseint  Integer to parse.
+**  Compile an integer operand of an animation frame.
 **
-**  @return  The parsed value.
+**  @param str  The operand string, e.g. "v.HitPoints.Value", "g.Coward", "r.2.5", "l.this" or "3".
 */
-
-static int ParseAnimPlayer(const CUnit &unit, char *parseint)
+animation_operand::animation_operand(const std::string &str)
 {
-	if (!strcmp(parseint, "this")) {
-		return unit.Player->Index;
+	if (str.empty()) {
+		return;
 	}
-	return ParseAnimInt(unit, parseint);
-}
 
+	const char prefix = str[0];
+	const std::string cur = str.size() > 2 ? str.substr(2) : std::string();
 
-/**
-**  Parse integer in animation frame.
-**
-**  @param unit      Unit of the animation.
-**  @param parseint  Integer to parse.
-**
-**  @return  The parsed value.
-*/
-
-int ParseAnimInt(const CUnit &unit, const char *parseint)
-{
-	char s[100];
-	const CUnit *goal = &unit;
+	if (prefix == 'v' || prefix == 't') { //unit variable detected
+		this->goal = (prefix == 't');
 
-	if (!strlen(parseint)) {
-		return 0;
-	}
+		const size_t dot_pos = cur.find('.');
+		if (dot_pos == std::string::npos) {
+			throw std::runtime_error("Need also specify the variable \"" + cur + "\" tag.");
+		}
 
-	strcpy(s, parseint);
-	char *cur = &s[2];
-	if (s[0] == 'v' || s[0] == 't') { //unit variable detected
-		if (s[0] == 't') {
-			if (unit.CurrentOrder()->HasGoal()) {
-				goal = unit.CurrentOrder()->GetGoal();
+		const std::string variable_name = cur.substr(0, dot_pos);
+		this->index = UnitTypeVar.VariableNameLookup[variable_name.c_str()];// User variables
+		if (this->index == -1) {
+			if (variable_name == "ResourcesHeld") {
+				this->type = operand_type::resources_held;
+			} else if (variable_name == "ResourceActive") {
+				this->type = operand_type::resource_active;
+			} else if (variable_name == "InsideCount") {
+				this->type = operand_type::inside_count;
+			} else if (variable_name == "_Distance") {
+				this->type = operand_type::distance;
 			} else {
-				return 0;
-			}
-		}
-		char *next = strchr(cur, '.');
-		if (next == nullptr) {
-			throw std::runtime_error("Need also specify the variable \"" + std::string(cur) + "\" tag.");
-		} else {
-			*next = '\0';
-		}
-		const int index = UnitTypeVar.VariableNameLookup[cur];// User variables
-		if (index == -1) {
-			if (!strcmp(cur, "ResourcesHeld")) {
-				return goal->ResourcesHeld;
-			} else if (!strcmp(cur, "ResourceActive")) {
-				return goal->Resource.Active;
-			} else if (!strcmp(cur, "InsideCount")) {
-				return goal->InsideCount;
-			} else if (!strcmp(cur, "_Distance")) {
-				return unit.MapDistanceTo(*goal);
+				throw std::runtime_error("Bad variable name \"" + variable_name + "\".");
 			}
-			throw std::runtime_error("Bad variable name \"" + std::string(cur) + "\".");
+			return;
 		}
-		if (!strcmp(next + 1, "Value")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Value;
-			return goal->GetModifiedVariable(index, VariableValue);
-			//Wyrmgus end
-		} else if (!strcmp(next + 1, "Max")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Max;
-			return goal->GetModifiedVariable(index, VariableMax);
-			//Wyrmgus end
-		} else if (!strcmp(next + 1, "Increase")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Increase;
-			return goal->GetModifiedVariable(index, VariableIncrease);
-			//Wyrmgus end
-		} else if (!strcmp(next + 1, "Enable")) {
-			return goal->Variable[index].Enable;
-		} else if (!strcmp(next + 1, "Percent")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Value * 100 / goal->Variable[index].Max;
-			return goal->GetModifiedVariable(index, VariableValue) * 100 / goal->GetModifiedVariable(index, VariableMax);
-			//Wyrmgus end
-		}
-		return 0;
-	} else if (s[0] == 'b' || s[0] == 'g') { //unit bool flag detected
-		if (s[0] == 'g') {
-			if (unit.CurrentOrder()->HasGoal()) {
-				goal = unit.CurrentOrder()->GetGoal();
-			} else {
-				return 0;
-			}
+
+		this->type = operand_type::variable;
+		this->component = animation_operand::string_to_variable_component(cur.substr(dot_pos + 1));
+	} else if (prefix == 'b' || prefix == 'g') { //unit bool flag detected
+		this->goal = (prefix == 'g');
+		this->type = operand_type::bool_flag;
+		this->index = UnitTypeVar.BoolFlagNameLookup[cur.c_str()];// User bool flags
+		if (this->index == -1) {
+			throw std::runtime_error("Bad bool-flag name \"" + cur + "\".");
 		}
-		const int index = UnitTypeVar.BoolFlagNameLookup[cur];// User bool flags
-		if (index == -1) {
-			throw std::runtime_error("Bad bool-flag name \"" + std::string(cur) + "\".");
+	} else if (prefix == 's') { //spell type detected
+		this->type = operand_type::spell;
+		this->spell_identifier = cur;
+	} else if (prefix == 'S') { // check if autocast for this spell available
+		this->type = operand_type::autocast_spell;
+		this->spell_identifier = cur;
+	} else if (prefix == 'r') { //random value
+		this->type = operand_type::random;
+
+		const size_t dot_pos = cur.find('.');
+		if (dot_pos == std::string::npos) {
+			this->value = 0;
+			this->random_range = atoi(cur.c_str()) + 1;
+		} else {
+			this->value = atoi(cur.substr(0, dot_pos).c_str());
+			this->random_range = atoi(cur.substr(dot_pos + 1).c_str()) - this->value + 1;
 		}
-		return goal->Type->BoolFlag[index].value;
-	} else if (s[0] == 's') { //spell type detected
-		Assert(goal->CurrentAction() == UnitAction::SpellCast);
-		const COrder_SpellCast &order = *static_cast<COrder_SpellCast *>(goal->CurrentOrder());
-		const wyrmgus::spell &spell = order.GetSpell();
-		if (!strcmp(spell.get_identifier().c_str(), cur)) {
-			return 1;
+	} else if (prefix == 'l') { //player number
+		if (cur == "this") {
+			this->type = operand_type::player_index;
+		} else {
+			*this = animation_operand(cur);
 		}
-		return 0;
-	} else if (s[0] == 'S') { // check if autocast for this spell available
-		const wyrmgus::spell *spell = wyrmgus::spell::get(cur);
-		if (unit.is_autocast_spell(spell)) {
-			return 1;
+	} else {
+		// Check if we trying to parse a number
+		Assert(isdigit(prefix) || prefix == '-');
+		this->type = operand_type::literal;
+		this->value = atoi(str.c_str());
+	}
+}
+
+/**
+**  Evaluate the operand for a unit.
+**
+**  @param unit  Unit of the animation.
+**
+**  @return  The value of the operand.
+*/
+int animation_operand::evaluate(const CUnit &unit) const
+{
+	switch (this->type) {
+		case operand_type::none:
+			return 0;
+		case operand_type::literal:
+			return this->value;
+		case operand_type::random:
+			return this->value + SyncRand(this->random_range);
+		case operand_type::player_index:
+			return unit.Player->Index;
+		case operand_type::spell: {
+			Assert(unit.CurrentAction() == UnitAction::SpellCast);
+			const COrder_SpellCast &order = *static_cast<COrder_SpellCast *>(unit.CurrentOrder());
+			return order.GetSpell().get_identifier() == this->spell_identifier ? 1 : 0;
 		}
-		return 0;
-	} else if (s[0] == 'r') { //random value
-		char *next = strchr(cur, '.');
-		if (next == nullptr) {
-			return SyncRand(atoi(cur) + 1);
-		} else {
-			*next = '\0';
-			const int min = atoi(cur);
-			return min + SyncRand(atoi(next + 1) - min + 1);
+		case operand_type::autocast_spell:
+			return unit.is_autocast_spell(spell::get(this->spell_identifier)) ? 1 : 0;
+		default:
+			break;
+	}
+
+	const CUnit *goal = &unit;
+	if (this->goal) {
+		if (!unit.CurrentOrder()->HasGoal()) {
+			return 0;
 		}
-	} else if (s[0] == 'l') { //player number
-		return ParseAnimPlayer(unit, cur);
+		goal = unit.CurrentOrder()->GetGoal();
+	}
+
+	switch (this->type) {
+		case operand_type::variable:
+			switch (this->component) {
+				case variable_component::value:
+					return goal->GetModifiedVariable(this->index, VariableValue);
+				case variable_component::max:
+					return goal->GetModifiedVariable(this->index, VariableMax);
+				case variable_component::increase:
+					return goal->GetModifiedVariable(this->index, VariableIncrease);
+				case variable_component::enable:
+					return goal->Variable[this->index].Enable;
+				case variable_component::percent:
+					return goal->GetModifiedVariable(this->index, VariableValue) * 100 / goal->GetModifiedVariable(this->index, VariableMax);
+				default:
+					return 0;
+			}
+		case operand_type::resources_held:
+			return goal->ResourcesHeld;
+		case operand_type::resource_active:
+			return goal->Resource.Active;
+		case operand_type::inside_count:
+			return goal->InsideCount;
+		case operand_type::distance:
+			return unit.MapDistanceTo(*goal);
+		case operand_type::bool_flag:
+			return goal->Type->BoolFlag[this->index].value;
+		default:
+			return 0;
+	}
+}
 
+animation_operand::variable_component animation_operand::string_to_variable_component(const std::string &str)
+{
+	if (str == "Value") {
+		return variable_component::value;
+	} else if (str == "Max") {
+		return variable_component::max;
+	} else if (str == "Increase") {
+		return variable_component::increase;
+	} else if (str == "Enable") {
+		return variable_component::enable;
+	} else if (str == "Percent") {
+		return variable_component::percent;
 	}
-	// Check if we trying to parse a number
-	Assert(isdigit(s[0]) || s[0] == '-');
-	return atoi(parseint);
+
+	return variable_component::none;
+}
+
 }
 
 /**
 **  Parse flags list in animation frame.
 **
-**  @param unit       Unit of the animation.
+**  @param type       Type of the animation the flags belong to.
 **  @param parseflag  Flag list to parse.
 **
 **  @return The parsed value.
 */
-int ParseAnimFlags(const CUnit &unit, const char *parseflag)
+int ParseAnimFlags(const AnimationType type, const std::string &parseflag)
 {
-	char s[100];
 	int flags = 0;
 
-	strcpy(s, parseflag);
-	char *cur = s;
-	char *next = s;
-	while (next && *next) {
-		next = strchr(cur, '.');
-		if (next) {
-			*next = '\0';
-			++next;
+	for (const std::string &cur : string::split(parseflag, '.')) {
+		if (cur.empty()) {
+			continue;
 		}
-		if (unit.Anim.Anim->Type == AnimationSpawnMissile) {
-			if (!strcmp(cur, "none")) {
+
+		if (type == AnimationSpawnMissile) {
+			if (cur == "none") {
 				flags = SM_None;
 				return flags;
-			} else if (!strcmp(cur, "damage")) {
+			} else if (cur == "damage") {
 				flags |= SM_Damage;
-			} else if (!strcmp(cur, "totarget")) {
+			} else if (cur == "totarget") {
 				flags |= SM_ToTarget;
-			} else if (!strcmp(cur, "pixel")) {
+			} else if (cur == "pixel") {
 				flags |= SM_Pixel;
-			} else if (!strcmp(cur, "reltarget")) {
+			} else if (cur == "reltarget") {
 				flags |= SM_RelTarget;
-			} else if (!strcmp(cur, "ranged")) {
+			} else if (cur == "ranged") {
 				flags |= SM_Ranged;
-			}  else if (!strcmp(cur, "setdirection")) {
+			}  else if (cur == "setdirection") {
 				flags |= SM_SetDirection;
 			} else {
-				throw std::runtime_error("Unknown animation flag: \"" + std::string(cur) + "\".");
+				throw std::runtime_error("Unknown animation flag: \"" + cur + "\".");
 			}
-		} else if (unit.Anim.Anim->Type == AnimationSpawnUnit) {
-			if (!strcmp(cur, "none")) {
+		} else if (type == AnimationSpawnUnit) {
+			if (cur == "none") {
 				flags = SU_None;
 				return flags;
-			} else if (!strcmp(cur, "summoned")) {
+			} else if (cur == "summoned") {
 				flags |= SU_Summoned;
-			} else if (!strcmp(cur, "jointoai")) {
+			} else if (cur == "jointoai") {
 				flags |= SU_JoinToAIForce;
 			} else {
-				throw std::runtime_error("Unknown animation flag: \"" + std::string(cur) + "\".");
+				throw std::runtime_error("Unknown animation flag: \"" + cur + "\".");
 			}
 		}
-		cur = next;
 	}
 	return flags;
 }
@@ -328,6 +357,27 @@ int UnitShowAnimationScaled(CUnit &unit, const CAnimation *anim, int scale)
 	return move;
 }
 
+/**
+**  Count down the wait of the current step of a unit's animation, as handling the animation for a number of cycles would.
+**
+**  @param unit    Unit of the animation.
+**  @param cycles  Number of cycles, which must not be greater than the remaining wait.
+*/
+void UnitCountDownAnimationWait(CUnit &unit, int cycles)
+{
+	if (cycles <= 0) {
+		return;
+	}
+
+	Assert(cycles <= unit.Anim.Wait);
+
+	unit.Anim.Wait -= cycles;
+	if (!unit.Anim.Wait) {
+		// Advance to next frame
+		unit.Anim.Anim = unit.Anim.Anim->get_next();
+	}
+}
+
 static int GetAdvanceIndex(const CAnimation *base, const CAnimation *anim)
 {
 	if (base == anim) {
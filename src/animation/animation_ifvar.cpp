@@ -71,8 +71,8 @@ void CAnimation_IfVar::Action(CUnit &unit, int &/*move*/, int /*scale*/) const
 {
 	Assert(unit.Anim.Anim == this);
 
-	const int lop = ParseAnimInt(unit, this->leftVar.c_str());
-	const int rop = ParseAnimInt(unit, this->rightVar.c_str());
+	const int lop = this->left_operand.evaluate(unit);
+	const int rop = this->right_operand.evaluate(unit);
 	const bool cond = this->binOpFunc(lop, rop);
 
 	if (cond) {
@@ -87,7 +87,7 @@ void CAnimation_IfVar::Init(const char *s, lua_State *)
 {
 	const std::vector<std::string> str_list = string::split(s, ' ');
 
-	this->leftVar = str_list.at(0);
+	this->left_operand = wyrmgus::animation_operand(str_list.at(0));
 
 	const std::string op = str_list.at(1);
 
@@ -129,7 +129,7 @@ void CAnimation_IfVar::Init(const char *s, lua_State *)
 		}
 	}
 
-	this->rightVar = str_list.at(2);
+	this->right_operand = wyrmgus::animation_operand(str_list.at(2));
 
 	const std::string label = str_list.at(3);
 
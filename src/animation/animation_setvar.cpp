@@ -44,9 +44,9 @@
 {
 	Assert(unit.Anim.Anim == this);
 
-	char arg1[128];
+	using variable_component = wyrmgus::animation_operand::variable_component;
+
 	CUnit *goal = &unit;
-	strcpy(arg1, this->varStr.c_str());
 
 	if (this->unitSlotStr.empty() == false) {
 		switch (this->unitSlotStr[0]) {
@@ -65,38 +65,33 @@
 		return;
 	}
 
-	char *next = strchr(arg1, '.');
-	if (next == nullptr) {
+	if (this->index == -1) {
 		// Special case for non-unit_variable variables
-		if (!strcmp(arg1, "DamageType")) {
-			int death = ExtraDeathIndex(this->valueStr.c_str());
-			if (death == ANIMATIONS_DEATHTYPES) {
-				throw std::runtime_error("Incorrect death type: " + this->valueStr + ".");
-			}
-			goal->Type->DamageType = this->valueStr;
-			return;
-		}
-		throw std::runtime_error("Need also specify the variable \"" + std::string(arg1) + "\" tag.");
-	} else {
-		*next = '\0';
-	}
-	const int index = UnitTypeVar.VariableNameLookup[arg1];// User variables
-	if (index == -1) {
-		throw std::runtime_error("Bad variable name \"" + std::string(arg1) + "\".");
+		goal->Type->DamageType = this->valueStr;
+		return;
 	}
 
-	const int rop = ParseAnimInt(unit, this->valueStr.c_str());
+	const int index = this->index;
+	const int rop = this->value_operand.evaluate(unit);
 	int value = 0;
-	if (!strcmp(next + 1, "Value")) {
-		value = goal->Variable[index].Value;
-	} else if (!strcmp(next + 1, "Max")) {
-		value = goal->Variable[index].Max;
-	} else if (!strcmp(next + 1, "Increase")) {
-		value = goal->Variable[index].Increase;
-	} else if (!strcmp(next + 1, "Enable")) {
-		value = goal->Variable[index].Enable;
-	} else if (!strcmp(next + 1, "Percent")) {
-		value = goal->Variable[index].Value * 100 / goal->Variable[index].Max;
+	switch (this->component) {
+		case variable_component::value:
+			value = goal->Variable[index].Value;
+			break;
+		case variable_component::max:
+			value = goal->Variable[index].Max;
+			break;
+		case variable_component::increase:
+			value = goal->Variable[index].Increase;
+			break;
+		case variable_component::enable:
+			value = goal->Variable[index].Enable;
+			break;
+		case variable_component::percent:
+			value = goal->Variable[index].Value * 100 / goal->Variable[index].Max;
+			break;
+		default:
+			break;
 	}
 	switch (this->mod) {
 		case modAdd:
@@ -135,16 +130,24 @@
 		default:
 			value = rop;
 	}
-	if (!strcmp(next + 1, "Value")) {
-		goal->Variable[index].Value = value;
-	} else if (!strcmp(next + 1, "Max")) {
-		goal->Variable[index].Max = value;
-	} else if (!strcmp(next + 1, "Increase")) {
-		goal->Variable[index].Increase = value;
-	} else if (!strcmp(next + 1, "Enable")) {
-		goal->Variable[index].Enable = value;
-	} else if (!strcmp(next + 1, "Percent")) {
-		goal->Variable[index].Value = goal->Variable[index].Max * value / 100;
+	switch (this->component) {
+		case variable_component::value:
+			goal->Variable[index].Value = value;
+			break;
+		case variable_component::max:
+			goal->Variable[index].Max = value;
+			break;
+		case variable_component::increase:
+			goal->Variable[index].Increase = value;
+			break;
+		case variable_component::enable:
+			goal->Variable[index].Enable = value;
+			break;
+		case variable_component::percent:
+			goal->Variable[index].Value = goal->Variable[index].Max * value / 100;
+			break;
+		default:
+			break;
 	}
 	//Wyrmgus start
 //	clamp(&goal->Variable[index].Value, 0, goal->Variable[index].Max);
@@ -175,7 +178,7 @@
 
 	size_t begin = 0;
 	size_t end = str.find(' ', begin);
-	this->varStr.assign(str, begin, end - begin);
+	const std::string varStr(str, begin, end - begin);
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
@@ -212,4 +215,26 @@
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
 	this->unitSlotStr.assign(str, begin, end - begin);
+
+	const size_t dot_pos = varStr.find('.');
+	if (dot_pos == std::string::npos) {
+		// Special case for non-unit_variable variables
+		if (varStr == "DamageType") {
+			const int death = ExtraDeathIndex(this->valueStr.c_str());
+			if (death == ANIMATIONS_DEATHTYPES) {
+				throw std::runtime_error("Incorrect death type: " + this->valueStr + ".");
+			}
+			return;
+		}
+		throw std::runtime_error("Need also specify the variable \"" + varStr + "\" tag.");
+	}
+
+	const std::string variable_name = varStr.substr(0, dot_pos);
+	this->index = UnitTypeVar.VariableNameLookup[variable_name.c_str()];// User variables
+	if (this->index == -1) {
+		throw std::runtime_error("Bad variable name \"" + variable_name + "\".");
+	}
+	this->component = wyrmgus::animation_operand::string_to_variable_component(varStr.substr(dot_pos + 1));
+
+	this->value_operand = wyrmgus::animation_operand(this->valueStr);
 }
@@ -46,12 +46,12 @@
 {
 	Assert(unit.Anim.Anim == this);
 
-	const int startx = ParseAnimInt(unit, this->startXStr.c_str());
-	const int starty = ParseAnimInt(unit, this->startYStr.c_str());
-	const int destx = ParseAnimInt(unit, this->destXStr.c_str());
-	const int desty = ParseAnimInt(unit, this->destYStr.c_str());
-	const SpawnMissile_Flags flags = (SpawnMissile_Flags)(ParseAnimFlags(unit, this->flagsStr.c_str()));
-	const int offsetnum = ParseAnimInt(unit, this->offsetNumStr.c_str());
+	const int startx = this->start_x_operand.evaluate(unit);
+	const int starty = this->start_y_operand.evaluate(unit);
+	const int destx = this->dest_x_operand.evaluate(unit);
+	const int desty = this->dest_y_operand.evaluate(unit);
+	const SpawnMissile_Flags flags = this->flags;
+	const int offsetnum = this->offset_num_operand.evaluate(unit);
 	const CUnit *goal = flags & SM_RelTarget ? unit.CurrentOrder()->GetGoal() : &unit;
 	const int dir = ((goal->Direction + NextDirection / 2) & 0xFF) / NextDirection;
 	const PixelPos moff = goal->Type->MissileOffsets[dir][!offsetnum ? 0 : offsetnum - 1];
@@ -152,25 +152,25 @@
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->startXStr.assign(str, begin, end - begin);
+	this->start_x_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->startYStr.assign(str, begin, end - begin);
+	this->start_y_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->destXStr.assign(str, begin, end - begin);
+	this->dest_x_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->destYStr.assign(str, begin, end - begin);
+	this->dest_y_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->flagsStr.assign(str, begin, end - begin);
+	this->flags = static_cast<SpawnMissile_Flags>(ParseAnimFlags(this->Type, str.substr(begin, end - begin)));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->offsetNumStr.assign(str, begin, end - begin);
+	this->offset_num_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 }
@@ -41,11 +41,11 @@
 {
 	Assert(unit.Anim.Anim == this);
 
-	const int offX = ParseAnimInt(unit, this->offXStr.c_str());
-	const int offY = ParseAnimInt(unit, this->offYStr.c_str());
-	const int range = ParseAnimInt(unit, this->rangeStr.c_str());
-	const int playerId = ParseAnimInt(unit, this->playerStr.c_str());
-	const SpawnUnit_Flags flags = (SpawnUnit_Flags)(ParseAnimFlags(unit, this->flagsStr.c_str()));
+	const int offX = this->offset_x_operand.evaluate(unit);
+	const int offY = this->offset_y_operand.evaluate(unit);
+	const int range = this->range_operand.evaluate(unit);
+	const int playerId = this->player_operand.evaluate(unit);
+	const SpawnUnit_Flags flags = this->flags;
 
 	CPlayer &player = *CPlayer::Players[playerId];
 	const Vec2i pos(unit.tilePos.x + offX, unit.tilePos.y + offY);
@@ -90,23 +90,23 @@
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->offXStr.assign(str, begin, end - begin);
+	this->offset_x_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->offYStr.assign(str, begin, end - begin);
+	this->offset_y_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->rangeStr.assign(str, begin, end - begin);
+	this->range_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->playerStr.assign(str, begin, end - begin);
+	this->player_operand = wyrmgus::animation_operand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
 	if (begin != end) {
-		this->flagsStr.assign(str, begin, end - begin);
+		this->flags = static_cast<SpawnUnit_Flags>(ParseAnimFlags(this->Type, str.substr(begin, end - begin)));
 	}
 }
@@ -94,12 +94,15 @@
 #include "unit/unit_type.h"
 #include "upgrade/upgrade_class.h"
 #include "upgrade/upgrade_structs.h"
+#include "util/binary_stream.h"
 #include "util/qunique_ptr.h"
 #include "util/string_util.h"
 #include "video/font.h"
 #include "video/font_color.h"
 #include "world.h"
 
+#include <QFile>
+
 namespace wyrmgus {
 
 /**
@@ -111,45 +114,43 @@ namespace wyrmgus {
 void database::process_sml_property_for_object(QObject *object, const sml_property &property)
 {
 	const QMetaObject *meta_object = object->metaObject();
-	const std::string class_name = meta_object->className();
-	const int property_count = meta_object->propertyCount();
-	for (int i = 0; i < property_count; ++i) {
-		QMetaProperty meta_property = meta_object->property(i);
-		const char *property_name = meta_property.name();
+	const property_dispatch_info *dispatch_info = database::get_property_dispatch_info(meta_object, property.get_key());
 
-		if (property_name != property.get_key()) {
-			continue;
-		}
+	if (dispatch_info == nullptr) {
+		throw std::runtime_error("Invalid " + std::string(meta_object->className()) + " property: \"" + property.get_key() + "\".");
+	}
 
-		const QVariant::Type property_type = meta_property.type();
+	const QMetaProperty &meta_property = dispatch_info->meta_property;
+	const char *property_name = meta_property.name();
 
-		if (property_type == QVariant::Type::List || property_type == QVariant::Type::StringList) {
+	switch (dispatch_info->kind) {
+		case property_kind::list:
 			database::modify_list_property_for_object(object, property_name, property.get_operator(), property.get_value());
 			return;
-		} else if (property_type == QVariant::String) {
+		case property_kind::string: {
 			if (property.get_operator() != sml_operator::assignment) {
 				throw std::runtime_error("Only the assignment operator is available for string properties.");
 			}
 
-			const std::string method_name = "set_" + property.get_key();
-
-			const bool success = QMetaObject::invokeMethod(object, method_name.c_str(), Qt::ConnectionType::DirectConnection, Q_ARG(const std::string &, property.get_value()));
+			bool success = false;
+			if (dispatch_info->string_setter.isValid()) {
+				success = dispatch_info->string_setter.invoke(object, Qt::ConnectionType::DirectConnection, Q_ARG(const std::string &, property.get_value()));
+			}
 
 			if (!success) {
 				throw std::runtime_error("Failed to set value for string property \"" + property.get_key() + "\".");
 			}
 			return;
-		} else {
+		}
+		case property_kind::other: {
 			QVariant new_property_value = database::process_sml_property_value(property, meta_property, object);
-			bool success = object->setProperty(property_name, new_property_value);
+			const bool success = meta_property.write(object, new_property_value);
 			if (!success) {
 				throw std::runtime_error("Failed to set value for property \"" + std::string(property_name) + "\".");
 			}
 			return;
 		}
 	}
-
-	throw std::runtime_error("Invalid " + std::string(meta_object->className()) + " property: \"" + property.get_key() + "\".");
 }
 
 QVariant database::process_sml_property_value(const sml_property &property, const QMetaProperty &meta_property, const QObject *object)
@@ -330,46 +331,40 @@ QVariant database::process_sml_property_value(const sml_property &property, cons
 void database::process_sml_scope_for_object(QObject *object, const sml_data &scope)
 {
 	const QMetaObject *meta_object = object->metaObject();
-	const std::string class_name = meta_object->className();
-	const int property_count = meta_object->propertyCount();
-	for (int i = 0; i < property_count; ++i) {
-		QMetaProperty meta_property = meta_object->property(i);
-		const char *property_name = meta_property.name();
+	const property_dispatch_info *dispatch_info = database::get_property_dispatch_info(meta_object, scope.get_tag());
 
-		if (property_name != scope.get_tag()) {
-			continue;
-		}
+	if (dispatch_info == nullptr) {
+		throw std::runtime_error("Invalid " + std::string(meta_object->className()) + " scope property: \"" + scope.get_tag() + "\".");
+	}
 
-		const QVariant::Type property_type = meta_property.type();
+	const QMetaProperty &meta_property = dispatch_info->meta_property;
+	const char *property_name = meta_property.name();
+	const QVariant::Type property_type = meta_property.type();
 
-		if (scope.get_operator() == sml_operator::assignment) {
-			if ((property_type == QVariant::Type::List || property_type == QVariant::Type::StringList) && !scope.get_values().empty()) {
-				for (const std::string &value : scope.get_values()) {
-					database::modify_list_property_for_object(object, property_name, sml_operator::addition, value);
-				}
-				return;
-			} else if (property_type == QVariant::Type::List && scope.has_children()) {
-				scope.for_each_child([&](const sml_data &child_scope) {
-					database::modify_list_property_for_object(object, property_name, sml_operator::addition, child_scope);
-				});
-				return;
-			}
-		} else {
-			if (property_type == QVariant::Type::List) {
-				database::modify_list_property_for_object(object, property_name, scope.get_operator(), scope);
-				return;
+	if (scope.get_operator() == sml_operator::assignment) {
+		if (dispatch_info->kind == property_kind::list && !scope.get_values().empty()) {
+			for (const std::string &value : scope.get_values()) {
+				database::modify_list_property_for_object(object, property_name, sml_operator::addition, value);
 			}
+			return;
+		} else if (property_type == QVariant::Type::List && scope.has_children()) {
+			scope.for_each_child([&](const sml_data &child_scope) {
+				database::modify_list_property_for_object(object, property_name, sml_operator::addition, child_scope);
+			});
+			return;
 		}
-
-		QVariant new_property_value = database::process_sml_scope_value(scope, meta_property);
-		const bool success = object->setProperty(property_name, new_property_value);
-		if (!success) {
-			throw std::runtime_error("Failed to set value for scope property \"" + std::string(property_name) + "\".");
+	} else {
+		if (property_type == QVariant::Type::List) {
+			database::modify_list_property_for_object(object, property_name, scope.get_operator(), scope);
+			return;
 		}
-		return;
 	}
 
-	throw std::runtime_error("Invalid " + std::string(meta_object->className()) + " scope property: \"" + scope.get_tag() + "\".");
+	QVariant new_property_value = database::process_sml_scope_value(scope, meta_property);
+	const bool success = meta_property.write(object, new_property_value);
+	if (!success) {
+		throw std::runtime_error("Failed to set value for scope property \"" + std::string(property_name) + "\".");
+	}
 }
 
 QVariant database::process_sml_scope_value(const sml_data &scope, const QMetaProperty &meta_property)
@@ -417,6 +412,64 @@ QVariant database::process_sml_scope_value(const sml_data &scope, const QMetaPro
 	return new_property_value;
 }
 
+const database::property_dispatch_table &database::get_property_dispatch_table(const QMetaObject *meta_object)
+{
+	if (meta_object == database::last_property_dispatch_meta_object) {
+		return *database::last_property_dispatch_table;
+	}
+
+	auto table_iterator = database::property_dispatch_tables.find(meta_object);
+
+	if (table_iterator == database::property_dispatch_tables.end()) {
+		//build the table for the class, resolving what is needed to set each of its properties only once
+		property_dispatch_table table;
+		table.reserve(meta_object->propertyCount());
+
+		const int property_count = meta_object->propertyCount();
+		for (int i = 0; i < property_count; ++i) {
+			property_dispatch_info dispatch_info;
+			dispatch_info.meta_property = meta_object->property(i);
+
+			const std::string name = dispatch_info.meta_property.name();
+			const QVariant::Type property_type = dispatch_info.meta_property.type();
+
+			if (property_type == QVariant::Type::List || property_type == QVariant::Type::StringList) {
+				dispatch_info.kind = property_kind::list;
+			} else if (property_type == QVariant::String) {
+				dispatch_info.kind = property_kind::string;
+
+				const QByteArray setter_signature = QMetaObject::normalizedSignature(("set_" + name + "(const std::string &)").c_str());
+				const int setter_index = meta_object->indexOfMethod(setter_signature.constData());
+				if (setter_index != -1) {
+					dispatch_info.string_setter = meta_object->method(setter_index);
+				}
+			}
+
+			//the first property with a given name is used, as with a linear scan of the properties
+			table.emplace(name, std::move(dispatch_info));
+		}
+
+		table_iterator = database::property_dispatch_tables.emplace(meta_object, std::move(table)).first;
+	}
+
+	//references to the elements of an unordered map remain valid when it rehashes
+	database::last_property_dispatch_meta_object = meta_object;
+	database::last_property_dispatch_table = &table_iterator->second;
+
+	return table_iterator->second;
+}
+
+const database::property_dispatch_info *database::get_property_dispatch_info(const QMetaObject *meta_object, const std::string &property_name)
+{
+	const property_dispatch_table &table = database::get_property_dispatch_table(meta_object);
+	const auto find_iterator = table.find(property_name);
+	if (find_iterator != table.end()) {
+		return &find_iterator->second;
+	}
+
+	return nullptr;
+}
+
 void database::modify_list_property_for_object(QObject *object, const std::string &property_name, const sml_operator sml_operator, const std::string &value)
 {
 	const QMetaObject *meta_object = object->metaObject();
@@ -527,6 +580,8 @@ std::filesystem::path database::get_base_path(const module *module)
 
 void database::parse_folder(const std::filesystem::path &path, std::vector<sml_data> &sml_data_list)
 {
+	std::vector<std::filesystem::path> filepaths;
+
 	std::filesystem::recursive_directory_iterator dir_iterator(path);
 
 	for (const std::filesystem::directory_entry &dir_entry : dir_iterator) {
@@ -534,8 +589,189 @@ void database::parse_folder(const std::filesystem::path &path, std::vector<sml_d
 			continue;
 		}
 
-		sml_parser parser(dir_entry.path());
-		sml_data_list.push_back(parser.parse());
+		filepaths.push_back(dir_entry.path());
+	}
+
+	if (filepaths.empty()) {
+		return;
+	}
+
+	//use the cached parse results if none of the folder's files have been added, removed or modified since they were cached
+	const std::filesystem::path cache_filepath = database::get_folder_cache_filepath(path);
+	const std::string cache_key = database::get_folder_cache_key(path, filepaths);
+
+	if (!cache_filepath.empty() && database::load_folder_cache(cache_filepath, cache_key, sml_data_list)) {
+		++database::cached_folder_count;
+		return;
+	}
+
+	//parse the files on several threads, each taking the next unparsed file until none are left; the results are stored by file index, so that they are added in the same order as if parsed sequentially
+	std::vector<sml_data> file_sml_data_list(filepaths.size());
+	std::vector<std::exception_ptr> file_exceptions(filepaths.size());
+	std::atomic<size_t> next_file_index(0);
+
+	const auto parse_files = [&]() {
+		for (size_t i = next_file_index++; i < filepaths.size(); i = next_file_index++) {
+			try {
+				sml_parser parser(filepaths[i]);
+				file_sml_data_list[i] = parser.parse();
+			} catch (...) {
+				file_exceptions[i] = std::current_exception();
+			}
+		}
+	};
+
+	const size_t thread_count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), filepaths.size());
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 1; i < thread_count; ++i) {
+		futures.push_back(std::async(std::launch::async, parse_files));
+	}
+
+	parse_files();
+
+	for (std::future<void> &future : futures) {
+		future.wait();
+	}
+
+	for (const std::exception_ptr &file_exception : file_exceptions) {
+		if (file_exception != nullptr) {
+			std::rethrow_exception(file_exception);
+		}
+	}
+
+	if (!cache_filepath.empty()) {
+		database::save_folder_cache(cache_filepath, cache_key, file_sml_data_list);
+	}
+
+	for (sml_data &file_sml_data : file_sml_data_list) {
+		sml_data_list.push_back(std::move(file_sml_data));
+	}
+
+	++database::parsed_folder_count;
+}
+
+std::string database::get_folder_cache_key(const std::filesystem::path &path, const std::vector<std::filesystem::path> &filepaths)
+{
+	//the key identifies the exact set of files in the folder, together with their sizes and modification times
+	binary_writer writer;
+	writer.write_string(path.generic_string());
+	writer.write_uint32(static_cast<uint32_t>(filepaths.size()));
+
+	for (const std::filesystem::path &filepath : filepaths) {
+		writer.write_string(filepath.lexically_relative(path).generic_string());
+		writer.write_uint64(static_cast<uint64_t>(std::filesystem::file_size(filepath)));
+		writer.write_uint64(static_cast<uint64_t>(std::filesystem::last_write_time(filepath).time_since_epoch().count()));
+	}
+
+	return writer.get_data();
+}
+
+std::filesystem::path database::get_folder_cache_filepath(const std::filesystem::path &path)
+{
+	const std::filesystem::path cache_path = database::get_cache_path();
+	if (cache_path.empty()) {
+		return std::filesystem::path();
+	}
+
+	//name the cache file after a FNV-1a hash of the folder's path, so that each data folder of each module has its own cache file
+	uint64_t hash = 14695981039346656037ULL;
+	for (const char c : std::filesystem::absolute(path).generic_string()) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ULL;
+	}
+
+	char filename[32];
+	snprintf(filename, sizeof(filename), "%016llx.bin", static_cast<unsigned long long>(hash));
+	return cache_path / filename;
+}
+
+bool database::load_folder_cache(const std::filesystem::path &cache_filepath, const std::string &cache_key, std::vector<sml_data> &sml_data_list)
+{
+	QFile file(QString::fromStdString(cache_filepath.string()));
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+
+	const qint64 size = file.size();
+	QByteArray file_data;
+	const char *data = reinterpret_cast<const char *>(file.map(0, size));
+	if (data == nullptr) {
+		file_data = file.readAll();
+		data = file_data.constData();
+	}
+
+	//an invalid or outdated cache is not an error: the folder is just parsed again
+	try {
+		binary_reader reader(data, static_cast<size_t>(size));
+
+		if (reader.read_uint32() != database::cache_magic || reader.read_uint32() != database::cache_version) {
+			return false;
+		}
+
+		if (reader.read_string() != cache_key) {
+			return false;
+		}
+
+		const uint32_t data_count = reader.read_uint32();
+		std::vector<sml_data> cached_sml_data_list;
+		cached_sml_data_list.reserve(data_count);
+		for (uint32_t i = 0; i < data_count; ++i) {
+			cached_sml_data_list.push_back(sml_data::from_binary(reader));
+		}
+
+		if (!reader.is_at_end()) {
+			return false;
+		}
+
+		for (sml_data &cached_sml_data : cached_sml_data_list) {
+			sml_data_list.push_back(std::move(cached_sml_data));
+		}
+	} catch (const std::exception &) {
+		return false;
+	}
+
+	return true;
+}
+
+void database::save_folder_cache(const std::filesystem::path &cache_filepath, const std::string &cache_key, const std::vector<sml_data> &sml_data_list)
+{
+	binary_writer writer;
+	writer.write_uint32(database::cache_magic);
+	writer.write_uint32(database::cache_version);
+	writer.write_string(cache_key);
+	writer.write_uint32(static_cast<uint32_t>(sml_data_list.size()));
+
+	for (const sml_data &data : sml_data_list) {
+		data.save_binary(writer);
+	}
+
+	//write to a temporary file first, so that an interrupted write cannot leave a truncated cache behind; failing to write the cache is not an error, since it only makes the next startup slower
+	std::error_code error_code;
+	std::filesystem::create_directories(cache_filepath.parent_path(), error_code);
+	if (error_code) {
+		return;
+	}
+
+	std::filesystem::path temp_filepath = cache_filepath;
+	temp_filepath += ".tmp";
+
+	{
+		std::ofstream ofstream(temp_filepath, std::ios::binary | std::ios::trunc);
+		if (!ofstream) {
+			return;
+		}
+
+		const std::string &data = writer.get_data();
+		ofstream.write(data.data(), static_cast<std::streamsize>(data.size()));
+		if (!ofstream) {
+			return;
+		}
+	}
+
+	std::filesystem::rename(temp_filepath, cache_filepath, error_code);
+	if (error_code) {
+		std::filesystem::remove(temp_filepath, error_code);
 	}
 }
 
@@ -575,11 +811,26 @@ void database::load(const bool initial_definition)
 			return a->get_database_dependency_count() < b->get_database_dependency_count();
 		});
 
+		const auto start_time = std::chrono::steady_clock::now();
 		this->load_predefines();
+		const auto predefines_time = std::chrono::steady_clock::now();
 		this->process_modules();
+		const auto modules_time = std::chrono::steady_clock::now();
+		database::cached_folder_count = 0;
+		database::parsed_folder_count = 0;
 		this->parse();
+		const auto parse_time = std::chrono::steady_clock::now();
+
+		fprintf(stdout, "Database startup: predefines %lld ms, modules %lld ms, parsing %lld ms (%u folders from cache, %u parsed).\n",
+			static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(predefines_time - start_time).count()),
+			static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(modules_time - predefines_time).count()),
+			static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(parse_time - modules_time).count()),
+			static_cast<unsigned int>(database::cached_folder_count),
+			static_cast<unsigned int>(database::parsed_folder_count));
 	}
 
+	const auto processing_start_time = std::chrono::steady_clock::now();
+
 	try {
 		//create or process data entries for each data type
 		for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
@@ -588,6 +839,8 @@ void database::load(const bool initial_definition)
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Failed to process database."));
 	}
+
+	fprintf(stdout, "Database processing: %lld ms.\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - processing_start_time).count()));
 }
 
 void database::load_predefines()
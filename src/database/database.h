@@ -46,6 +46,9 @@ public:
 	static constexpr const char *maps_folder = "maps";
 	static constexpr const char *sounds_folder = "sounds";
 
+	static constexpr uint32_t cache_magic = 0x43445357; //"WSDC"
+	static constexpr uint32_t cache_version = 1; //increase when the format of the cache or the SML parsing rules change
+
 	template <typename T>
 	static void process_sml_data(T *instance, const sml_data &data)
 	{
@@ -128,8 +131,53 @@ public:
 		return database::get_base_path(module) / database::sounds_folder;
 	}
 
+	static std::filesystem::path get_cache_path()
+	{
+		const std::string cache_path_str = QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString();
+		if (cache_path_str.empty()) {
+			return std::filesystem::path();
+		}
+
+		return std::filesystem::path(cache_path_str) / "database";
+	}
+
 	static void parse_folder(const std::filesystem::path &path, std::vector<sml_data> &sml_data_list);
 
+private:
+	enum class property_kind {
+		other,
+		list,
+		string
+	};
+
+	//the pre-resolved information needed to set a property of a QObject-derived class
+	struct property_dispatch_info final
+	{
+		QMetaProperty meta_property;
+		property_kind kind = property_kind::other;
+		QMetaMethod string_setter; //the "set_" method taking a string, for string properties
+	};
+
+	using property_dispatch_table = std::unordered_map<std::string, property_dispatch_info>;
+
+	static const property_dispatch_table &get_property_dispatch_table(const QMetaObject *meta_object);
+	static const property_dispatch_info *get_property_dispatch_info(const QMetaObject *meta_object, const std::string &property_name);
+
+	static std::string get_folder_cache_key(const std::filesystem::path &path, const std::vector<std::filesystem::path> &filepaths);
+	static std::filesystem::path get_folder_cache_filepath(const std::filesystem::path &path);
+	static bool load_folder_cache(const std::filesystem::path &cache_filepath, const std::string &cache_key, std::vector<sml_data> &sml_data_list);
+	static void save_folder_cache(const std::filesystem::path &cache_filepath, const std::string &cache_key, const std::vector<sml_data> &sml_data_list);
+
+	//the property dispatch tables for each class, built the first time an object of the class is processed
+	static inline std::unordered_map<const QMetaObject *, property_dispatch_table> property_dispatch_tables;
+
+	//the class of the last processed object and its table; the properties of an object are processed consecutively, so the table is looked up once per object rather than once per property
+	static inline const QMetaObject *last_property_dispatch_meta_object = nullptr;
+	static inline const property_dispatch_table *last_property_dispatch_table = nullptr;
+
+	static inline size_t cached_folder_count = 0;
+	static inline size_t parsed_folder_count = 0;
+
 public:
 	database();
 	~database();
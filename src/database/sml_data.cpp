@@ -33,9 +33,39 @@
 
 #include "database/sml_operator.h"
 #include "database/sml_property_visitor.h"
+#include "util/binary_stream.h"
 
 namespace wyrmgus {
 
+sml_data sml_data::from_binary(binary_reader &reader)
+{
+	std::string tag = reader.read_identifier();
+	const sml_operator scope_operator = static_cast<sml_operator>(reader.read_uint8());
+	sml_data data(std::move(tag), scope_operator);
+
+	const uint32_t value_count = reader.read_uint32();
+	data.values.reserve(value_count);
+	for (uint32_t i = 0; i < value_count; ++i) {
+		data.values.push_back(reader.read_identifier());
+	}
+
+	const uint32_t element_count = reader.read_uint32();
+	data.elements.reserve(element_count);
+	for (uint32_t i = 0; i < element_count; ++i) {
+		const bool is_scope = reader.read_uint8() != 0;
+		if (is_scope) {
+			data.elements.push_back(sml_data::from_binary(reader));
+		} else {
+			std::string key = reader.read_identifier();
+			const sml_operator property_operator = static_cast<sml_operator>(reader.read_uint8());
+			std::string value = reader.read_identifier();
+			data.elements.push_back(sml_property(std::move(key), property_operator, std::move(value)));
+		}
+	}
+
+	return data;
+}
+
 sml_data::sml_data(std::string &&tag)
 	: tag(std::move(tag)), scope_operator(sml_operator::assignment)
 {
@@ -91,4 +121,26 @@ void sml_data::print(std::ofstream &ofstream, const size_t indentation, const bo
 	}
 }
 
+void sml_data::save_binary(binary_writer &writer) const
+{
+	writer.write_identifier(this->get_tag());
+	writer.write_uint8(static_cast<uint8_t>(this->get_operator()));
+
+	writer.write_uint32(static_cast<uint32_t>(this->get_values().size()));
+	for (const std::string &value : this->get_values()) {
+		writer.write_identifier(value);
+	}
+
+	writer.write_uint32(static_cast<uint32_t>(this->get_elements().size()));
+	this->for_each_element([&](const sml_property &property) {
+		writer.write_uint8(0);
+		writer.write_identifier(property.get_key());
+		writer.write_uint8(static_cast<uint8_t>(property.get_operator()));
+		writer.write_identifier(property.get_value());
+	}, [&](const sml_data &scope) {
+		writer.write_uint8(1);
+		scope.save_binary(writer);
+	});
+}
+
 }
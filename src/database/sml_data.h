@@ -38,6 +38,8 @@
 
 namespace wyrmgus {
 
+class binary_reader;
+class binary_writer;
 class sml_parser;
 
 //stratagus markup language data
@@ -53,6 +55,8 @@ public:
 		return point_data;
 	}
 
+	static sml_data from_binary(binary_reader &reader);
+
 	explicit sml_data(std::string &&tag = std::string());
 
 	explicit sml_data(std::string &&tag, const sml_operator scope_operator)
@@ -292,6 +296,7 @@ public:
 	}
 
 	void print(std::ofstream &ofstream, const size_t indentation, const bool new_line) const;
+	void save_binary(binary_writer &writer) const;
 
 	void print_components(std::ofstream &ofstream, const size_t indentation = 0) const
 	{
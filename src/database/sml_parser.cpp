@@ -34,6 +34,8 @@
 #include "database/sml_data.h"
 #include "database/sml_operator.h"
 
+#include <QFile>
+
 namespace wyrmgus {
 
 sml_parser::sml_parser(const std::filesystem::path &filepath)
@@ -47,23 +49,47 @@ sml_data sml_parser::parse()
 		throw std::runtime_error("File \"" + this->filepath.string() + "\" not found.");
 	}
 
-	std::ifstream ifstream(this->filepath);
+	QFile file(QString::fromStdString(this->filepath.string()));
 
-	if (!ifstream) {
+	if (!file.open(QIODevice::ReadOnly)) {
 		throw std::runtime_error("Failed to open file: " + this->filepath.string());
 	}
 
+	//map the file into memory, so that its lines can be tokenized in place instead of being copied into strings first
+	const qint64 file_size = file.size();
+	const char *file_data = nullptr;
+	QByteArray file_contents;
+
+	if (file_size > 0) {
+		file_data = reinterpret_cast<const char *>(file.map(0, file_size));
+
+		if (file_data == nullptr) {
+			//fall back to reading the file if it can't be mapped
+			file_contents = file.readAll();
+			file_data = file_contents.constData();
+		}
+	}
+
+	const std::string_view content(file_data, static_cast<size_t>(file_size));
+
 	sml_data file_sml_data(this->filepath.stem().string());
 
-	std::string line;
 	int line_index = 1;
 	this->current_sml_data = &file_sml_data;
 
 	try {
-		while (std::getline(ifstream, line)) {
-			this->parse_line(line);
+		size_t line_start = 0;
+		while (line_start < content.size()) {
+			size_t line_end = content.find('\n', line_start);
+			if (line_end == std::string_view::npos) {
+				line_end = content.size();
+			}
+
+			this->parse_line(content.substr(line_start, line_end - line_start));
 			this->parse_tokens();
 			++line_index;
+
+			line_start = line_end + 1;
 		}
 	} catch (std::exception &exception) {
 		throw std::runtime_error("Error parsing data file \"" + this->filepath.string() + "\", line " + std::to_string(line_index) + ": " + exception.what());
@@ -74,18 +100,33 @@ sml_data sml_parser::parse()
 	return file_sml_data;
 }
 
-void sml_parser::parse_line(const std::string &line)
+void sml_parser::parse_line(const std::string_view &line)
 {
 	bool opened_quotation_marks = false;
 	bool escaped = false;
 	std::string current_string;
 
-	for (const char c : line) {
+	//plain characters are not appended one by one, but as runs taken directly from the line
+	size_t run_start = 0;
+	size_t run_length = 0;
+
+	const auto flush_run = [&]() {
+		if (run_length > 0) {
+			current_string.append(line.data() + run_start, run_length);
+			run_length = 0;
+		}
+	};
+
+	for (size_t i = 0; i < line.size(); ++i) {
+		const char c = line[i];
+
 		if (!escaped) {
 			if (c == '\"') {
+				flush_run();
 				opened_quotation_marks = !opened_quotation_marks;
 				continue;
 			} else if (c == '\\') {
+				flush_run();
 				escaped = true; //escape character, so that e.g. newlines can be properly added to text
 				continue;
 			}
@@ -98,6 +139,8 @@ void sml_parser::parse_line(const std::string &line)
 
 			//whitespace, carriage returns and etc. separate tokens, if they occur outside of quotes
 			if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+				flush_run();
+
 				if (!current_string.empty()) {
 					this->tokens.push_back(std::move(current_string));
 					current_string = std::string();
@@ -115,9 +158,14 @@ void sml_parser::parse_line(const std::string &line)
 			}
 		}
 
-		current_string += c;
+		if (run_length == 0) {
+			run_start = i;
+		}
+		++run_length;
 	}
 
+	flush_run();
+
 	if (!current_string.empty()) {
 		this->tokens.push_back(std::move(current_string));
 	}
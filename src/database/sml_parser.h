@@ -44,7 +44,7 @@ public:
 	sml_data parse();
 
 private:
-	void parse_line(const std::string &line);
+	void parse_line(const std::string_view &line);
 	bool parse_escaped_character(std::string &current_string, const char c);
 	void parse_tokens();
 	void reset();
@@ -2661,6 +2661,8 @@ void EditorMainLoop()
 				}
 			}
 
+			UI.get_minimap()->upload_textures();
+
 			EditorUpdateDisplay();
 
 			//
@@ -47,6 +47,7 @@
 #include "unit/unit.h"
 #include "unit/unit_manager.h"
 #include "unit/unit_type.h"
+#include "unit/unit_wakeup_scheduler.h"
 #include "upgrade/upgrade.h"
 #include "util/date_util.h"
 #include "util/random.h"
@@ -166,6 +167,8 @@ int SaveGame(const std::string &filename)
 	SaveUpgrades(file);
 	SavePlayers(file);
 	CMap::Map.Save(file);
+	//the sleep state of units isn't saved, so their skipped cycles have to be applied to their wait timers before saving them
+	wyrmgus::unit_wakeup_scheduler::get()->wake_and_apply_all();
 	UnitManager.Save(file);
 	SaveUserInterface(file);
 	SaveAi(file);
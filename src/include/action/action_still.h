@@ -34,6 +34,8 @@
 class COrder_Still : public COrder
 {
 public:
+	static constexpr int max_idle_sleep_cycles = CYCLES_PER_SECOND / 6; //the most cycles an idle unit sleeps through, and thus how long it can take for it to react to enemies coming into range
+
 	explicit COrder_Still(bool stand) : COrder(stand ? UnitAction::StandGround : UnitAction::Still), State(0) {}
 
 	virtual std::unique_ptr<COrder> Clone() const override
@@ -47,6 +49,7 @@ public:
 	virtual bool ParseSpecificData(lua_State *l, int &j, const char *value, const CUnit &unit);
 
 	virtual void Execute(CUnit &unit);
+	virtual int get_sleep_cycles(const CUnit &unit) const;
 	virtual void OnAnimationAttack(CUnit &unit);
 	virtual PixelPos Show(const CViewport &vp, const PixelPos &lastScreenPos) const;
 	virtual void UpdatePathFinderData(PathFinderInput &input) { UpdatePathFinderData_NotCalled(input); }
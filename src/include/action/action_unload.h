@@ -53,6 +53,17 @@ public:
 	virtual bool ParseSpecificData(lua_State *l, int &j, const char *value, const CUnit &unit) override;
 
 	virtual void Execute(CUnit &unit) override;
+
+	virtual int get_sleep_cycles(const CUnit &unit) const override
+	{
+		return GetWaitingSleepCycles(unit);
+	}
+
+	virtual bool counts_down_wait_while_asleep() const override
+	{
+		return true;
+	}
+
 	virtual PixelPos Show(const CViewport &vp, const PixelPos &lastScreenPos) const override;
 	virtual void UpdatePathFinderData(PathFinderInput &input) override;
 
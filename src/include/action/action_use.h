@@ -49,6 +49,17 @@ public:
 	virtual bool ParseSpecificData(lua_State *l, int &j, const char *value, const CUnit &unit);
 
 	virtual void Execute(CUnit &unit);
+
+	virtual int get_sleep_cycles(const CUnit &unit) const
+	{
+		return GetWaitingSleepCycles(unit);
+	}
+
+	virtual bool counts_down_wait_while_asleep() const
+	{
+		return true;
+	}
+
 	virtual PixelPos Show(const CViewport &vp, const PixelPos &lastScreenPos) const;
 	virtual void UpdatePathFinderData(PathFinderInput &input);
 private:
@@ -101,9 +101,26 @@ public:
 	}
 	virtual ~COrder();
 
+	//orders are created and destroyed very often, so their memory is recycled through a pool instead of going through the global allocator every time
+	static void *operator new(const size_t size);
+	static void operator delete(void *ptr, const size_t size);
+
 	virtual std::unique_ptr<COrder> Clone() const = 0;
 	virtual void Execute(CUnit &unit) = 0;
 
+	/// Get the number of the following cycles in which executing the order would only count down the unit's animation wait, which the unit can sleep through
+	virtual int get_sleep_cycles(const CUnit &unit) const
+	{
+		Q_UNUSED(unit)
+		return 0;
+	}
+
+	/// Whether the unit's action wait also counts down in the cycles given by get_sleep_cycles
+	virtual bool counts_down_wait_while_asleep() const
+	{
+		return false;
+	}
+
 	virtual void Cancel(CUnit &unit)
 	{
 		Q_UNUSED(unit)
@@ -219,3 +236,6 @@ extern std::unique_ptr<COrder> CclParseOrder(lua_State *l, CUnit &unit);
 
 /// Handle the actions of all units each game cycle
 extern void UnitActions();
+
+/// Get the cycles a unit waiting with its still animation can sleep through
+extern int GetWaitingSleepCycles(const CUnit &unit);
@@ -88,6 +88,68 @@ enum SetVar_ModifyTypes {
 	modNot,          /// Bitwise NOT
 };
 
+namespace wyrmgus {
+
+/**
+**  An integer operand of an animation frame (e.g. "v.HitPoints.Value" or "r.2.5").
+**
+**  The string form is compiled when the animation is loaded, so that evaluating the operand while the animation runs does not require any string handling or name lookups.
+*/
+class animation_operand final
+{
+public:
+	enum class operand_type {
+		none, //empty operand, evaluates to 0
+		literal,
+		variable,
+		resources_held,
+		resource_active,
+		inside_count,
+		distance,
+		bool_flag,
+		spell,
+		autocast_spell,
+		random,
+		player_index
+	};
+
+	enum class variable_component {
+		none,
+		value,
+		max,
+		increase,
+		enable,
+		percent
+	};
+
+	animation_operand()
+	{
+	}
+
+	explicit animation_operand(const std::string &str);
+
+	bool is_empty() const
+	{
+		return this->type == operand_type::none;
+	}
+
+	int evaluate(const CUnit &unit) const;
+
+	/// Parse the component part of a unit variable reference (e.g. "Value" or "Max")
+	static variable_component string_to_variable_component(const std::string &str);
+
+private:
+	operand_type type = operand_type::none;
+	bool goal = false; //whether the operand refers to the goal of the unit's current order instead of the unit itself
+	int index = -1; //the variable or bool flag index
+	variable_component component = variable_component::none;
+	int value = 0; //the literal value, or the minimum for random operands
+	int random_range = 0;
+	std::string spell_identifier;
+};
+
+}
+
 class CAnimation
 {
 public:
@@ -191,8 +253,9 @@ extern void AnimationCclRegister();
 extern int UnitShowAnimationScaled(CUnit &unit, const CAnimation *anim, int scale);
 /// Handle the animation of a unit
 extern int UnitShowAnimation(CUnit &unit, const CAnimation *anim);
+/// Count down the wait of the current step of a unit's animation, as handling it for a number of cycles would
+extern void UnitCountDownAnimationWait(CUnit &unit, int cycles);
 
-extern int ParseAnimInt(const CUnit &unit, const char *parseint);
-extern int ParseAnimFlags(const CUnit &unit, const char *parseflag);
+extern int ParseAnimFlags(const AnimationType type, const std::string &parseflag);
 
 extern void FindLabelLater(CAnimation **anim, const std::string &name);
@@ -43,8 +43,8 @@ private:
 	typedef bool BinOpFunc(int lhs, int rhs);
 
 private:
-	std::string leftVar;
-	std::string rightVar;
+	wyrmgus::animation_operand left_operand;
+	wyrmgus::animation_operand right_operand;
 	BinOpFunc *binOpFunc;
 	CAnimation *gotoLabel;
 };
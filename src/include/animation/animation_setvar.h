@@ -41,7 +41,9 @@ public:
 
 private:
 	SetVar_ModifyTypes mod;
-	std::string varStr;
+	int index = -1; //the variable index, or -1 for the damage type
+	wyrmgus::animation_operand::variable_component component = wyrmgus::animation_operand::variable_component::none;
 	std::string valueStr;
+	wyrmgus::animation_operand value_operand;
 	std::string unitSlotStr;
 };
@@ -53,10 +53,10 @@ public:
 
 private:
 	std::string missileTypeStr;
-	std::string startXStr;
-	std::string startYStr;
-	std::string destXStr;
-	std::string destYStr;
-	std::string flagsStr;
-	std::string offsetNumStr;
+	wyrmgus::animation_operand start_x_operand;
+	wyrmgus::animation_operand start_y_operand;
+	wyrmgus::animation_operand dest_x_operand;
+	wyrmgus::animation_operand dest_y_operand;
+	SpawnMissile_Flags flags = SM_None;
+	wyrmgus::animation_operand offset_num_operand;
 };
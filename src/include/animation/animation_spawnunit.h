@@ -48,9 +48,9 @@ public:
 
 private:
 	std::string unitTypeStr;
-	std::string offXStr;
-	std::string offYStr;
-	std::string rangeStr;
-	std::string playerStr;
-	std::string flagsStr;
+	wyrmgus::animation_operand offset_x_operand;
+	wyrmgus::animation_operand offset_y_operand;
+	wyrmgus::animation_operand range_operand;
+	wyrmgus::animation_operand player_operand;
+	SpawnUnit_Flags flags = SU_None;
 };
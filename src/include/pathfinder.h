@@ -43,6 +43,10 @@
 
 class CUnit;
 class CFile;
+
+namespace wyrmgus {
+	class tile;
+}
 struct lua_State;
 
 /**
@@ -231,6 +235,11 @@ extern const int XY2Heading[3][3];
 extern void InitPathfinder();
 /// Free the pathfinder
 extern void FreePathfinder();
+/// Notify the pathfinder that the passability of a tile may have changed
+extern void PathfinderTileChanged(const Vec2i &pos, int z);
+/// Whether a tile can be crossed with a movement mask, disregarding moving units on it
+extern bool TilePassableIgnoringMovingUnits(const Vec2i &pos, int z, unsigned long movement_mask);
+extern bool TilePassableIgnoringMovingUnits(const wyrmgus::tile &tile, unsigned long movement_mask);
 
 /// Returns the next element of the path
 extern int NextPathElement(CUnit &unit, short int *xdp, short int *ydp);
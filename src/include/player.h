@@ -365,10 +365,12 @@ public:
 	int SpeedUpgrade;                /// speed factor for upgrading
 	int SpeedResearch;               /// speed factor for researching
 
-	wyrmgus::unit_type_map<int> UnitTypesCount;  						/// total units of unit-type
-	wyrmgus::unit_type_map<int> UnitTypesUnderConstructionCount;  		/// total under construction units of unit-type
-	wyrmgus::unit_type_map<int> UnitTypesAiActiveCount;  				/// total units of unit-type that have their AI set to active
 private:
+	std::vector<int> unit_type_counts; //total units of each unit type, indexed by unit type index
+	std::vector<int> unit_type_under_construction_counts; //total under construction units of each unit type
+	std::vector<int> unit_type_ai_active_counts; //total units of each unit type that have their AI set to active
+	std::vector<int> unit_class_counts; //total units of each unit class, indexed by unit class index
+	std::vector<int> unit_class_ai_active_counts; //total units of each unit class that have their AI set to active
 	wyrmgus::unit_type_map<std::vector<CUnit *>> units_by_type; //units owned by this player for each type
 	wyrmgus::unit_class_map<std::vector<CUnit *>> units_by_class;
 public:
@@ -503,15 +505,8 @@ public:
 	void ChangeUnitTypeAiActiveCount(const wyrmgus::unit_type *type, int quantity);
 	int GetUnitTypeAiActiveCount(const wyrmgus::unit_type *type) const;
 
-	int get_unit_class_count(const wyrmgus::unit_class *unit_class) const
-	{
-		const auto find_iterator = this->units_by_class.find(unit_class);
-		if (find_iterator != this->units_by_class.end()) {
-			return static_cast<int>(find_iterator->second.size());
-		}
-		
-		return 0;
-	}
+	int get_unit_class_count(const wyrmgus::unit_class *unit_class) const;
+	int get_unit_class_ai_active_count(const wyrmgus::unit_class *unit_class) const;
 
 	void IncreaseCountsForUnit(CUnit *unit, bool type_change = false);
 	void DecreaseCountsForUnit(CUnit *unit, bool type_change = false);
@@ -535,7 +530,7 @@ public:
 	*/
 	bool IsEnemy(const int index) const
 	{
-		return this->Index != index && this->enemies.contains(index);
+		return this->Index != index && (this->enemy_mask & wyrmgus::get_player_mask(index)) != 0;
 	}
 
 	bool IsEnemy(const CPlayer &player) const;
@@ -543,27 +538,47 @@ public:
 
 	bool IsAllied(const int index) const
 	{
-		return this->Index != index && this->allies.contains(index);
+		return this->Index != index && (this->ally_mask & wyrmgus::get_player_mask(index)) != 0;
 	}
 
 	bool IsAllied(const CPlayer &player) const;
 	bool IsAllied(const CUnit &unit) const;
 	bool IsVisionSharing() const;
 
-	const wyrmgus::player_index_set &get_shared_vision() const
+	wyrmgus::player_mask get_shared_vision_mask() const
 	{
-		return this->shared_vision;
+		return this->shared_vision_mask;
 	}
 
 	bool has_shared_vision_with(const int player_index) const
 	{
-		return this->shared_vision.contains(player_index);
+		return (this->shared_vision_mask & wyrmgus::get_player_mask(player_index)) != 0;
 	}
 
 	bool has_shared_vision_with(const CPlayer &player) const;
 	bool has_shared_vision_with(const CUnit &unit) const;
 	bool has_mutual_shared_vision_with(const CPlayer &player) const;
 	bool has_mutual_shared_vision_with(const CUnit &unit) const;
+
+	/// Get the players with which this player is hostile, either way or through its overlords
+	wyrmgus::player_mask get_hostile_mask() const
+	{
+		return this->hostile_mask;
+	}
+
+	/// Get the players with which this player has the allied stance both ways
+	wyrmgus::player_mask get_mutual_ally_mask() const
+	{
+		return this->mutual_ally_mask;
+	}
+
+	/// Get the players with which this player shares vision both ways
+	wyrmgus::player_mask get_mutual_shared_vision_mask() const
+	{
+		return this->mutual_shared_vision_mask;
+	}
+
+	static void update_diplomacy_masks();
 	bool IsTeamed(const CPlayer &player) const;
 	bool IsTeamed(const CUnit &unit) const;
 
@@ -679,9 +694,12 @@ public:
 
 private:
 	std::vector<CUnit *> Units; /// units of this player
-	wyrmgus::player_index_set enemies; //enemies for this player
-	wyrmgus::player_index_set allies; //allies for this player
-	wyrmgus::player_index_set shared_vision; //set of player indexes that this player has shared vision with
+	wyrmgus::player_mask enemy_mask = 0; //enemies for this player
+	wyrmgus::player_mask ally_mask = 0; //allies for this player
+	wyrmgus::player_mask shared_vision_mask = 0; //player indexes that this player has shared vision with
+	wyrmgus::player_mask hostile_mask = 0; //players hostile to this one either way, or to its overlords; derived from the stances of all players
+	wyrmgus::player_mask mutual_ally_mask = 0; //derived from the stances of all players
+	wyrmgus::player_mask mutual_shared_vision_mask = 0; //derived from the stances of all players
 
 	friend void CleanPlayers();
 	friend void SetPlayersPalette();
@@ -122,4 +122,7 @@ public:
 	int MapHeight;            /// Height in map tiles
 
 	CUnit *Unit;              /// Bound to this unit
+
+	//the numbers of the units drawn in the last frame, in drawing order; used as the starting order when sorting the units of the next frame, since it changes little between frames
+	mutable std::vector<int> unit_draw_order;
 };
@@ -0,0 +1,208 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace wyrmgus {
+
+/**
+**	@brief	Field of view of a sight source, checked with precomputed lines of sight
+**
+**	A tile is visible if the line from at least one tile of the source's footprint to it has no obstacles, other than ones within the maximum obstacle difference of the tile itself.
+**	The lines are the same Bresenham lines which CheckObstaclesBetweenTiles walks, so the visible tiles are the same as with it, but the steps of each line are precomputed once,
+**	and the obstacle data is kept for a window of the map around the source, so that checking a tile needs neither line arithmetic nor map field accesses.
+*/
+class field_of_view final
+{
+public:
+	field_of_view(const int min_x, const int min_y, const int width, const int height)
+		: min_x(min_x), min_y(min_y), width(width), height(height)
+	{
+		this->obstacles.assign(static_cast<size_t>(this->width) * this->height, 0);
+
+		//a line from a tile of the window to another one is at most as long as the window
+		field_of_view::lines.reserve(std::max(this->width, this->height) - 1);
+	}
+
+	void set_obstacle(const int map_x, const int map_y)
+	{
+		this->obstacles[this->get_index(map_x, map_y)] = 1;
+	}
+
+	/**
+	**	@brief	Set the footprint of the sight source, from whose tiles lines of sight are checked
+	**
+	**	@param	max_obstacle_difference	The distance up to which obstacles next to a tile don't block the sight to it, so that the tiles of obstacles themselves can be seen
+	*/
+	void set_footprint(const int map_x, const int map_y, const int w, const int h, const int max_obstacle_difference)
+	{
+		this->footprint_x = map_x;
+		this->footprint_y = map_y;
+		this->footprint_width = w;
+		this->footprint_height = h;
+		this->max_obstacle_difference = max_obstacle_difference;
+	}
+
+	bool is_visible(const int map_x, const int map_y) const
+	{
+		for (int x = 0; x < this->footprint_width; ++x) {
+			for (int y = 0; y < this->footprint_height; ++y) {
+				if (this->is_line_clear(this->footprint_x + x, this->footprint_y + y, map_x, map_y)) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+private:
+	/**
+	**	@brief	The steps of the Bresenham line from an origin to each offset with non-negative coordinates
+	**
+	**	Lines to offsets with negative coordinates are the mirror images of these, as the line walk depends only on the absolute differences.
+	**	The table is shared by all fields of view and grown on demand; sight is only calculated in the game logic thread.
+	*/
+	class line_table final
+	{
+	public:
+		struct step final
+		{
+			short x;
+			short y;
+		};
+
+		void reserve(const int max_distance)
+		{
+			if (max_distance <= this->max_distance) {
+				return;
+			}
+
+			this->max_distance = max_distance;
+			this->line_starts.assign(static_cast<size_t>(max_distance + 1) * (max_distance + 1) + 1, 0);
+			this->steps.clear();
+
+			for (int delta_y = 0; delta_y <= max_distance; ++delta_y) {
+				for (int delta_x = 0; delta_x <= max_distance; ++delta_x) {
+					this->line_starts[this->get_line_index(delta_x, delta_y)] = this->steps.size();
+
+					//the same walk as in CheckObstaclesBetweenTiles
+					int error = delta_x - delta_y;
+					int x = 0;
+					int y = 0;
+					while (x != delta_x || y != delta_y) {
+						const int error2 = error * 2;
+
+						if (error2 > -delta_y) {
+							error -= delta_y;
+							++x;
+						}
+						if (error2 < delta_x) {
+							error += delta_x;
+							++y;
+						}
+
+						this->steps.push_back(step{static_cast<short>(x), static_cast<short>(y)});
+					}
+				}
+			}
+
+			this->line_starts.back() = this->steps.size();
+		}
+
+		const step *get_line_begin(const int delta_x, const int delta_y) const
+		{
+			return this->steps.data() + this->line_starts[this->get_line_index(delta_x, delta_y)];
+		}
+
+		const step *get_line_end(const int delta_x, const int delta_y) const
+		{
+			return this->steps.data() + this->line_starts[this->get_line_index(delta_x, delta_y) + 1];
+		}
+
+	private:
+		size_t get_line_index(const int delta_x, const int delta_y) const
+		{
+			return static_cast<size_t>(delta_y) * (this->max_distance + 1) + delta_x;
+		}
+
+		int max_distance = -1;
+		std::vector<size_t> line_starts;
+		std::vector<step> steps;
+	};
+
+	int get_index(const int map_x, const int map_y) const
+	{
+		return (map_y - this->min_y) * this->width + (map_x - this->min_x);
+	}
+
+	/// Get whether the line from an origin to a target has no obstacles which block the sight to the target
+	bool is_line_clear(const int origin_x, const int origin_y, const int target_x, const int target_y) const
+	{
+		const int delta_x = std::abs(target_x - origin_x);
+		const int delta_y = std::abs(target_y - origin_y);
+		const int sign_x = origin_x < target_x ? 1 : -1;
+		const int sign_y = origin_y < target_y ? 1 : -1;
+		const int origin_index = this->get_index(origin_x, origin_y);
+
+		const line_table::step *line_end = field_of_view::lines.get_line_end(delta_x, delta_y);
+		for (const line_table::step *step = field_of_view::lines.get_line_begin(delta_x, delta_y); step != line_end; ++step) {
+			//the steps get closer to the target, so once an obstacle would be near enough to it not to count, so would all of the remaining ones
+			if (std::max(delta_x - step->x, delta_y - step->y) <= this->max_obstacle_difference) {
+				break;
+			}
+
+			//both ends are in the window, so the line is as well
+			if (this->obstacles[origin_index + sign_x * step->x + sign_y * step->y * this->width] != 0) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static line_table lines;
+
+	const int min_x;
+	const int min_y;
+	const int width;
+	const int height;
+	std::vector<unsigned char> obstacles;
+	int footprint_x = 0;
+	int footprint_y = 0;
+	int footprint_width = 0;
+	int footprint_height = 0;
+	int max_obstacle_difference = 0;
+};
+
+inline field_of_view::line_table field_of_view::lines;
+
+}
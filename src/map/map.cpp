@@ -41,9 +41,11 @@
 #include "map/minimap.h"
 #include "map/site.h"
 #include "map/terrain_feature.h"
+#include "map/terrain_render_cache.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
 #include "map/tileset.h"
+#include "pathfinder.h"
 #include "plane.h"
 #include "player.h"
 //Wyrmgus start
@@ -97,8 +99,9 @@ char CurrentMapPath[1024]; //path of the current map
 **  Marks seen tile -- used mainly for the Fog Of War
 **
 **  @param mf  MapField-position.
+**  @param z   Map layer of the tile.
 */
-void CMap::MarkSeenTile(wyrmgus::tile &mf)
+void CMap::MarkSeenTile(wyrmgus::tile &mf, const int z)
 {
 	//Wyrmgus start
 //	const unsigned int tile = mf.getGraphicTile();
@@ -114,6 +117,9 @@ void CMap::MarkSeenTile(wyrmgus::tile &mf)
 	}
 	mf.UpdateSeenTile();
 
+	CMapLayer *map_layer = this->MapLayers[z].get();
+	map_layer->get_terrain_render_cache().mark_tile_dirty(map_layer->GetPosFromIndex(map_layer->get_tile_index(&mf)));
+
 #ifdef MINIMAP_UPDATE
 	//rb - GRRRRRRRRRRRR
 	//Wyrmgus start
@@ -201,18 +207,26 @@ void CMap::Reveal(bool only_person_players)
 		MarkSeenTile(mf);
 	}
 	*/
+	//only reveal the map for players which are in the game, as revealing it for a player allocates the player's visibility data for each map layer
+	std::vector<int> revealed_player_indexes;
+	for (int p = 0; p < PlayerMax; ++p) {
+		const CPlayer *player = CPlayer::Players[p];
+		if (player->Type != PlayerNobody && (player->Type == PlayerPerson || !only_person_players)) {
+			revealed_player_indexes.push_back(p);
+		}
+	}
+
 	for (size_t z = 0; z < this->MapLayers.size(); ++z) {
 		for (int i = 0; i != this->Info.MapWidths[z] * this->Info.MapHeights[z]; ++i) {
 			wyrmgus::tile &mf = *this->Field(i, z);
 			const std::unique_ptr<wyrmgus::tile_player_info> &player_info = mf.player_info;
-			for (int p = 0; p < PlayerMax; ++p) {
-				if (CPlayer::Players[p]->Type == PlayerPerson || !only_person_players) {
-					player_info->Visible[p] = std::max<unsigned short>(1, player_info->Visible[p]);
-				}
+			for (const int p : revealed_player_indexes) {
+				player_info->set_visible(p, std::max<unsigned short>(1, player_info->get_visible(p)));
 			}
-			MarkSeenTile(mf);
+			MarkSeenTile(mf, z);
 		}
 	}
+	UI.get_minimap()->invalidate_fog();
 	//Wyrmgus end
 	//  Global seen recount. Simple and effective.
 	for (CUnitManager::Iterator it = UnitManager.begin(); it != UnitManager.end(); ++it) {
@@ -1183,7 +1197,7 @@ void PreprocessMap()
 				UI.get_minimap()->UpdateXY(tile_pos, z);
 				UI.get_minimap()->update_territory_xy(tile_pos, z);
 				if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-					CMap::Map.MarkSeenTile(mf);
+					CMap::Map.MarkSeenTile(mf, z);
 				}
 			}
 		}
@@ -1599,6 +1613,15 @@ void CMap::Save(CFile &file) const
 	file.printf("  },\n");
 	//Wyrmgus end
 
+	if (!Preference.SaveMapFieldsAsText) {
+		file.printf("  \"map-fields-data\", {\n");
+		for (size_t z = 0; z < this->MapLayers.size(); ++z) {
+			this->MapLayers[z]->save_fields_binary(file);
+		}
+		file.printf("}})\n");
+		return;
+	}
+
 	file.printf("  \"map-fields\", {\n");
 	//Wyrmgus start
 	/*
@@ -1784,6 +1807,7 @@ void CMap::SetTileTerrain(const Vec2i &pos, const wyrmgus::terrain_type *terrain
 	}
 	
 	mf.SetTerrain(terrain);
+	PathfinderTileChanged(pos, z);
 	
 	if (terrain->is_overlay()) {
 		//remove decorations if the overlay terrain has changed
@@ -1810,7 +1834,7 @@ void CMap::SetTileTerrain(const Vec2i &pos, const wyrmgus::terrain_type *terrain
 	this->calculate_tile_terrain_feature(pos, z);
 	
 	if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-		MarkSeenTile(mf);
+		MarkSeenTile(mf, z);
 	}
 	UI.get_minimap()->UpdateXY(pos, z);
 	
@@ -1829,7 +1853,7 @@ void CMap::SetTileTerrain(const Vec2i &pos, const wyrmgus::terrain_type *terrain
 					this->CalculateTileTransitions(adjacent_pos, true, z);
 					
 					if (adjacent_mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-						MarkSeenTile(adjacent_mf);
+						MarkSeenTile(adjacent_mf, z);
 					}
 					UI.get_minimap()->UpdateXY(adjacent_pos, z);
 				}
@@ -1847,12 +1871,13 @@ void CMap::RemoveTileOverlayTerrain(const Vec2i &pos, int z)
 	}
 	
 	mf.RemoveOverlayTerrain();
+	PathfinderTileChanged(pos, z);
 	
 	this->CalculateTileTransitions(pos, true, z);
 	this->calculate_tile_terrain_feature(pos, z);
 	
 	if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-		MarkSeenTile(mf);
+		MarkSeenTile(mf, z);
 	}
 	UI.get_minimap()->UpdateXY(pos, z);
 	
@@ -1866,7 +1891,7 @@ void CMap::RemoveTileOverlayTerrain(const Vec2i &pos, int z)
 					this->CalculateTileTransitions(adjacent_pos, true, z);
 					
 					if (adjacent_mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-						MarkSeenTile(adjacent_mf);
+						MarkSeenTile(adjacent_mf, z);
 					}
 					UI.get_minimap()->UpdateXY(adjacent_pos, z);
 				}
@@ -1914,6 +1939,7 @@ void CMap::SetOverlayTerrainDestroyed(const Vec2i &pos, bool destroyed, int z)
 			mf.set_value(mf.OverlayTerrain->get_resource()->get_default_amount());
 		}
 	}
+	PathfinderTileChanged(pos, z);
 	
 	if (destroyed) {
 		if (mf.OverlayTerrain->get_destroyed_tiles().size() > 0) {
@@ -1926,7 +1952,7 @@ void CMap::SetOverlayTerrainDestroyed(const Vec2i &pos, bool destroyed, int z)
 	this->CalculateTileTransitions(pos, true, z);
 	
 	if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-		MarkSeenTile(mf);
+		MarkSeenTile(mf, z);
 	}
 	UI.get_minimap()->UpdateXY(pos, z);
 	
@@ -1944,7 +1970,7 @@ void CMap::SetOverlayTerrainDestroyed(const Vec2i &pos, bool destroyed, int z)
 					this->CalculateTileTransitions(adjacent_pos, true, z);
 					
 					if (adjacent_mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-						MarkSeenTile(adjacent_mf);
+						MarkSeenTile(adjacent_mf, z);
 					}
 					UI.get_minimap()->UpdateXY(adjacent_pos, z);
 				}
@@ -1974,7 +2000,7 @@ void CMap::SetOverlayTerrainDamaged(const Vec2i &pos, bool damaged, int z)
 	this->CalculateTileTransitions(pos, true, z);
 	
 	if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-		MarkSeenTile(mf);
+		MarkSeenTile(mf, z);
 	}
 	UI.get_minimap()->UpdateXY(pos, z);
 }
@@ -2122,6 +2148,8 @@ void CMap::calculate_tile_solid_tile(const QPoint &pos, const bool overlay, cons
 void CMap::CalculateTileTransitions(const Vec2i &pos, bool overlay, int z)
 {
 	wyrmgus::tile &mf = *this->Field(pos, z);
+	this->MapLayers[z]->get_terrain_render_cache().mark_tile_dirty(pos);
+
 	const wyrmgus::terrain_type *terrain = nullptr;
 	if (overlay) {
 		terrain = mf.OverlayTerrain;
@@ -2377,6 +2405,7 @@ void CMap::CalculateTileOwnershipTransition(const Vec2i &pos, int z)
 	wyrmgus::tile &mf = *this->Field(pos, z);
 	
 	mf.set_ownership_border_tile(-1);
+	this->MapLayers[z]->get_terrain_render_cache().mark_tile_dirty(pos);
 
 	if (mf.get_owner() == nullptr) {
 		return;
@@ -232,7 +232,7 @@ public:
 	//Wyrmgus end
 
 	/// Mark a tile as seen by the player.
-	void MarkSeenTile(wyrmgus::tile &mf);
+	void MarkSeenTile(wyrmgus::tile &mf, const int z);
 
 	/// Regenerate the forest.
 	void RegenerateForest();
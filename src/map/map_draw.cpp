@@ -34,6 +34,7 @@
 #include "database/defines.h"
 #include "map/map.h"
 #include "map/map_layer.h"
+#include "map/terrain_render_cache.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
 #include "map/tileset.h"
@@ -47,7 +48,6 @@
 #include "unit/unit.h"
 #include "unit/unit_type.h"
 #include "util/size_util.h"
-#include "util/vector_util.h"
 #include "video/font.h"
 #include "video/font_color.h"
 #include "video/video.h"
@@ -262,128 +262,92 @@ void CViewport::Center(const PixelPos &mapPixelPos)
 */
 void CViewport::DrawMapBackgroundInViewport() const
 {
-	int ex = this->BottomRightPos.x;
-	int ey = this->BottomRightPos.y;
-	int sy = this->MapPos.y;
-	int dy = this->TopLeftPos.y - this->Offset.y;
-	const int map_max = UI.CurrentMapLayer->get_width() * UI.CurrentMapLayer->get_height();
-	const wyrmgus::season *season = CMap::Map.MapLayers[UI.CurrentMapLayer->ID]->GetSeason();
-
-	while (sy  < 0) {
-		sy++;
-		dy += wyrmgus::defines::get()->get_scaled_tile_height();
-	}
-	sy *=  UI.CurrentMapLayer->get_width();
-
-	while (dy <= ey && sy  < map_max) {
-		int sx = this->MapPos.x + sy;
-		int dx = this->TopLeftPos.x - this->Offset.x;
-		while (dx <= ex && (sx - sy < UI.CurrentMapLayer->get_width())) {
-			if (sx - sy < 0) {
-				++sx;
-				dx += wyrmgus::defines::get()->get_scaled_tile_width();
-				continue;
-			}
-			const wyrmgus::tile &mf = *UI.CurrentMapLayer->Field(sx);
-
-			const wyrmgus::terrain_type *terrain = nullptr;
-			const wyrmgus::terrain_type *overlay_terrain = nullptr;
-			int solid_tile = 0;
-			int overlay_solid_tile = 0;
-
-			if (ReplayRevealMap) {
-				terrain = mf.Terrain;
-				overlay_terrain = mf.OverlayTerrain;
-				solid_tile = mf.SolidTile;
-				overlay_solid_tile = mf.OverlaySolidTile;
-			} else {
-				terrain = mf.player_info->SeenTerrain;
-				overlay_terrain = mf.player_info->SeenOverlayTerrain;
-				solid_tile = mf.player_info->SeenSolidTile;
-				overlay_solid_tile = mf.player_info->SeenOverlaySolidTile;
-			}
+	const int tile_width = wyrmgus::defines::get()->get_scaled_tile_width();
+	const int tile_height = wyrmgus::defines::get()->get_scaled_tile_height();
 
-			const std::vector<std::pair<const wyrmgus::terrain_type *, short>> &transition_tiles = ReplayRevealMap ? mf.TransitionTiles : mf.player_info->SeenTransitionTiles;
-			const std::vector<std::pair<const wyrmgus::terrain_type *, short>> &overlay_transition_tiles = ReplayRevealMap ? mf.OverlayTransitionTiles : mf.player_info->SeenOverlayTransitionTiles;
+	//the screen position of the top left corner of the tile at the map position of the viewport
+	const int start_dx = this->TopLeftPos.x - this->Offset.x;
+	const int start_dy = this->TopLeftPos.y - this->Offset.y;
 
-			bool is_unpassable = overlay_terrain && (overlay_terrain->Flags & MapFieldUnpassable) && !wyrmgus::vector::contains(overlay_terrain->get_destroyed_tiles(), overlay_solid_tile);
-			const bool is_space = terrain && terrain->Flags & MapFieldSpace;
-			const wyrmgus::time_of_day *time_of_day = nullptr;
-			if (!is_space) {
-				const bool is_underground = terrain && terrain->Flags & MapFieldUnderground;
-				time_of_day = is_underground ? wyrmgus::defines::get()->get_underground_time_of_day() : UI.CurrentMapLayer->GetTimeOfDay();
-			}
-			const wyrmgus::player_color *player_color = (mf.get_owner() != nullptr) ? mf.get_owner()->get_player_color() : CPlayer::Players[PlayerNumNeutral]->get_player_color();
+	//the tiles visible in the viewport
+	const int min_x = std::max<int>(this->MapPos.x, 0);
+	const int min_y = std::max<int>(this->MapPos.y, 0);
+	const int max_x = std::min(this->MapPos.x + (this->BottomRightPos.x - start_dx) / tile_width, UI.CurrentMapLayer->get_width() - 1);
+	const int max_y = std::min(this->MapPos.y + (this->BottomRightPos.y - start_dy) / tile_height, UI.CurrentMapLayer->get_height() - 1);
 
-			if (terrain != nullptr) {
-				const std::shared_ptr<CPlayerColorGraphic> &terrain_graphics = terrain->get_graphics(season);
-				if (terrain_graphics != nullptr) {
-					terrain_graphics->DrawFrameClip(solid_tile + (terrain == mf.Terrain ? mf.AnimationFrame : 0), dx, dy, time_of_day);
-				}
-			}
+	if (min_x > max_x || min_y > max_y) {
+		return;
+	}
 
-			for (size_t i = 0; i != transition_tiles.size(); ++i) {
-				const wyrmgus::terrain_type *transition_terrain = transition_tiles[i].first;
-				const std::shared_ptr<CPlayerColorGraphic> &transition_terrain_graphics = transition_terrain->get_graphics(season);
+	const wyrmgus::player_color *neutral_player_color = CPlayer::Players[PlayerNumNeutral]->get_player_color();
+	const wyrmgus::time_of_day *map_layer_time_of_day = UI.CurrentMapLayer->GetTimeOfDay();
+	const wyrmgus::time_of_day *underground_time_of_day = wyrmgus::defines::get()->get_underground_time_of_day();
 
-				if (transition_terrain_graphics != nullptr) {
-					const bool is_transition_space = transition_terrain && transition_terrain->Flags & MapFieldSpace;
-					const wyrmgus::time_of_day *transition_time_of_day = nullptr;
-					if (!is_transition_space) {
-						const bool is_transition_underground = transition_terrain->Flags & MapFieldUnderground;
-						transition_time_of_day = is_transition_underground ? wyrmgus::defines::get()->get_underground_time_of_day() : UI.CurrentMapLayer->GetTimeOfDay();
-					}
-					transition_terrain_graphics->DrawFrameClip(transition_tiles[i].second, dx, dy, transition_time_of_day);
-				}
-			}
+	wyrmgus::terrain_render_cache &terrain_render_cache = UI.CurrentMapLayer->get_terrain_render_cache();
+	terrain_render_cache.check_render_state();
 
-			if (mf.get_owner() != nullptr && mf.get_ownership_border_tile() != -1 && wyrmgus::defines::get()->get_border_terrain_type() && is_unpassable) { //if the tile is not passable, draw the border under its overlay, but otherwise, draw the border over it
-				const std::shared_ptr<CPlayerColorGraphic> &border_graphics = wyrmgus::defines::get()->get_border_terrain_type()->get_graphics(season);
-				if (border_graphics != nullptr) {
-					border_graphics->DrawPlayerColorFrameClip(player_color, mf.get_ownership_border_tile(), dx, dy, nullptr);
-				}
-			}
+	static constexpr int chunk_size = wyrmgus::terrain_render_cache::chunk_size;
 
-			if (overlay_terrain && (overlay_transition_tiles.size() == 0 || overlay_terrain->has_transition_mask())) {
-				const bool is_overlay_space = overlay_terrain->Flags & MapFieldSpace;
-				const std::shared_ptr<CPlayerColorGraphic> &overlay_terrain_graphics = overlay_terrain->get_graphics(season);
-				if (overlay_terrain_graphics != nullptr) {
-					overlay_terrain_graphics->DrawPlayerColorFrameClip(player_color, overlay_solid_tile + (overlay_terrain == mf.OverlayTerrain ? mf.OverlayAnimationFrame : 0), dx, dy, is_overlay_space ? nullptr : time_of_day);
-				}
-			}
+	for (int chunk_y = min_y / chunk_size; chunk_y <= max_y / chunk_size; ++chunk_y) {
+		for (int chunk_x = min_x / chunk_size; chunk_x <= max_x / chunk_size; ++chunk_x) {
+			const int chunk_start_x = chunk_x * chunk_size;
+			const int chunk_start_y = chunk_y * chunk_size;
+
+			for (const wyrmgus::terrain_render_cache::draw_record &record : terrain_render_cache.get_chunk_records(QPoint(chunk_x, chunk_y))) {
+				const int x = chunk_start_x + record.x;
+				const int y = chunk_start_y + record.y;
 
-			for (size_t i = 0; i != overlay_transition_tiles.size(); ++i) {
-				const wyrmgus::terrain_type *overlay_transition_terrain = overlay_transition_tiles[i].first;
-				if (overlay_transition_terrain->has_transition_mask()) {
+				if (x < min_x || x > max_x || y < min_y || y > max_y) {
 					continue;
 				}
 
-				const bool is_overlay_transition_space = overlay_transition_terrain->Flags & MapFieldSpace;
-				if (overlay_transition_terrain->get_transition_graphics(season)) {
-					overlay_transition_terrain->get_transition_graphics(season)->DrawPlayerColorFrameClip(player_color, overlay_transition_tiles[i].second, dx, dy, is_overlay_transition_space ? nullptr : time_of_day);
+				const int dx = start_dx + (x - this->MapPos.x) * tile_width;
+				const int dy = start_dy + (y - this->MapPos.y) * tile_height;
+
+				int frame = record.frame;
+				switch (record.animation) {
+					case wyrmgus::terrain_render_cache::animation_type::terrain:
+						frame += record.tile->AnimationFrame;
+						break;
+					case wyrmgus::terrain_render_cache::animation_type::overlay:
+						frame += record.tile->OverlayAnimationFrame;
+						break;
+					default:
+						break;
 				}
-			}
 
-			//if the tile is not passable, draw the border under its overlay, but otherwise, draw the border over it
-			if (mf.get_owner() != nullptr && mf.get_ownership_border_tile() != -1 && wyrmgus::defines::get()->get_border_terrain_type() && !is_unpassable) {
-				const std::shared_ptr<CPlayerColorGraphic> &border_graphics = wyrmgus::defines::get()->get_border_terrain_type()->get_graphics(season);
-				if (border_graphics != nullptr) {
-					border_graphics->DrawPlayerColorFrameClip(player_color, mf.get_ownership_border_tile(), dx, dy, nullptr);
+				const wyrmgus::time_of_day *time_of_day = nullptr;
+				switch (record.time_of_day) {
+					case wyrmgus::terrain_render_cache::time_of_day_type::underground:
+						time_of_day = underground_time_of_day;
+						break;
+					case wyrmgus::terrain_render_cache::time_of_day_type::map_layer:
+						time_of_day = map_layer_time_of_day;
+						break;
+					default:
+						break;
 				}
-			}
 
-			for (size_t i = 0; i != overlay_transition_tiles.size(); ++i) {
-				const wyrmgus::terrain_type *overlay_transition_terrain = overlay_transition_tiles[i].first;
-				if (overlay_transition_terrain->get_elevation_graphics()) {
-					overlay_transition_terrain->get_elevation_graphics()->DrawFrameClip(overlay_transition_tiles[i].second, dx, dy, time_of_day);
+				switch (record.type) {
+					case wyrmgus::terrain_render_cache::draw_type::frame:
+						record.graphics->DrawFrameClip(frame, dx, dy, time_of_day);
+						break;
+					case wyrmgus::terrain_render_cache::draw_type::player_color_frame: {
+						const CPlayer *owner = record.tile->get_owner();
+						const wyrmgus::player_color *player_color = (owner != nullptr) ? owner->get_player_color() : neutral_player_color;
+						static_cast<CPlayerColorGraphic *>(record.graphics)->DrawPlayerColorFrameClip(player_color, frame, dx, dy, time_of_day);
+						break;
+					}
+					case wyrmgus::terrain_render_cache::draw_type::border: {
+						const CPlayer *owner = record.tile->get_owner();
+						if (owner != nullptr) {
+							static_cast<CPlayerColorGraphic *>(record.graphics)->DrawPlayerColorFrameClip(owner->get_player_color(), frame, dx, dy, time_of_day);
+						}
+						break;
+					}
 				}
 			}
-
-			++sx;
-			dx += wyrmgus::defines::get()->get_scaled_tile_width();
 		}
-		sy += UI.CurrentMapLayer->get_width();
-		dy += wyrmgus::defines::get()->get_scaled_tile_height();
 	}
 }
 
@@ -34,6 +34,7 @@
 
 #include "actions.h"
 #include "database/defines.h"
+#include "map/field_of_view.h"
 #include "map/map_layer.h"
 #include "map/tile.h"
 #include "map/tileset.h"
@@ -252,23 +253,24 @@ void MapMarkTileSight(const CPlayer &player, const unsigned int index, int z)
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned short *v = &(mf.player_info->Visible[player.Index]);
-	if (*v == 0 || *v == 1) { // Unexplored or unseen
+	const unsigned short v = mf.player_info->get_visible(player.Index);
+	if (v == 0 || v == 1) { // Unexplored or unseen
 		// When there is no fog only unexplored tiles are marked.
-		if (!CMap::Map.NoFogOfWar || *v == 0) {
+		if (!CMap::Map.NoFogOfWar || v == 0) {
 			//Wyrmgus start
 //			UnitsOnTileMarkSeen(player, mf, 0);
 			UnitsOnTileMarkSeen(player, mf, 0, 0);
 			//Wyrmgus end
 		}
-		*v = 2;
+		mf.player_info->set_visible(player.Index, 2);
+		CMap::Map.MapLayers[z]->on_tile_visibility_changed(index);
 		if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-			CMap::Map.MarkSeenTile(mf);
+			CMap::Map.MarkSeenTile(mf, z);
 		}
 		return;
 	}
-	Assert(*v != 65535);
-	++*v;
+	Assert(v != 65535);
+	mf.player_info->set_visible(player.Index, v + 1);
 }
 
 //Wyrmgus start
@@ -295,8 +297,8 @@ void MapUnmarkTileSight(const CPlayer &player, const unsigned int index, int z)
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned short *v = &mf.player_info->Visible[player.Index];
-	switch (*v) {
+	const unsigned short v = mf.player_info->get_visible(player.Index);
+	switch (v) {
 		case 0:  // Unexplored
 		case 1:
 			// This happens when we unmark everything in CommandSharedVision
@@ -311,10 +313,11 @@ void MapUnmarkTileSight(const CPlayer &player, const unsigned int index, int z)
 			}
 			// Check visible Tile, then deduct...
 			if (mf.player_info->IsTeamVisible(*CPlayer::GetThisPlayer())) {
-				CMap::Map.MarkSeenTile(mf);
+				CMap::Map.MarkSeenTile(mf, z);
 			}
+			CMap::Map.MapLayers[z]->on_tile_visibility_changed(index);
 		default:  // seen -> seen
-			--*v;
+			mf.player_info->set_visible(player.Index, v - 1);
 			break;
 	}
 }
@@ -343,15 +346,15 @@ void MapMarkTileDetectCloak(const CPlayer &player, const unsigned int index, int
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned char *v = &mf.player_info->VisCloak[player.Index];
-	if (*v == 0) {
+	const unsigned char v = mf.player_info->get_cloak(player.Index);
+	if (v == 0) {
 		//Wyrmgus start
 //		UnitsOnTileMarkSeen(player, mf, 1);
 		UnitsOnTileMarkSeen(player, mf, 1, 0);
 		//Wyrmgus end
 	}
-	Assert(*v != 255);
-	++*v;
+	Assert(v != 255);
+	mf.player_info->set_cloak(player.Index, v + 1);
 }
 
 //Wyrmgus start
@@ -380,15 +383,15 @@ void MapUnmarkTileDetectCloak(const CPlayer &player, const unsigned int index, i
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned char *v = &mf.player_info->VisCloak[player.Index];
-	Assert(*v != 0);
-	if (*v == 1) {
+	const unsigned char v = mf.player_info->get_cloak(player.Index);
+	Assert(v != 0);
+	if (v == 1) {
 		//Wyrmgus start
 //		UnitsOnTileUnmarkSeen(player, mf, 1);
 		UnitsOnTileUnmarkSeen(player, mf, 1, 0);
 		//Wyrmgus end
 	}
-	--*v;
+	mf.player_info->set_cloak(player.Index, v - 1);
 }
 
 //Wyrmgus start
@@ -412,12 +415,12 @@ void MapUnmarkTileDetectCloak(const CPlayer &player, const Vec2i &pos, int z)
 void MapMarkTileDetectEthereal(const CPlayer &player, const unsigned int index, int z)
 {
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
-	unsigned char *v = &mf.player_info->VisEthereal[player.Index];
-	if (*v == 0) {
+	const unsigned char v = mf.player_info->get_ethereal(player.Index);
+	if (v == 0) {
 		UnitsOnTileMarkSeen(player, mf, 0, 1);
 	}
-	Assert(*v != 255);
-	++*v;
+	Assert(v != 255);
+	mf.player_info->set_ethereal(player.Index, v + 1);
 }
 
 void MapMarkTileDetectEthereal(const CPlayer &player, const Vec2i &pos, int z)
@@ -434,12 +437,12 @@ void MapMarkTileDetectEthereal(const CPlayer &player, const Vec2i &pos, int z)
 void MapUnmarkTileDetectEthereal(const CPlayer &player, const unsigned int index, int z)
 {
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
-	unsigned char *v = &mf.player_info->VisEthereal[player.Index];
-	Assert(*v != 0);
-	if (*v == 1) {
+	const unsigned char v = mf.player_info->get_ethereal(player.Index);
+	Assert(v != 0);
+	if (v == 1) {
 		UnitsOnTileUnmarkSeen(player, mf, 0, 1);
 	}
-	--*v;
+	mf.player_info->set_ethereal(player.Index, v - 1);
 }
 
 void MapUnmarkTileDetectEthereal(const CPlayer &player, const Vec2i &pos, int z)
@@ -451,6 +454,9 @@ void MapUnmarkTileDetectEthereal(const CPlayer &player, const Vec2i &pos, int z)
 /**
 **  Mark the sight of unit. (Explore and make visible.)
 **
+**  The tiles within the sight range are checked against the lines of sight from the unit's footprint with a field of view,
+**  which gives the same tiles as CheckObstaclesBetweenTiles but with precomputed lines over a copy of the obstacles around the unit.
+**
 **  @param player  player to mark the sight for (not unit owner)
 **  @param pos     location to mark
 **  @param w       width to mark, in square
@@ -470,146 +476,51 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 
 	static constexpr unsigned long sight_obstacle_flag = MapFieldAirUnpassable;
 	static constexpr int max_obstacle_difference = 1; //how many tiles are seen after the obstacle; set to 1 here so that the obstacle tiles themselves don't have fog drawn over them
-	
-	// Up hemi-cyle
-	const int miny = std::max(-range, 0 - pos.y);
-	
-	for (int offsety = miny; offsety != 0; ++offsety) {
-		const int offsetx = isqrt(square(range + 1) - square(-offsety) - 1);
-		const int minx = std::max(0, pos.x - offsetx);
-		//Wyrmgus start
-//		const int maxx = std::min(CMap::Map.Info.MapWidth, pos.x + w + offsetx);
-		const int maxx = std::min(CMap::Map.Info.MapWidths[z], pos.x + w + offsetx);
-		//Wyrmgus end
-		Vec2i mpos(minx, pos.y + offsety);
-#ifdef MARKER_ON_INDEX
-		//Wyrmgus start
-//		const unsigned int index = mpos.y * CMap::Map.Info.MapWidth;
-		const unsigned int index = mpos.y * CMap::Map.Info.MapWidths[z];
-		//Wyrmgus end
-#endif
 
-		for (mpos.x = minx; mpos.x < maxx; ++mpos.x) {
-			bool obstacle_check = false;
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
-					if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
-						obstacle_check = true;
-						break;
-					}
-				}
-				if (obstacle_check) {
-					break;
-				}
-			}
-			if (!obstacle_check) {
-				continue;
-			}
+	const int map_width = CMap::Map.Info.MapWidths[z];
+	const int map_height = CMap::Map.Info.MapHeights[z];
 
-#ifdef MARKER_ON_INDEX
-			//Wyrmgus start
-//			marker(player, mpos.x + index);
-			marker(player, mpos.x + index, z);
-			//Wyrmgus end
-#else
-			//Wyrmgus start
-//			marker(player, mpos);
-			marker(player, mpos, z);
-			//Wyrmgus end
-#endif
+	const Vec2i min_pos(std::max(0, pos.x - range), std::max(0, pos.y - range));
+	const Vec2i max_pos(std::min(map_width - 1, pos.x + w - 1 + range), std::min(map_height - 1, pos.y + h - 1 + range));
+
+	wyrmgus::field_of_view field_of_view(min_pos.x, min_pos.y, max_pos.x - min_pos.x + 1, max_pos.y - min_pos.y + 1);
+
+	for (int y = min_pos.y; y <= max_pos.y; ++y) {
+		const unsigned int map_index = CMap::Map.getIndex(min_pos.x, y, z);
+		for (int x = min_pos.x; x <= max_pos.x; ++x) {
+			if (CMap::Map.Field(map_index + x - min_pos.x, z)->Flags & sight_obstacle_flag) {
+				field_of_view.set_obstacle(x, y);
+			}
 		}
 	}
-	for (int offsety = 0; offsety < h; ++offsety) {
-		const int minx = std::max(0, pos.x - range);
-		//Wyrmgus start
-//		const int maxx = std::min(CMap::Map.Info.MapWidth, pos.x + w + range);
-		const int maxx = std::min(CMap::Map.Info.MapWidths[z], pos.x + w + range);
-		//Wyrmgus end
-		Vec2i mpos(minx, pos.y + offsety);
-#ifdef MARKER_ON_INDEX
-		//Wyrmgus start
-//		const unsigned int index = mpos.y * CMap::Map.Info.MapWidth;
-		const unsigned int index = mpos.y * CMap::Map.Info.MapWidths[z];
-		//Wyrmgus end
-#endif
 
-		for (mpos.x = minx; mpos.x < maxx; ++mpos.x) {
-			bool obstacle_check = false;
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
-					if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
-						obstacle_check = true;
-						break;
-					}
-				}
-				if (obstacle_check) {
-					break;
-				}
-			}
-			if (!obstacle_check) {
-				continue;
-			}
+	field_of_view.set_footprint(pos.x, pos.y, w, h, max_obstacle_difference);
 
-#ifdef MARKER_ON_INDEX
-			//Wyrmgus start
-//			marker(player, mpos.x + index);
-			marker(player, mpos.x + index, z);
-			//Wyrmgus end
-#else
-			//Wyrmgus start
-//			marker(player, mpos);
-			marker(player, mpos, z);
-			//Wyrmgus end
-#endif
+	for (int y = min_pos.y; y <= max_pos.y; ++y) {
+		// the sight area is a circle stretched over the footprint, with its hemi-cycles above and below it
+		int offsetx = range;
+		if (y < pos.y) {
+			offsetx = isqrt(square(range + 1) - square(y - pos.y) - 1);
+		} else if (y >= pos.y + h) {
+			offsetx = isqrt(square(range + 1) - square(y - pos.y - h + 1) - 1);
 		}
-	}
-	// bottom hemi-cycle
-	//Wyrmgus start
-//	const int maxy = std::min(range, CMap::Map.Info.MapHeight - pos.y - h);
-	const int maxy = std::min(range, CMap::Map.Info.MapHeights[z] - pos.y - h);
-	//Wyrmgus end
-	for (int offsety = 0; offsety < maxy; ++offsety) {
-		const int offsetx = isqrt(square(range + 1) - square(offsety + 1) - 1);
+
 		const int minx = std::max(0, pos.x - offsetx);
-		//Wyrmgus start
-//		const int maxx = std::min(CMap::Map.Info.MapWidth, pos.x + w + offsetx);
-		const int maxx = std::min(CMap::Map.Info.MapWidths[z], pos.x + w + offsetx);
-		//Wyrmgus end
-		Vec2i mpos(minx, pos.y + h + offsety);
+		const int maxx = std::min(map_width, pos.x + w + offsetx);
+		Vec2i mpos(minx, y);
 #ifdef MARKER_ON_INDEX
-		//Wyrmgus start
-//		const unsigned int index = mpos.y * CMap::Map.Info.MapWidth;
-		const unsigned int index = mpos.y * CMap::Map.Info.MapWidths[z];
-		//Wyrmgus end
+		const unsigned int index = mpos.y * map_width;
 #endif
 
 		for (mpos.x = minx; mpos.x < maxx; ++mpos.x) {
-			bool obstacle_check = false;
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
-					if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
-						obstacle_check = true;
-						break;
-					}
-				}
-				if (obstacle_check) {
-					break;
-				}
-			}
-			if (!obstacle_check) {
+			if (!field_of_view.is_visible(mpos.x, mpos.y)) {
 				continue;
 			}
 
 #ifdef MARKER_ON_INDEX
-			//Wyrmgus start
-//			marker(player, mpos.x + index);
 			marker(player, mpos.x + index, z);
-			//Wyrmgus end
 #else
-			//Wyrmgus start
-//			marker(player, mpos);
 			marker(player, mpos, z);
-			//Wyrmgus end
 #endif
 		}
 	}
@@ -638,7 +549,7 @@ void UpdateFogOfWarChange()
 			for (unsigned int index = 0; index != w; ++index) {
 				wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 				if (mf.player_info->IsExplored(*CPlayer::GetThisPlayer())) {
-					CMap::Map.MarkSeenTile(mf);
+					CMap::Map.MarkSeenTile(mf, z);
 				}
 			}
 		}
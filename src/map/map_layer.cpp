@@ -30,11 +30,14 @@
 #include "map/map_layer.h"
 
 #include "database/defines.h"
+#include "iolib.h"
 #include "map/map.h"
 #include "map/minimap.h"
+#include "map/terrain_render_cache.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
 #include "map/tileset.h"
+#include "script/condition/condition.h"
 #include "sound/music.h"
 #include "sound/sound_server.h"
 #include "time/season.h"
@@ -42,7 +45,9 @@
 #include "time/time_of_day.h"
 #include "time/time_of_day_schedule.h"
 #include "unit/unit.h"
+#include "unit/unit_bucket_grid.h"
 #include "unit/unit_manager.h"
+#include "util/binary_stream.h"
 
 #ifdef USE_OAML
 #include <oaml.h>
@@ -65,6 +70,15 @@ CMapLayer::CMapLayer(const QSize &size) : size(size)
 	} catch (const std::bad_alloc &) {
 		std::throw_with_nested(std::runtime_error("Failed to allocate map layer with a tile area of " + std::to_string(max_tile_index) + ", for " + std::to_string(max_tile_index * sizeof(wyrmgus::tile)) + " bytes in total."));
 	}
+
+	this->visibility = std::make_unique<wyrmgus::tile_visibility>(size.width(), size.height());
+	for (int i = 0; i < max_tile_index; ++i) {
+		this->Fields[i].player_info->set_visibility_data(this->visibility.get(), i);
+	}
+
+	this->unit_buckets = std::make_unique<wyrmgus::unit_bucket_grid>(size);
+	this->terrain_render_cache = std::make_unique<wyrmgus::terrain_render_cache>(this);
+	this->visibility_changed_tile_flags.resize(max_tile_index, false);
 }
 
 CMapLayer::~CMapLayer()
@@ -83,6 +97,120 @@ wyrmgus::tile *CMapLayer::Field(const unsigned int index) const
 	return &this->Fields[index];
 }
 
+/**
+**	@brief	Record that a tile's visibility state changed
+**
+**	The recorded tiles are processed by the minimap, so that it only has to update the fog of war for the tiles which changed.
+**
+**	@param	index	The index of the tile
+*/
+void CMapLayer::on_tile_visibility_changed(const unsigned int index)
+{
+	if (this->visibility_changed_tile_flags[index]) {
+		return;
+	}
+
+	this->visibility_changed_tile_flags[index] = true;
+	this->visibility_changed_tiles.push_back(index);
+}
+
+/**
+**	@brief	Get the tiles whose visibility state changed, and clear the list
+**
+**	@return	The indexes of the tiles which changed since the last call
+*/
+std::vector<unsigned int> CMapLayer::take_visibility_changed_tiles()
+{
+	for (const unsigned int index : this->visibility_changed_tiles) {
+		this->visibility_changed_tile_flags[index] = false;
+	}
+
+	std::vector<unsigned int> changed_tiles;
+	changed_tiles.swap(this->visibility_changed_tiles);
+	return changed_tiles;
+}
+
+/**
+**	@brief	Save the map layer's fields in the binary save format
+**
+**	The fields are serialized into a versioned binary buffer, which is compressed and written as base64 strings split into lines, so that it can be embedded in the Lua save file without the interpreter having to parse a table for each tile.
+**
+**	@param	file	The file to write to
+*/
+void CMapLayer::save_fields_binary(CFile &file) const
+{
+	wyrmgus::binary_writer writer;
+	writer.write_uint32(CMapLayer::fields_binary_magic);
+	writer.write_uint32(CMapLayer::fields_binary_version);
+	writer.write_int32(this->get_width());
+	writer.write_int32(this->get_height());
+
+	const int max_tile_index = this->get_width() * this->get_height();
+	for (int i = 0; i < max_tile_index; ++i) {
+		this->Field(i)->save_binary(writer);
+	}
+
+	const std::string &data = writer.get_data();
+	const QByteArray encoded_data = qCompress(QByteArray::fromRawData(data.data(), static_cast<int>(data.size())), CMapLayer::fields_binary_compression_level).toBase64();
+
+	static constexpr int line_length = 4096;
+
+	file.printf("  {\n");
+	for (int i = 0; i < encoded_data.size(); i += line_length) {
+		file.printf("  \"");
+		file.write(encoded_data.constData() + i, std::min<int>(line_length, encoded_data.size() - i));
+		file.printf("\",\n");
+	}
+	file.printf("  },\n");
+}
+
+/**
+**	@brief	Load the map layer's fields from the binary save format
+**
+**	@param	encoded_data	The concatenated base64 lines written by save_fields_binary
+*/
+void CMapLayer::load_fields_binary(const std::string &encoded_data)
+{
+	const QByteArray data = qUncompress(QByteArray::fromBase64(QByteArray::fromStdString(encoded_data)));
+
+	if (data.isEmpty()) {
+		throw std::runtime_error("Failed to decompress the map field data.");
+	}
+
+	wyrmgus::binary_reader reader(data.constData(), static_cast<size_t>(data.size()));
+
+	if (reader.read_uint32() != CMapLayer::fields_binary_magic) {
+		throw std::runtime_error("The map field data is not in the binary save format.");
+	}
+
+	const uint32_t version = reader.read_uint32();
+	if (version != CMapLayer::fields_binary_version) {
+		throw std::runtime_error("Unsupported map field data version: " + std::to_string(version) + ".");
+	}
+
+	const int width = reader.read_int32();
+	const int height = reader.read_int32();
+	if (width != this->get_width() || height != this->get_height()) {
+		throw std::runtime_error("The map field data size (" + std::to_string(width) + "x" + std::to_string(height) + ") doesn't match the map layer's size (" + std::to_string(this->get_width()) + "x" + std::to_string(this->get_height()) + ").");
+	}
+
+	const int max_tile_index = width * height;
+	for (int i = 0; i < max_tile_index; ++i) {
+		wyrmgus::tile *tile = this->Field(i);
+		tile->load_binary(reader);
+
+		if (tile->IsDestroyedForestTile()) {
+			this->DestroyedForestTiles.push_back(this->GetPosFromIndex(i));
+		}
+	}
+
+	if (!reader.is_at_end()) {
+		throw std::runtime_error("The map field data has trailing bytes.");
+	}
+
+	this->terrain_render_cache->mark_all_dirty();
+}
+
 /**
 **	@brief	Perform the map layer's per-cycle loop
 */
@@ -421,6 +549,7 @@ void CMapLayer::SetSeason(CScheduledSeason *season)
 	wyrmgus::season *new_season = season ? season->Season : nullptr;
 	
 	this->Season = season;
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::season);
 	
 	//update map layer tiles affected by the season change
 	for (int x = 0; x < this->get_width(); x++) {
@@ -30,6 +30,7 @@
 #include "map/map_template_container.h"
 #include "vec2i.h"
 
+class CFile;
 class CScheduledSeason;
 class CScheduledTimeOfDay;
 class CSeasonSchedule;
@@ -39,14 +40,21 @@ class CUnit;
 namespace wyrmgus {
 	class plane;
 	class season;
+	class terrain_render_cache;
 	class tile;
+	class tile_visibility;
 	class time_of_day;
+	class unit_bucket_grid;
 	class world;
 }
 
 class CMapLayer
 {
 public:
+	static constexpr uint32_t fields_binary_magic = 0x4C49544D; //"MTIL" in little-endian byte order
+	static constexpr uint32_t fields_binary_version = 1;
+	static constexpr int fields_binary_compression_level = 1; //the fastest zlib level; the default one makes saving slower than with the text format, for little gain in size
+
 	CMapLayer(const QSize &size);
 
 	CMapLayer(const int width, const int height) : CMapLayer(QSize(width, height))
@@ -63,6 +71,21 @@ public:
 	**	@return	The map field
 	*/
 	wyrmgus::tile *Field(const unsigned int index) const;
+
+	wyrmgus::unit_bucket_grid &get_unit_buckets() const
+	{
+		return *this->unit_buckets;
+	}
+
+	wyrmgus::terrain_render_cache &get_terrain_render_cache() const
+	{
+		return *this->terrain_render_cache;
+	}
+
+	unsigned int get_tile_index(const wyrmgus::tile *tile) const
+	{
+		return static_cast<unsigned int>(tile - this->Fields.get());
+	}
 	
 	/**
 	**	@brief	Get the map field at a given location
@@ -89,6 +112,14 @@ public:
 		return this->Field(pos.x, pos.y);
 	}
 	
+	void on_tile_visibility_changed(const unsigned int index);
+	std::vector<unsigned int> take_visibility_changed_tiles();
+
+	const wyrmgus::tile_visibility *get_visibility() const
+	{
+		return this->visibility.get();
+	}
+
 	Vec2i GetPosFromIndex(unsigned int index) const
 	{
 		Vec2i pos;
@@ -112,6 +143,9 @@ public:
 		return this->get_size().height();
 	}
 	
+	void save_fields_binary(CFile &file) const;
+	void load_fields_binary(const std::string &encoded_data);
+
 	void DoPerCycleLoop();
 	void DoPerHourLoop();
 	void RegenerateForest();
@@ -153,6 +187,9 @@ public:
 	int ID = -1;
 private:
 	std::unique_ptr<wyrmgus::tile[]> Fields; //fields on the map layer
+	std::unique_ptr<wyrmgus::tile_visibility> visibility; //per-player visibility counters for the fields
+	std::unique_ptr<wyrmgus::unit_bucket_grid> unit_buckets; //coarse grid of the units on the map layer, for range queries
+	std::unique_ptr<wyrmgus::terrain_render_cache> terrain_render_cache; //cached terrain draw calls of the map layer, per chunk of tiles
 	QSize size;									/// the size in tiles of the map layer
 public:
 	CScheduledTimeOfDay *TimeOfDay = nullptr;	/// the time of day for the map layer
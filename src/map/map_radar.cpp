@@ -39,46 +39,30 @@
 
 static inline unsigned char IsTileRadarVisible(const CPlayer &pradar, const CPlayer &punit, const wyrmgus::tile_player_info &mfp)
 {
-	if (mfp.RadarJammer[punit.Index]) {
+	if (mfp.get_radar_jammer(punit.Index)) {
 		return 0;
 	}
 
 	const int p = pradar.Index;
 	if (pradar.IsVisionSharing()) {
-		const unsigned char *const radar = mfp.Radar;
-		const unsigned char *const jamming = mfp.RadarJammer;
 		unsigned char radarvision = 0;
 
 		// Check jamming first, if we are jammed, exit
-		for (const int i : punit.get_shared_vision()) {
-			if (i == p) {
-				continue;
-			}
-
-			if (jamming[i] > 0) {
-				if (CPlayer::Players[i]->has_shared_vision_with(punit.Index)) { //if the shared vision is mutual
-					// We are jammed, return nothing
-					return 0;
-				}
+		for (wyrmgus::player_mask mask = punit.get_mutual_shared_vision_mask() & ~wyrmgus::get_player_mask(p); mask != 0; mask &= mask - 1) {
+			if (mfp.get_radar_jammer(std::countr_zero(mask)) > 0) {
+				// We are jammed, return nothing
+				return 0;
 			}
 		}
 
-		for (const int i : pradar.get_shared_vision()) {
-			if (i == p) {
-				continue;
-			}
-
-			if (radar[i] > 0) {
-				if (CPlayer::Players[i]->has_shared_vision_with(p)) { //if the shared vision is mutual
-					radarvision |= radar[i];
-				}
-			}
+		for (wyrmgus::player_mask mask = pradar.get_mutual_shared_vision_mask(); mask != 0; mask &= mask - 1) {
+			radarvision |= mfp.get_radar(std::countr_zero(mask));
 		}
 
 		// Can't exit until the end, as we might be jammed
-		return (radarvision | mfp.Radar[p]);
+		return (radarvision | mfp.get_radar(p));
 	}
-	return mfp.Radar[p];
+	return mfp.get_radar(p);
 }
 
 bool CUnit::IsVisibleOnRadar(const CPlayer &pradar) const
@@ -113,8 +97,10 @@ bool CUnit::IsVisibleOnRadar(const CPlayer &pradar) const
 */
 void MapMarkTileRadar(const CPlayer &player, const unsigned int index, int z)
 {
-	Assert(CMap::Map.Field(index, z)->player_info->Radar[player.Index] != 255);
-	CMap::Map.Field(index, z)->player_info->Radar[player.Index]++;
+	const std::unique_ptr<wyrmgus::tile_player_info> &player_info = CMap::Map.Field(index, z)->player_info;
+	const unsigned char v = player_info->get_radar(player.Index);
+	Assert(v != 255);
+	player_info->set_radar(player.Index, v + 1);
 }
 
 void MapMarkTileRadar(const CPlayer &player, int x, int y, int z)
@@ -136,10 +122,11 @@ void MapUnmarkTileRadar(const CPlayer &player, const unsigned int index, int z)
 	// Reduce radar coverage if it exists.
 	//Wyrmgus start
 //	unsigned char *v = &(CMap::Map.Field(index)->player_info->Radar[player.Index]);
-	unsigned char *v = &(CMap::Map.Field(index, z)->player_info->Radar[player.Index]);
+	const std::unique_ptr<wyrmgus::tile_player_info> &player_info = CMap::Map.Field(index, z)->player_info;
 	//Wyrmgus end
-	if (*v) {
-		--*v;
+	const unsigned char v = player_info->get_radar(player.Index);
+	if (v) {
+		player_info->set_radar(player.Index, v - 1);
 	}
 }
 
@@ -165,8 +152,10 @@ void MapMarkTileRadarJammer(const CPlayer &player, const unsigned int index, int
 	//Wyrmgus start
 //	Assert(CMap::Map.Field(index)->player_info->RadarJammer[player.Index] != 255);
 //	CMap::Map.Field(index)->player_info->RadarJammer[player.Index]++;
-	Assert(CMap::Map.Field(index, z)->player_info->RadarJammer[player.Index] != 255);
-	CMap::Map.Field(index, z)->player_info->RadarJammer[player.Index]++;
+	const std::unique_ptr<wyrmgus::tile_player_info> &player_info = CMap::Map.Field(index, z)->player_info;
+	const unsigned char v = player_info->get_radar_jammer(player.Index);
+	Assert(v != 255);
+	player_info->set_radar_jammer(player.Index, v + 1);
 	//Wyrmgus end
 }
 
@@ -191,10 +180,11 @@ void MapUnmarkTileRadarJammer(const CPlayer &player, const unsigned int index, i
 	// Reduce radar coverage if it exists.
 	//Wyrmgus start
 //	unsigned char *v = &(CMap::Map.Field(index)->player_info->RadarJammer[player.Index]);
-	unsigned char *v = &(CMap::Map.Field(index, z)->player_info->RadarJammer[player.Index]);
+	const std::unique_ptr<wyrmgus::tile_player_info> &player_info = CMap::Map.Field(index, z)->player_info;
 	//Wyrmgus end
-	if (*v) {
-		--*v;
+	const unsigned char v = player_info->get_radar_jammer(player.Index);
+	if (v) {
+		player_info->set_radar_jammer(player.Index, v - 1);
 	}
 }
 
@@ -37,6 +37,7 @@
 #include "map/site.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
+#include "map/tile_visibility.h"
 #include "map/tileset.h"
 #include "plane.h"
 #include "player.h"
@@ -66,6 +67,10 @@ static std::vector<std::unique_ptr<int[]>> Minimap2MapY;                  /// fa
 static std::vector<std::unique_ptr<int[]>> Map2MinimapX;      /// fast conversion table
 static std::vector<std::unique_ptr<int[]>> Map2MinimapY;     /// fast conversion table
 
+//the range of texels (start, end) covered by each tile column and row, for updating the texels of a single tile
+static std::vector<std::vector<std::pair<int, int>>> tile_texel_x_ranges;
+static std::vector<std::vector<std::pair<int, int>>> tile_texel_y_ranges;
+
 // MinimapScale:
 // 32x32 64x64 96x96 128x128 256x256 512x512 ...
 // *4    *2    *4/3  *1      *1/2    *1/4
@@ -91,6 +96,12 @@ void minimap::create_textures(const int z)
 {
 	this->create_texture(this->terrain_textures[z], this->terrain_texture_data[z].get(), z);
 	this->create_texture(this->overlay_textures[z], this->overlay_texture_data[z].get(), z);
+	this->create_texture(this->unit_textures[z], this->unit_texture_data[z].get(), z);
+
+	//the whole texture data has just been uploaded
+	this->terrain_dirty_rects[z] = QRect();
+	this->overlay_dirty_rects[z] = QRect();
+	this->unit_dirty_rects[z] = QRect();
 }
 
 void minimap::create_texture(GLuint &texture, const unsigned char *texture_data, const int z)
@@ -114,8 +125,15 @@ void minimap::Create()
 {
 	this->terrain_textures.resize(CMap::Map.MapLayers.size());
 	this->overlay_textures.resize(CMap::Map.MapLayers.size());
+	this->unit_textures.resize(CMap::Map.MapLayers.size());
 	MinimapTextureWidth.resize(CMap::Map.MapLayers.size());
 	MinimapTextureHeight.resize(CMap::Map.MapLayers.size());
+	this->terrain_dirty_rects.resize(CMap::Map.MapLayers.size());
+	this->overlay_dirty_rects.resize(CMap::Map.MapLayers.size());
+	this->unit_dirty_rects.resize(CMap::Map.MapLayers.size());
+	this->fog_invalidated.resize(CMap::Map.MapLayers.size(), true);
+	this->overlay_invalidated.resize(CMap::Map.MapLayers.size(), true);
+	this->unit_texel_draws.resize(CMap::Map.MapLayers.size());
 
 	for (size_t z = 0; z < CMap::Map.MapLayers.size(); ++z) {
 		// Scale to biggest value.
@@ -160,6 +178,26 @@ void minimap::Create()
 			Map2MinimapY[z][i] = (i * MinimapScaleY[z]) / MINIMAP_FAC;
 		}
 
+		tile_texel_x_ranges.emplace_back(CMap::Map.Info.MapWidths[z], std::pair<int, int>(0, 0));
+		for (int mx = XOffset[z]; mx < texture_width - XOffset[z]; ++mx) {
+			std::pair<int, int> &range = tile_texel_x_ranges[z][Minimap2MapX[z][mx]];
+			if (range.second == 0) {
+				range.first = mx;
+			}
+			range.second = mx + 1;
+		}
+		tile_texel_y_ranges.emplace_back(CMap::Map.Info.MapHeights[z], std::pair<int, int>(0, 0));
+		for (int my = YOffset[z]; my < texture_height - YOffset[z]; ++my) {
+			std::pair<int, int> &range = tile_texel_y_ranges[z][Minimap2MapY[z][my] / CMap::Map.Info.MapWidths[z]];
+			if (range.second == 0) {
+				range.first = my;
+			}
+			range.second = my + 1;
+		}
+
+		this->texel_vision_types.push_back(std::make_unique<unsigned char[]>(texture_width * texture_height));
+		memset(this->texel_vision_types[z].get(), 0, texture_width * texture_height);
+
 		// Palette updated from UpdateMinimapTerrain()
 		for (MinimapTextureWidth[z] = 1; MinimapTextureWidth[z] < texture_width; MinimapTextureWidth[z] <<= 1) {
 		}
@@ -180,6 +218,9 @@ void minimap::Create()
 		this->overlay_texture_data.push_back(std::make_unique<unsigned char[]>(MinimapTextureWidth[z] * MinimapTextureHeight[z] * 4));
 		memset(this->overlay_texture_data[z].get(), 0, MinimapTextureWidth[z] * MinimapTextureHeight[z] * 4);
 
+		this->unit_texture_data.push_back(std::make_unique<unsigned char[]>(MinimapTextureWidth[z] * MinimapTextureHeight[z] * 4));
+		memset(this->unit_texture_data[z].get(), 0, MinimapTextureWidth[z] * MinimapTextureHeight[z] * 4);
+
 		this->create_textures(z);
 
 		this->UpdateTerrain(z);
@@ -203,6 +244,11 @@ void minimap::FreeOpenGL()
 		glDeleteTextures(1, &this->overlay_textures[z]);
 	}
 	this->overlay_textures.clear();
+
+	for (size_t z = 0; z < this->unit_textures.size(); ++z) {
+		glDeleteTextures(1, &this->unit_textures[z]);
+	}
+	this->unit_textures.clear();
 }
 
 /**
@@ -246,6 +292,8 @@ void minimap::UpdateTerrain(int z)
 			*(uint32_t *) &(this->terrain_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]) = c;
 		}
 	}
+
+	this->terrain_dirty_rects[z] = QRect(0, 0, MinimapTextureWidth[z], MinimapTextureHeight[z]);
 }
 
 void minimap::update_territories(const int z)
@@ -317,6 +365,12 @@ void minimap::UpdateXY(const Vec2i &pos, int z)
 			*(uint32_t *) &(this->terrain_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]) = c;
 		}
 	}
+
+	const std::pair<int, int> &x_range = tile_texel_x_ranges[z][pos.x];
+	const std::pair<int, int> &y_range = tile_texel_y_ranges[z][pos.y];
+	if (x_range.first != x_range.second && y_range.first != y_range.second) {
+		this->terrain_dirty_rects[z] |= QRect(QPoint(x_range.first, y_range.first), QPoint(x_range.second - 1, y_range.second - 1));
+	}
 }
 
 void minimap::update_territory_xy(const QPoint &pos, const int z)
@@ -420,14 +474,24 @@ void minimap::update_territory_pixel(const int mx, const int my, const int z)
 
 	const uint32_t realm_with_non_land_c = CVideo::MapRGBA(realm_with_non_land_color);
 	*(uint32_t *) &(this->mode_overlay_texture_data[minimap_mode::realms_with_non_land][z][pixel_index]) = realm_with_non_land_c;
+
+	if (minimap_mode_has_overlay(this->get_mode())) {
+		*(uint32_t *) &(this->overlay_texture_data[z][pixel_index]) = this->get_overlay_texel_color(mx, my, z);
+		this->overlay_dirty_rects[z] |= QRect(mx, my, 1, 1);
+	}
 }
 
 /**
-**  Draw a unit on the minimap.
+**	@brief	Get the texels to draw for a unit in the units layer of the minimap
+**
+**	@param	unit		The unit
+**	@param	red_phase	Whether attacked units blinking red are shown in red
+**	@param	z			The map layer
+**
+**	@return	The texels to draw for the unit, or nothing if it is not drawn on the minimap
 */
-void minimap::DrawUnitOn(CUnit &unit, int red_phase)
+std::optional<minimap::unit_texel_draw> minimap::get_unit_texel_draw(const CUnit &unit, const int red_phase, const int z) const
 {
-	const int z = UI.CurrentMapLayer->ID;
 	const int texture_width = this->get_texture_width(z);
 	const int texture_height = this->get_texture_height(z);
 
@@ -446,7 +510,7 @@ void minimap::DrawUnitOn(CUnit &unit, int red_phase)
 
 	//don't draw decorations or diminutive fauna units on the minimap
 	if (type->BoolFlag[DECORATION_INDEX].value || (type->BoolFlag[DIMINUTIVE_INDEX].value && type->BoolFlag[FAUNA_INDEX].value)) {
-		return;
+		return std::nullopt;
 	}
 
 	uint32_t color;
@@ -465,98 +529,376 @@ void minimap::DrawUnitOn(CUnit &unit, int red_phase)
 		color = CVideo::MapRGB(unit.Player->get_minimap_color());
 	}
 
-	int mx = 1 + this->XOffset[z] + Map2MinimapX[z][unit.tilePos.x];
-	int my = 1 + this->YOffset[z] + Map2MinimapY[z][unit.tilePos.y];
+	const int mx = 1 + this->XOffset[z] + Map2MinimapX[z][unit.tilePos.x];
+	const int my = 1 + this->YOffset[z] + Map2MinimapY[z][unit.tilePos.y];
 	int w = Map2MinimapX[z][type->get_tile_width()];
 
 	if (mx + w >= texture_width) { // clip right side
 		w = texture_width - mx;
 	}
 
-	int h0 = Map2MinimapY[z][type->get_tile_height()];
-	if (my + h0 >= texture_height) { // clip bottom side
-		h0 = texture_height - my;
+	int h = Map2MinimapY[z][type->get_tile_height()];
+	if (my + h >= texture_height) { // clip bottom side
+		h = texture_height - my;
 	}
 
-	while (w-- >= 0) {
-		int h = h0;
-		while (h-- >= 0) {
-			*(uint32_t *) &(this->overlay_texture_data[z][((mx + w) + (my + h) * MinimapTextureWidth[z]) * 4]) = color;
-		}
+	if (w < 0 || h < 0) {
+		return std::nullopt;
+	}
+
+	unit_texel_draw draw;
+	draw.unit_slot = unit.UnitManagerData.GetUnitId();
+	draw.rect = QRect(mx, my, w + 1, h + 1) & QRect(0, 0, MinimapTextureWidth[z], MinimapTextureHeight[z]);
+	draw.color = color;
+
+	if (draw.rect.isEmpty()) {
+		return std::nullopt;
 	}
+
+	return draw;
 }
 
 /**
-**  Update the minimap with the current game information
+**	@brief	Update the units layer of the minimap
+**
+**	Only the texels of units which appeared, disappeared, moved or changed color since the last update are redrawn.
+**
+**	@param	red_phase	Whether attacked units blinking red are shown in red
+**	@param	z			The map layer
 */
-void minimap::Update()
+void minimap::update_units(const int red_phase, const int z)
 {
-	static int red_phase;
+	std::vector<unit_texel_draw> draws;
 
-	int red_phase_changed = red_phase != (int)((FrameCounter / FRAMES_PER_SECOND) & 1);
-	if (red_phase_changed) {
-		red_phase = !red_phase;
+	if (this->are_units_visible()) {
+		for (CUnitManager::Iterator it = UnitManager.begin(); it != UnitManager.end(); ++it) {
+			const CUnit &unit = **it;
+			if (unit.IsVisibleOnMinimap()) {
+				std::optional<unit_texel_draw> draw = this->get_unit_texel_draw(unit, red_phase, z);
+				if (draw.has_value()) {
+					draws.push_back(std::move(draw.value()));
+				}
+			}
+		}
 	}
 
-	const int z = UI.CurrentMapLayer->ID;
+	std::vector<unit_texel_draw> &old_draws = this->unit_texel_draws[z];
 
-	//clear Minimap background if not transparent
-	if (!Transparent) {
-		memset(this->overlay_texture_data[z].get(), 0, MinimapTextureWidth[z] * MinimapTextureHeight[z] * 4);
+	int slot_count = 0;
+	for (const unit_texel_draw &old_draw : old_draws) {
+		slot_count = std::max(slot_count, old_draw.unit_slot + 1);
 	}
 
-	if (minimap_mode_has_overlay(this->get_mode())) {
-		memcpy(this->overlay_texture_data[z].get(), this->mode_overlay_texture_data[this->get_mode()][z].get(), MinimapTextureWidth[z] * MinimapTextureHeight[z] * 4);
+	std::vector<int> old_draw_indexes_by_slot(slot_count, -1);
+	for (size_t i = 0; i < old_draws.size(); ++i) {
+		old_draw_indexes_by_slot[old_draws[i].unit_slot] = static_cast<int>(i);
 	}
 
-	const int texture_width = this->get_texture_width(z);
-	const int texture_height = this->get_texture_height(z);
+	std::vector<bool> old_draws_kept(old_draws.size(), false);
+	std::vector<QRect> changed_rects;
+	int max_old_draw_index = -1;
 
-	const uint32_t unexplored_color = CVideo::MapRGB(0, 0, 0);
-	const uint32_t explored_color = CVideo::MapRGBA(0, 0, 0, 128); //explored but not visible
-	for (int my = 0; my < texture_height; ++my) {
-		for (int mx = 0; mx < texture_width; ++mx) {
-			if (mx < XOffset[z] || mx >= texture_width - XOffset[z] || my < YOffset[z] || my >= texture_height - YOffset[z]) {
-				*(uint32_t *) &(this->overlay_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]) = CVideo::MapRGB(0, 0, 0);
+	for (const unit_texel_draw &draw : draws) {
+		const int old_draw_index = draw.unit_slot < slot_count ? old_draw_indexes_by_slot[draw.unit_slot] : -1;
+
+		if (old_draw_index != -1) {
+			const unit_texel_draw &old_draw = old_draws[old_draw_index];
+			old_draws_kept[old_draw_index] = true;
+
+			//a unit drawn before one it was previously drawn after is treated as changed, since the order decides which of overlapping units is shown
+			const bool reordered = old_draw_index < max_old_draw_index;
+			max_old_draw_index = std::max(max_old_draw_index, old_draw_index);
+
+			if (!reordered && old_draw.rect == draw.rect && old_draw.color == draw.color) {
 				continue;
 			}
-			
-			int visiontype; // 0 unexplored, 1 explored, >1 visible.
-
-			if (ReplayRevealMap) {
-				visiontype = 2;
-			} else {
-				const Vec2i tilePos(Minimap2MapX[z][mx], Minimap2MapY[z][my] / UI.CurrentMapLayer->get_width());
-				visiontype = CMap::Map.Field(tilePos, z)->player_info->TeamVisibilityState(*CPlayer::GetThisPlayer());
+
+			changed_rects.push_back(old_draw.rect);
+		}
+
+		changed_rects.push_back(draw.rect);
+	}
+
+	for (size_t i = 0; i < old_draws.size(); ++i) {
+		if (!old_draws_kept[i]) {
+			changed_rects.push_back(old_draws[i].rect);
+		}
+	}
+
+	old_draws = std::move(draws);
+
+	if (changed_rects.empty()) {
+		return;
+	}
+
+	//redrawing each changed rectangle costs a pass over the units, so if there are many, redraw their bounding rectangle instead
+	static constexpr size_t max_changed_rects = 32;
+
+	if (changed_rects.size() > max_changed_rects) {
+		QRect bounding_rect;
+		for (const QRect &changed_rect : changed_rects) {
+			bounding_rect |= changed_rect;
+		}
+		this->redraw_units_in_rect(bounding_rect, z);
+	} else {
+		for (const QRect &changed_rect : changed_rects) {
+			this->redraw_units_in_rect(changed_rect, z);
+		}
+	}
+}
+
+/**
+**	@brief	Clear a rectangle of the units layer, and draw the units overlapping it within it, in drawing order
+**
+**	@param	rect	The rectangle, in texels
+**	@param	z		The map layer
+*/
+void minimap::redraw_units_in_rect(const QRect &rect, const int z)
+{
+	unsigned char *texture_data = this->unit_texture_data[z].get();
+
+	for (int my = rect.top(); my <= rect.bottom(); ++my) {
+		memset(&texture_data[(rect.left() + my * MinimapTextureWidth[z]) * 4], 0, rect.width() * 4);
+	}
+
+	for (const unit_texel_draw &draw : this->unit_texel_draws[z]) {
+		const QRect draw_rect = draw.rect & rect;
+		if (draw_rect.isEmpty()) {
+			continue;
+		}
+
+		for (int my = draw_rect.top(); my <= draw_rect.bottom(); ++my) {
+			for (int mx = draw_rect.left(); mx <= draw_rect.right(); ++mx) {
+				*(uint32_t *) &(texture_data[(mx + my * MinimapTextureWidth[z]) * 4]) = draw.color;
 			}
+		}
+	}
+
+	this->unit_dirty_rects[z] |= rect;
+}
+
+minimap::fog_state minimap::get_current_fog_state()
+{
+	fog_state state;
+	state.no_fog_of_war = CMap::Map.NoFogOfWar;
+	state.reveal_map = ReplayRevealMap;
+
+	const CPlayer *this_player = CPlayer::GetThisPlayer();
+	if (this_player != nullptr) {
+		state.player_index = this_player->Index;
+		state.shared_vision_mask = this_player->get_mutual_shared_vision_mask();
+	}
+
+	for (const CPlayer *other_player : CPlayer::get_revealed_players()) {
+		state.revealed_mask |= get_player_mask(other_player->Index);
+	}
+
+	return state;
+}
+
+/**
+**	@brief	Mark the fog of war of all map layers for a full recalculation
+**
+**	This must be called when tile visibility is changed other than through marking or unmarking tile sight, e.g. when revealing the map.
+*/
+void minimap::invalidate_fog()
+{
+	for (size_t z = 0; z < this->fog_invalidated.size(); ++z) {
+		this->fog_invalidated[z] = true;
+	}
+}
+
+/**
+**	@brief	Update the texel vision types of a map layer
+**
+**	Only the tiles whose visibility changed since the last update are recalculated, unless the fog of war has been invalidated.
+**
+**	@param	z	The map layer
+*/
+void minimap::update_fog(const int z)
+{
+	const fog_state state = minimap::get_current_fog_state();
+	if (state != this->current_fog_state) {
+		this->current_fog_state = state;
+		this->invalidate_fog();
+	}
 
-			switch (visiontype) {
-				case 0:
-					*(uint32_t *) &(this->overlay_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]) = unexplored_color;
-					break;
-				case 1:
-					if (this->is_fog_of_war_visible()) {
-						uint32_t *c = (uint32_t *) &(this->overlay_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]);
-						if (*c == 0) {
-							*c = explored_color;
-						}
-					}
-					break;
-				default:
-					break;
+	const CMapLayer *map_layer = CMap::Map.MapLayers[z].get();
+	const std::vector<unsigned int> changed_tiles = CMap::Map.MapLayers[z]->take_visibility_changed_tiles();
+
+	if (this->fog_invalidated[z]) {
+		for (int y = 0; y < map_layer->get_height(); ++y) {
+			for (int x = 0; x < map_layer->get_width(); ++x) {
+				this->update_tile_fog(QPoint(x, y), z);
 			}
 		}
+
+		this->fog_invalidated[z] = false;
+		return;
 	}
 
-	if (this->are_units_visible()) {
-		//draw units on the map
-		for (CUnitManager::Iterator it = UnitManager.begin(); it != UnitManager.end(); ++it) {
-			CUnit &unit = **it;
-			if (unit.IsVisibleOnMinimap()) {
-				this->DrawUnitOn(unit, red_phase);
+	for (const unsigned int tile_index : changed_tiles) {
+		this->update_tile_fog(map_layer->GetPosFromIndex(tile_index), z);
+	}
+}
+
+/**
+**	@brief	Update the vision type of the texels corresponding to a tile, recomposing their overlay if it changed
+**
+**	@param	tile_pos	The tile position
+**	@param	z			The map layer
+*/
+void minimap::update_tile_fog(const QPoint &tile_pos, const int z)
+{
+	const std::pair<int, int> &x_range = tile_texel_x_ranges[z][tile_pos.x()];
+	const std::pair<int, int> &y_range = tile_texel_y_ranges[z][tile_pos.y()];
+
+	if (x_range.first == x_range.second || y_range.first == y_range.second) {
+		//the tile is not shown in the minimap
+		return;
+	}
+
+	unsigned char vision_type = 2;
+	if (!ReplayRevealMap) {
+		vision_type = CMap::Map.Field(tile_pos, z)->player_info->TeamVisibilityState(*CPlayer::GetThisPlayer());
+	}
+
+	const int texture_width = this->get_texture_width(z);
+
+	//all the texels of a tile have the same vision type
+	if (this->texel_vision_types[z][x_range.first + y_range.first * texture_width] == vision_type) {
+		return;
+	}
+
+	for (int my = y_range.first; my < y_range.second; ++my) {
+		memset(&this->texel_vision_types[z][x_range.first + my * texture_width], vision_type, x_range.second - x_range.first);
+
+		for (int mx = x_range.first; mx < x_range.second; ++mx) {
+			*(uint32_t *) &(this->overlay_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]) = this->get_overlay_texel_color(mx, my, z);
+		}
+	}
+
+	this->overlay_dirty_rects[z] |= QRect(QPoint(x_range.first, y_range.first), QPoint(x_range.second - 1, y_range.second - 1));
+}
+
+/**
+**	@brief	Get the color of an overlay texel, composing the fog of war over the overlay of the current mode
+**
+**	@param	mx	The texel's x coordinate
+**	@param	my	The texel's y coordinate
+**	@param	z	The map layer
+*/
+uint32_t minimap::get_overlay_texel_color(const int mx, const int my, const int z) const
+{
+	const int texture_width = this->get_texture_width(z);
+	const int texture_height = this->get_texture_height(z);
+
+	if (mx < XOffset[z] || mx >= texture_width - XOffset[z] || my < YOffset[z] || my >= texture_height - YOffset[z]) {
+		return CVideo::MapRGB(0, 0, 0);
+	}
+
+	const int pixel_index = (mx + my * MinimapTextureWidth[z]) * 4;
+
+	uint32_t color = 0;
+	if (minimap_mode_has_overlay(this->get_mode())) {
+		color = *(const uint32_t *) &(this->mode_overlay_texture_data.find(this->get_mode())->second[z][pixel_index]);
+	}
+
+	switch (this->texel_vision_types[z][mx + my * texture_width]) { // 0 unexplored, 1 explored, >1 visible.
+		case 0:
+			return CVideo::MapRGB(0, 0, 0);
+		case 1:
+			if (this->is_fog_of_war_visible() && color == 0) {
+				return CVideo::MapRGBA(0, 0, 0, 128); //explored but not visible
 			}
+			return color;
+		default:
+			return color;
+	}
+}
+
+/**
+**	@brief	Recompose the whole overlay of a map layer
+**
+**	@param	z	The map layer
+*/
+void minimap::update_overlay(const int z)
+{
+	const int texture_width = this->get_texture_width(z);
+	const int texture_height = this->get_texture_height(z);
+
+	for (int my = 0; my < texture_height; ++my) {
+		for (int mx = 0; mx < texture_width; ++mx) {
+			*(uint32_t *) &(this->overlay_texture_data[z][(mx + my * MinimapTextureWidth[z]) * 4]) = this->get_overlay_texel_color(mx, my, z);
 		}
 	}
+
+	this->overlay_dirty_rects[z] = QRect(0, 0, texture_width, texture_height);
+	this->overlay_invalidated[z] = false;
+}
+
+/**
+**	@brief	Mark the overlay of all map layers to be fully recomposed on the next update
+*/
+void minimap::invalidate_overlay()
+{
+	for (size_t z = 0; z < this->overlay_invalidated.size(); ++z) {
+		this->overlay_invalidated[z] = true;
+	}
+}
+
+/**
+**  Update the minimap with the current game information
+**
+**  Only the overlay texels of tiles whose visibility changed and the texels of units which changed are redrawn, unless the overlay has been invalidated.
+*/
+void minimap::Update()
+{
+	static int red_phase;
+
+	int red_phase_changed = red_phase != (int)((FrameCounter / FRAMES_PER_SECOND) & 1);
+	if (red_phase_changed) {
+		red_phase = !red_phase;
+	}
+
+	const int z = UI.CurrentMapLayer->ID;
+
+	this->update_fog(z);
+
+	if (this->overlay_invalidated[z]) {
+		this->update_overlay(z);
+	}
+
+	this->update_units(red_phase, z);
+}
+
+/**
+**  Upload the changed rows of the textures of the current map layer
+*/
+void minimap::upload_textures()
+{
+	if (UI.CurrentMapLayer == nullptr || this->terrain_texture_data.empty()) {
+		return;
+	}
+
+	const int z = UI.CurrentMapLayer->ID;
+
+	this->upload_texture(this->terrain_textures[z], this->terrain_texture_data[z].get(), this->terrain_dirty_rects[z], z);
+	this->upload_texture(this->overlay_textures[z], this->overlay_texture_data[z].get(), this->overlay_dirty_rects[z], z);
+	this->upload_texture(this->unit_textures[z], this->unit_texture_data[z].get(), this->unit_dirty_rects[z], z);
+}
+
+void minimap::upload_texture(const GLuint &texture, const unsigned char *texture_data, QRect &dirty_rect, const int z)
+{
+	if (dirty_rect.isNull()) {
+		return;
+	}
+
+	//only upload the rows which changed; whole rows are uploaded, since they are contiguous in the texture data
+	glBindTexture(GL_TEXTURE_2D, texture);
+	const unsigned char *row_data = texture_data + dirty_rect.top() * MinimapTextureWidth[z] * 4;
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirty_rect.top(), MinimapTextureWidth[z], dirty_rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, row_data);
+	dirty_rect = QRect();
 }
 
 void minimap::draw_events() const
@@ -590,17 +932,17 @@ void minimap::Draw() const
 	const int z = UI.CurrentMapLayer->ID;
 
 	if (this->is_terrain_visible()) {
-		this->draw_texture(this->terrain_textures[z], this->terrain_texture_data[z].get(), z);
+		this->draw_texture(this->terrain_textures[z], z);
 	}
 
-	this->draw_texture(this->overlay_textures[z], this->overlay_texture_data[z].get(), z);
+	this->draw_texture(this->overlay_textures[z], z);
+	this->draw_texture(this->unit_textures[z], z);
 	this->draw_events();
 }
 
-void minimap::draw_texture(const GLuint &texture, const unsigned char *texture_data, const int z) const
+void minimap::draw_texture(const GLuint &texture, const int z) const
 {
 	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, MinimapTextureWidth[z], MinimapTextureHeight[z], GL_RGBA, GL_UNSIGNED_BYTE, texture_data);
 
 #ifdef USE_GLES
 	float texCoord[] = {
@@ -733,10 +1075,28 @@ void minimap::Destroy()
 	this->overlay_texture_data.clear();
 	this->overlay_textures.clear();
 
+	for (size_t z = 0; z < this->unit_texture_data.size(); ++z) {
+		if (this->unit_texture_data[z] != nullptr) {
+			glDeleteTextures(1, &this->unit_textures[z]);
+		}
+	}
+	this->unit_texture_data.clear();
+	this->unit_textures.clear();
+	this->unit_texel_draws.clear();
+
 	Minimap2MapX.clear();
 	Minimap2MapY.clear();
 	Map2MinimapX.clear();
 	Map2MinimapY.clear();
+	tile_texel_x_ranges.clear();
+	tile_texel_y_ranges.clear();
+
+	this->texel_vision_types.clear();
+	this->fog_invalidated.clear();
+	this->overlay_invalidated.clear();
+	this->terrain_dirty_rects.clear();
+	this->overlay_dirty_rects.clear();
+	this->unit_dirty_rects.clear();
 
 	MinimapScaleX.clear();
 	MinimapScaleY.clear();
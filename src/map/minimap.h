@@ -28,6 +28,7 @@
 #pragma once
 
 #include "color.h"
+#include "player_container.h"
 #include "vec2i.h"
 
 #ifdef USE_OPENGL
@@ -47,6 +48,28 @@ enum class minimap_mode;
 class minimap final
 {
 public:
+	//the state on which the fog of war of the minimap depends, other than the tile visibility data
+	struct fog_state final
+	{
+		int player_index = -1;
+		player_mask shared_vision_mask = 0;
+		player_mask revealed_mask = 0;
+		bool no_fog_of_war = false;
+		bool reveal_map = false;
+
+		bool operator ==(const fog_state &other) const = default;
+	};
+
+	//the texels drawn for a unit in the units layer of the minimap
+	struct unit_texel_draw final
+	{
+		int unit_slot = -1;
+		QRect rect;
+		uint32_t color = 0;
+	};
+
+	static fog_state get_current_fog_state();
+
 	minimap();
 
 private:
@@ -58,7 +81,20 @@ public:
 	void UpdateSeenXY(const Vec2i &) {}
 	void update_territory_xy(const QPoint &pos, const int z);
 	void update_territory_pixel(const int mx, const int my, const int z);
+private:
+	void update_fog(const int z);
+	void update_tile_fog(const QPoint &tile_pos, const int z);
+	uint32_t get_overlay_texel_color(const int mx, const int my, const int z) const;
+	void update_overlay(const int z);
+	std::optional<unit_texel_draw> get_unit_texel_draw(const CUnit &unit, const int red_phase, const int z) const;
+	void update_units(const int red_phase, const int z);
+	void redraw_units_in_rect(const QRect &rect, const int z);
+
+public:
+	void invalidate_fog();
+	void invalidate_overlay();
 	void Update();
+	void upload_textures();
 	void Create();
 	void create_textures(const int z);
 	void create_texture(GLuint &texture, const unsigned char *texture_data, const int z);
@@ -68,9 +104,9 @@ public:
 #endif
 	void Destroy();
 	void Draw() const;
-	void draw_texture(const GLuint &texture, const unsigned char *texture_data, const int z) const;
+	void upload_texture(const GLuint &texture, const unsigned char *texture_data, QRect &dirty_rect, const int z);
+	void draw_texture(const GLuint &texture, const int z) const;
 	void DrawViewportArea(const CViewport &viewport) const;
-	void DrawUnitOn(CUnit &unit, int red_phase);
 	void AddEvent(const Vec2i &pos, int z, IntColor color);
 	void draw_events() const;
 
@@ -107,6 +143,7 @@ public:
 		}
 
 		this->mode = mode;
+		this->invalidate_overlay();
 		this->UpdateCache = true;
 	}
 
@@ -150,14 +187,30 @@ private:
 	bool zoomed = false; //whether the minimap texture is being shown at full resolution
 	std::vector<GLuint> terrain_textures;
 	std::vector<GLuint> overlay_textures;
+	std::vector<GLuint> unit_textures;
 
 	// Minimap surface with terrain only (for OpenGL)
 	std::vector<std::unique_ptr<unsigned char[]>> terrain_texture_data;
 
 	std::map<minimap_mode, std::vector<std::unique_ptr<unsigned char[]>>> mode_overlay_texture_data;
 
-	//texture data for the overlay with units and unexplored terrain
+	//texture data for the overlay with the fog of war, composed over the overlay of the current mode, if any
 	std::vector<std::unique_ptr<unsigned char[]>> overlay_texture_data;
+	std::vector<bool> overlay_invalidated; //whether the overlay of a map layer must be fully recomposed, e.g. because the mode changed
+
+	//texture data for the units, drawn over the overlay; only the texels of units which changed are redrawn
+	std::vector<std::unique_ptr<unsigned char[]>> unit_texture_data;
+	std::vector<std::vector<unit_texel_draw>> unit_texel_draws; //the unit texels drawn in the units layer of each map layer, in drawing order
+
+	//the vision type (0 unexplored, 1 explored, 2 visible) of each texel, updated from the tiles whose visibility changed
+	std::vector<std::unique_ptr<unsigned char[]>> texel_vision_types;
+	std::vector<bool> fog_invalidated; //whether the texel vision types of a map layer must be fully recalculated
+	fog_state current_fog_state; //the fog state with which the texel vision types were calculated
+
+	//the texels of each map layer which changed since the textures were last uploaded
+	std::vector<QRect> terrain_dirty_rects;
+	std::vector<QRect> overlay_dirty_rects;
+	std::vector<QRect> unit_dirty_rects;
 };
 
 }
@@ -241,6 +241,36 @@ static int CclStratagusMap(lua_State *l)
 					}
 					lua_pop(l, 1);
 				//Wyrmgus end
+				} else if (!strcmp(subvalue, "map-fields-data")) {
+					lua_rawgeti(l, j + 1, k + 1);
+					if (!lua_istable(l, -1)) {
+						LuaError(l, "incorrect argument for \"map-fields-data\"");
+					}
+					const int subsubargs = lua_rawlen(l, -1);
+					for (int z = 0; z < subsubargs; ++z) {
+						lua_rawgeti(l, -1, z + 1);
+						if (!lua_istable(l, -1)) {
+							LuaError(l, "incorrect argument for \"map-fields-data\"");
+						}
+						std::string encoded_data;
+						const int subsubsubargs = lua_rawlen(l, -1);
+						for (int n = 0; n < subsubsubargs; ++n) {
+							encoded_data += LuaToString(l, -1, n + 1);
+						}
+						lua_pop(l, 1);
+
+						//the Lua error is raised outside of the catch block, since it doesn't return
+						std::string error_message;
+						try {
+							CMap::Map.MapLayers[z]->load_fields_binary(encoded_data);
+						} catch (const std::exception &exception) {
+							error_message = exception.what();
+						}
+						if (!error_message.empty()) {
+							LuaError(l, "Failed to load the fields of map layer %d: %s" _C_ z _C_ error_message.c_str());
+						}
+					}
+					lua_pop(l, 1);
 				} else if (!strcmp(subvalue, "map-fields")) {
 					//Wyrmgus start
 					/*
@@ -0,0 +1,213 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include "stratagus.h"
+
+#include "map/terrain_render_cache.h"
+
+#include "database/defines.h"
+#include "map/map.h"
+#include "map/map_layer.h"
+#include "map/terrain_type.h"
+#include "map/tile.h"
+#include "map/tileset.h"
+#include "util/vector_util.h"
+#include "video/video.h"
+
+namespace wyrmgus {
+
+terrain_render_cache::terrain_render_cache(const CMapLayer *map_layer)
+	: map_layer(map_layer),
+	columns((map_layer->get_width() + terrain_render_cache::chunk_size - 1) / terrain_render_cache::chunk_size),
+	rows((map_layer->get_height() + terrain_render_cache::chunk_size - 1) / terrain_render_cache::chunk_size)
+{
+	this->chunk_records.resize(this->columns * this->rows);
+	this->dirty_chunks.resize(this->columns * this->rows, true);
+}
+
+/**
+**	@brief	Mark all chunks as dirty if the season or the map reveal state changed since they were built
+*/
+void terrain_render_cache::check_render_state()
+{
+	const wyrmgus::season *season = this->map_layer->GetSeason();
+	const bool reveal_map = ReplayRevealMap != 0;
+
+	if (season != this->season || reveal_map != this->reveal_map) {
+		this->season = season;
+		this->reveal_map = reveal_map;
+		this->mark_all_dirty();
+	}
+}
+
+/**
+**	@brief	Get the draw records of a chunk, rebuilding them if the chunk is dirty
+**
+**	@param	chunk_pos	The position of the chunk, in chunks
+**
+**	@return	The draw records of the chunk's tiles, in drawing order
+*/
+const std::vector<terrain_render_cache::draw_record> &terrain_render_cache::get_chunk_records(const QPoint &chunk_pos)
+{
+	const int chunk_index = chunk_pos.x() + chunk_pos.y() * this->columns;
+
+	if (this->dirty_chunks[chunk_index]) {
+		this->build_chunk(chunk_index, chunk_pos);
+		this->dirty_chunks[chunk_index] = false;
+	}
+
+	return this->chunk_records[chunk_index];
+}
+
+void terrain_render_cache::build_chunk(const int chunk_index, const QPoint &chunk_pos)
+{
+	std::vector<draw_record> &records = this->chunk_records[chunk_index];
+	records.clear();
+
+	const int start_x = chunk_pos.x() * terrain_render_cache::chunk_size;
+	const int start_y = chunk_pos.y() * terrain_render_cache::chunk_size;
+	const int end_x = std::min(start_x + terrain_render_cache::chunk_size, this->map_layer->get_width());
+	const int end_y = std::min(start_y + terrain_render_cache::chunk_size, this->map_layer->get_height());
+
+	for (int y = start_y; y < end_y; ++y) {
+		for (int x = start_x; x < end_x; ++x) {
+			this->add_tile_records(records, *this->map_layer->Field(x, y), static_cast<uint8_t>(x - start_x), static_cast<uint8_t>(y - start_y));
+		}
+	}
+}
+
+void terrain_render_cache::add_tile_records(std::vector<draw_record> &records, const wyrmgus::tile &tile, const uint8_t x, const uint8_t y) const
+{
+	const auto add_record = [&records, &tile, x, y](CGraphic *graphics, const int frame, const draw_type type, const animation_type animation, const time_of_day_type time_of_day) {
+		draw_record record;
+		record.graphics = graphics;
+		record.tile = &tile;
+		record.frame = frame;
+		record.x = x;
+		record.y = y;
+		record.type = type;
+		record.animation = animation;
+		record.time_of_day = time_of_day;
+		records.push_back(record);
+	};
+
+	const auto get_terrain_time_of_day_type = [](const terrain_type *terrain) {
+		if (terrain->Flags & MapFieldSpace) {
+			return time_of_day_type::none;
+		}
+
+		if (terrain->Flags & MapFieldUnderground) {
+			return time_of_day_type::underground;
+		}
+
+		return time_of_day_type::map_layer;
+	};
+
+	const terrain_type *terrain = nullptr;
+	const terrain_type *overlay_terrain = nullptr;
+	int solid_tile = 0;
+	int overlay_solid_tile = 0;
+
+	if (this->reveal_map) {
+		terrain = tile.Terrain;
+		overlay_terrain = tile.OverlayTerrain;
+		solid_tile = tile.SolidTile;
+		overlay_solid_tile = tile.OverlaySolidTile;
+	} else {
+		terrain = tile.player_info->SeenTerrain;
+		overlay_terrain = tile.player_info->SeenOverlayTerrain;
+		solid_tile = tile.player_info->SeenSolidTile;
+		overlay_solid_tile = tile.player_info->SeenOverlaySolidTile;
+	}
+
+	const std::vector<std::pair<const terrain_type *, short>> &transition_tiles = this->reveal_map ? tile.TransitionTiles : tile.player_info->SeenTransitionTiles;
+	const std::vector<std::pair<const terrain_type *, short>> &overlay_transition_tiles = this->reveal_map ? tile.OverlayTransitionTiles : tile.player_info->SeenOverlayTransitionTiles;
+
+	const bool is_unpassable = overlay_terrain && (overlay_terrain->Flags & MapFieldUnpassable) && !vector::contains(overlay_terrain->get_destroyed_tiles(), overlay_solid_tile);
+
+	//the time of day of the tile depends on its base terrain, and is also used for its overlay
+	const time_of_day_type tile_time_of_day = (terrain != nullptr) ? get_terrain_time_of_day_type(terrain) : time_of_day_type::map_layer;
+
+	if (terrain != nullptr) {
+		const std::shared_ptr<CPlayerColorGraphic> &terrain_graphics = terrain->get_graphics(this->season);
+		if (terrain_graphics != nullptr) {
+			add_record(terrain_graphics.get(), solid_tile, draw_type::frame, terrain == tile.Terrain ? animation_type::terrain : animation_type::none, tile_time_of_day);
+		}
+	}
+
+	for (const auto &[transition_terrain, transition_tile] : transition_tiles) {
+		const std::shared_ptr<CPlayerColorGraphic> &transition_terrain_graphics = transition_terrain->get_graphics(this->season);
+
+		if (transition_terrain_graphics != nullptr) {
+			add_record(transition_terrain_graphics.get(), transition_tile, draw_type::frame, animation_type::none, get_terrain_time_of_day_type(transition_terrain));
+		}
+	}
+
+	const terrain_type *border_terrain_type = defines::get()->get_border_terrain_type();
+	const std::shared_ptr<CPlayerColorGraphic> *border_graphics = nullptr;
+	if (tile.get_ownership_border_tile() != -1 && border_terrain_type != nullptr && border_terrain_type->get_graphics(this->season) != nullptr) {
+		border_graphics = &border_terrain_type->get_graphics(this->season);
+	}
+
+	//if the tile is not passable, draw the border under its overlay, but otherwise, draw the border over it
+	if (border_graphics != nullptr && is_unpassable) {
+		add_record(border_graphics->get(), tile.get_ownership_border_tile(), draw_type::border, animation_type::none, time_of_day_type::none);
+	}
+
+	if (overlay_terrain && (overlay_transition_tiles.size() == 0 || overlay_terrain->has_transition_mask())) {
+		const bool is_overlay_space = overlay_terrain->Flags & MapFieldSpace;
+		const std::shared_ptr<CPlayerColorGraphic> &overlay_terrain_graphics = overlay_terrain->get_graphics(this->season);
+		if (overlay_terrain_graphics != nullptr) {
+			add_record(overlay_terrain_graphics.get(), overlay_solid_tile, draw_type::player_color_frame, overlay_terrain == tile.OverlayTerrain ? animation_type::overlay : animation_type::none, is_overlay_space ? time_of_day_type::none : tile_time_of_day);
+		}
+	}
+
+	for (const auto &[overlay_transition_terrain, overlay_transition_tile] : overlay_transition_tiles) {
+		if (overlay_transition_terrain->has_transition_mask()) {
+			continue;
+		}
+
+		const bool is_overlay_transition_space = overlay_transition_terrain->Flags & MapFieldSpace;
+		const std::shared_ptr<CPlayerColorGraphic> &overlay_transition_graphics = overlay_transition_terrain->get_transition_graphics(this->season);
+		if (overlay_transition_graphics != nullptr) {
+			add_record(overlay_transition_graphics.get(), overlay_transition_tile, draw_type::player_color_frame, animation_type::none, is_overlay_transition_space ? time_of_day_type::none : tile_time_of_day);
+		}
+	}
+
+	if (border_graphics != nullptr && !is_unpassable) {
+		add_record(border_graphics->get(), tile.get_ownership_border_tile(), draw_type::border, animation_type::none, time_of_day_type::none);
+	}
+
+	for (const auto &[overlay_transition_terrain, overlay_transition_tile] : overlay_transition_tiles) {
+		const std::shared_ptr<CGraphic> &elevation_graphics = overlay_transition_terrain->get_elevation_graphics();
+		if (elevation_graphics != nullptr) {
+			add_record(elevation_graphics.get(), overlay_transition_tile, draw_type::frame, animation_type::none, tile_time_of_day);
+		}
+	}
+}
+
+}
@@ -0,0 +1,116 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+class CGraphic;
+class CMapLayer;
+
+namespace wyrmgus {
+
+class season;
+class tile;
+
+/**
+**  Cache of the terrain draw calls of a map layer, grouped in chunks of tiles.
+**
+**  Each chunk keeps the list of frames to be drawn for its tiles, so that drawing the map background does not have to look up the seen terrain, transitions and graphics of each tile every frame. A chunk's list is rebuilt when any of its tiles is marked as changed, or when the season or the map reveal state of the map layer changes. Animation frames, owner player colors and the time of day are resolved when drawing, so that they do not invalidate the chunks.
+*/
+class terrain_render_cache final
+{
+public:
+	static constexpr int chunk_size = 16;
+
+	enum class draw_type : uint8_t {
+		frame,
+		player_color_frame, //drawn with the player color of the tile's owner, or of the neutral player if the tile has no owner
+		border //drawn with the player color of the tile's owner, and skipped if it has no owner
+	};
+
+	enum class animation_type : uint8_t {
+		none,
+		terrain, //the tile's terrain animation frame is added to the frame
+		overlay //the tile's overlay terrain animation frame is added to the frame
+	};
+
+	enum class time_of_day_type : uint8_t {
+		none,
+		underground,
+		map_layer
+	};
+
+	struct draw_record final
+	{
+		CGraphic *graphics = nullptr;
+		const wyrmgus::tile *tile = nullptr;
+		int frame = 0;
+		uint8_t x = 0; //the tile position within the chunk
+		uint8_t y = 0;
+		draw_type type = draw_type::frame;
+		animation_type animation = animation_type::none;
+		time_of_day_type time_of_day = time_of_day_type::none;
+	};
+
+	explicit terrain_render_cache(const CMapLayer *map_layer);
+
+	int get_columns() const
+	{
+		return this->columns;
+	}
+
+	int get_rows() const
+	{
+		return this->rows;
+	}
+
+	void mark_tile_dirty(const QPoint &tile_pos)
+	{
+		this->dirty_chunks[tile_pos.x() / terrain_render_cache::chunk_size + (tile_pos.y() / terrain_render_cache::chunk_size) * this->columns] = true;
+	}
+
+	void mark_all_dirty()
+	{
+		std::fill(this->dirty_chunks.begin(), this->dirty_chunks.end(), true);
+	}
+
+	void check_render_state();
+	const std::vector<draw_record> &get_chunk_records(const QPoint &chunk_pos);
+
+private:
+	void build_chunk(const int chunk_index, const QPoint &chunk_pos);
+	void add_tile_records(std::vector<draw_record> &records, const wyrmgus::tile &tile, const uint8_t x, const uint8_t y) const;
+
+	const CMapLayer *map_layer = nullptr;
+	int columns = 0;
+	int rows = 0;
+	std::vector<std::vector<draw_record>> chunk_records;
+	std::vector<bool> dirty_chunks;
+	const wyrmgus::season *season = nullptr; //the season with which the chunks were built
+	bool reveal_map = false; //whether the chunks were built with the actual terrain instead of the seen one
+};
+
+}
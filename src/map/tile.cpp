@@ -42,6 +42,7 @@
 #include "script.h"
 #include "unit/unit.h"
 #include "unit/unit_manager.h"
+#include "util/binary_stream.h"
 #include "util/vector_util.h"
 
 namespace wyrmgus {
@@ -383,7 +384,7 @@ void tile::Save(CFile &file) const
 	}
 	//Wyrmgus end
 	for (int i = 0; i != PlayerMax; ++i) {
-		if (player_info->Visible[i] == 1) {
+		if (player_info->get_visible(i) == 1) {
 			file.printf(", \"explored\", %d", i);
 		}
 	}
@@ -583,7 +584,7 @@ void tile::parse(lua_State *l)
 		} else if (!strcmp(value, "explored")) {
 			//Wyrmgus end
 			++j;
-			this->player_info->Visible[LuaToNumber(l, -1, j + 1)] = 1;
+			this->player_info->set_visible(LuaToNumber(l, -1, j + 1), 1);
 		} else if (!strcmp(value, "land")) {
 			this->Flags |= MapFieldLandAllowed;
 		} else if (!strcmp(value, "coast")) {
@@ -651,6 +652,132 @@ void tile::parse(lua_State *l)
 	}
 }
 
+static void save_transition_tiles_binary(binary_writer &writer, const std::vector<std::pair<const terrain_type *, short>> &transition_tiles)
+{
+	writer.write_uint32(static_cast<uint32_t>(transition_tiles.size()));
+
+	for (const auto &[terrain, tile_number] : transition_tiles) {
+		writer.write_identifier(terrain->Ident);
+		writer.write_int16(tile_number);
+	}
+}
+
+static void load_transition_tiles_binary(binary_reader &reader, std::vector<std::pair<const terrain_type *, short>> &transition_tiles)
+{
+	const uint32_t count = reader.read_uint32();
+
+	for (uint32_t i = 0; i < count; ++i) {
+		const terrain_type *terrain = terrain_type::get(reader.read_identifier());
+		const short tile_number = reader.read_int16();
+		transition_tiles.emplace_back(terrain, tile_number);
+	}
+}
+
+/**
+**	@brief	Save the tile to a binary buffer, storing the same data as the text format
+**
+**	@param	writer	The binary writer
+*/
+void tile::save_binary(binary_writer &writer) const
+{
+	const wyrmgus::terrain_feature *terrain_feature = this->get_terrain_feature();
+
+	writer.write_identifier(this->Terrain ? this->Terrain->Ident : "");
+	writer.write_identifier(this->OverlayTerrain ? this->OverlayTerrain->Ident : "");
+	writer.write_identifier(terrain_feature != nullptr ? terrain_feature->get_identifier() : "");
+	writer.write_uint8((this->OverlayTerrainDamaged ? 1 : 0) | (this->OverlayTerrainDestroyed ? 2 : 0));
+	writer.write_identifier(this->player_info->SeenTerrain ? this->player_info->SeenTerrain->Ident : "");
+	writer.write_identifier(this->player_info->SeenOverlayTerrain ? this->player_info->SeenOverlayTerrain->Ident : "");
+	writer.write_int16(this->SolidTile);
+	writer.write_int16(this->OverlaySolidTile);
+	writer.write_int16(this->player_info->SeenSolidTile);
+	writer.write_int16(this->player_info->SeenOverlaySolidTile);
+	writer.write_int16(this->get_value());
+	writer.write_uint8(this->get_cost());
+	writer.write_int32(this->Landmass);
+	writer.write_identifier(this->get_settlement() != nullptr ? this->get_settlement()->get_identifier() : "");
+
+	save_transition_tiles_binary(writer, this->TransitionTiles);
+	save_transition_tiles_binary(writer, this->OverlayTransitionTiles);
+	save_transition_tiles_binary(writer, this->player_info->SeenTransitionTiles);
+	save_transition_tiles_binary(writer, this->player_info->SeenOverlayTransitionTiles);
+
+	uint64_t explored_players = 0;
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (this->player_info->get_visible(i) == 1) {
+			explored_players |= static_cast<uint64_t>(1) << i;
+		}
+	}
+	writer.write_uint64(explored_players);
+
+	//the speed mask is not saved in the text format either
+	writer.write_uint64(this->Flags & ~MapFieldSpeedMask);
+}
+
+/**
+**	@brief	Load the tile from a binary buffer written by save_binary
+**
+**	@param	reader	The binary reader
+*/
+void tile::load_binary(binary_reader &reader)
+{
+	const std::string terrain_ident = reader.read_identifier();
+	if (!terrain_ident.empty()) {
+		this->Terrain = terrain_type::get(terrain_ident);
+	}
+
+	const std::string overlay_terrain_ident = reader.read_identifier();
+	if (!overlay_terrain_ident.empty()) {
+		this->OverlayTerrain = terrain_type::get(overlay_terrain_ident);
+	}
+
+	const std::string terrain_feature_ident = reader.read_identifier();
+	if (!terrain_feature_ident.empty()) {
+		this->terrain_feature = terrain_feature::get(terrain_feature_ident);
+	}
+
+	const uint8_t overlay_state = reader.read_uint8();
+	this->SetOverlayTerrainDamaged((overlay_state & 1) != 0);
+	this->SetOverlayTerrainDestroyed((overlay_state & 2) != 0);
+
+	const std::string seen_terrain_ident = reader.read_identifier();
+	if (!seen_terrain_ident.empty()) {
+		this->player_info->SeenTerrain = terrain_type::get(seen_terrain_ident);
+	}
+
+	const std::string seen_overlay_terrain_ident = reader.read_identifier();
+	if (!seen_overlay_terrain_ident.empty()) {
+		this->player_info->SeenOverlayTerrain = terrain_type::get(seen_overlay_terrain_ident);
+	}
+
+	this->SolidTile = reader.read_int16();
+	this->OverlaySolidTile = reader.read_int16();
+	this->player_info->SeenSolidTile = reader.read_int16();
+	this->player_info->SeenOverlaySolidTile = reader.read_int16();
+	this->value = reader.read_int16();
+	this->cost = reader.read_uint8();
+	this->Landmass = reader.read_int32();
+
+	const std::string settlement_identifier = reader.read_identifier();
+	if (!settlement_identifier.empty()) {
+		this->settlement = site::get(settlement_identifier);
+	}
+
+	load_transition_tiles_binary(reader, this->TransitionTiles);
+	load_transition_tiles_binary(reader, this->OverlayTransitionTiles);
+	load_transition_tiles_binary(reader, this->player_info->SeenTransitionTiles);
+	load_transition_tiles_binary(reader, this->player_info->SeenOverlayTransitionTiles);
+
+	const uint64_t explored_players = reader.read_uint64();
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (explored_players & (static_cast<uint64_t>(1) << i)) {
+			this->player_info->set_visible(i, 1);
+		}
+	}
+
+	this->Flags |= static_cast<unsigned long>(reader.read_uint64());
+}
+
 /// Check if a field flags.
 bool tile::CheckMask(const int mask) const
 {
@@ -753,26 +880,20 @@ unsigned char tile_player_info::TeamVisibilityState(const CPlayer &player) const
 		maxVision = 1;
 	}
 
-	const int player_index = player.Index;
-	for (const int i : player.get_shared_vision()) {
-		if (CPlayer::Players[i]->has_shared_vision_with(player_index)) { //if the shared vision is mutual
-			maxVision = std::max<unsigned char>(maxVision, this->Visible[i]);
-			if (maxVision >= 2) {
-				return 2;
-			}
-		}
-	}
+	const player_mask shared_vision_mask = player.get_mutual_shared_vision_mask();
 
+	player_mask revealed_mask = 0;
 	for (const CPlayer *other_player : CPlayer::get_revealed_players()) {
-		const int other_player_index = other_player->Index;
-		if (this->Visible[other_player_index] < 2) { //don't show a revealed player's explored tiles, only the currently visible ones
-			continue;
-		}
+		revealed_mask |= get_player_mask(other_player->Index);
+	}
 
-		maxVision = std::max<unsigned char>(maxVision, Visible[other_player_index]);
-		if (maxVision >= 2) {
-			return 2;
-		}
+	//don't show a revealed player's explored tiles, only the currently visible ones
+	if ((this->visibility->get_visible_mask(this->tile_index) & (shared_vision_mask | revealed_mask)) != 0) {
+		return 2;
+	}
+
+	if ((this->visibility->get_explored_mask(this->tile_index) & shared_vision_mask) != 0) {
+		maxVision = 1;
 	}
 
 	if (maxVision == 1 && CMap::Map.NoFogOfWar) {
@@ -784,20 +905,20 @@ unsigned char tile_player_info::TeamVisibilityState(const CPlayer &player) const
 
 bool tile_player_info::IsExplored(const CPlayer &player) const
 {
-	return Visible[player.Index] != 0;
+	return this->get_visible(player.Index) != 0;
 }
 
 //Wyrmgus start
 bool tile_player_info::IsTeamExplored(const CPlayer &player) const
 {
-	return Visible[player.Index] != 0 || TeamVisibilityState(player) != 0;
+	return this->get_visible(player.Index) != 0 || TeamVisibilityState(player) != 0;
 }
 //Wyrmgus end
 
 bool tile_player_info::IsVisible(const CPlayer &player) const
 {
 	const bool fogOfWar = !CMap::Map.NoFogOfWar;
-	return Visible[player.Index] >= 2 || (!fogOfWar && IsExplored(player));
+	return this->get_visible(player.Index) >= 2 || (!fogOfWar && IsExplored(player));
 }
 
 bool tile_player_info::IsTeamVisible(const CPlayer &player) const
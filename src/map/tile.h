@@ -33,23 +33,25 @@
 **    This is the tile number, that the player sitting on the computer
 **    currently knows. Idea: Can be uses for illusions.
 **
-**  tile_player_info::Visible[]
+**  tile_player_info::get_visible()
 **
 **    Counter how many units of the player can see this field. 0 the
 **    field is not explored, 1 explored, n-1 unit see it. Currently
 **    no more than 253 units can see a field.
 **
-**  tile_player_info::VisCloak[]
+**  tile_player_info::get_cloak()
 **
 **    Visiblity for cloaking.
 **
-**  tile_player_info::Radar[]
+**  tile_player_info::get_radar()
 **
 **    Visiblity for radar.
 **
-**  tile_player_info::RadarJammer[]
+**  tile_player_info::get_radar_jammer()
 **
 **    Jamming capabilities.
+**
+**  The counters themselves are stored per map layer, in wyrmgus::tile_visibility.
 */
 
 /**
@@ -108,6 +110,7 @@
 **    top and right most map coordinate.
 */
 
+#include "map/tile_visibility.h"
 #include "unit/unit_cache.h"
 #include "vec2i.h"
 
@@ -121,6 +124,8 @@ struct lua_State;
 
 namespace wyrmgus {
 
+class binary_reader;
+class binary_writer;
 class resource;
 class site;
 class terrain_feature;
@@ -129,13 +134,60 @@ class terrain_type;
 class tile_player_info final
 {
 public:
-	tile_player_info()
+	void set_visibility_data(tile_visibility *visibility, const unsigned int tile_index)
+	{
+		this->visibility = visibility;
+		this->tile_index = tile_index;
+	}
+
+	unsigned short get_visible(const int player_index) const
+	{
+		return this->visibility->get_visible(player_index, this->tile_index);
+	}
+
+	void set_visible(const int player_index, const unsigned short value)
+	{
+		this->visibility->set_visible(player_index, this->tile_index, value);
+	}
+
+	unsigned char get_cloak(const int player_index) const
+	{
+		return this->visibility->get_cloak(player_index, this->tile_index);
+	}
+
+	void set_cloak(const int player_index, const unsigned char value)
+	{
+		this->visibility->set_cloak(player_index, this->tile_index, value);
+	}
+
+	unsigned char get_ethereal(const int player_index) const
 	{
-		memset(Visible, 0, sizeof(Visible));
-		memset(VisCloak, 0, sizeof(VisCloak));
-		memset(VisEthereal, 0, sizeof(VisEthereal));
-		memset(Radar, 0, sizeof(Radar));
-		memset(RadarJammer, 0, sizeof(RadarJammer));
+		return this->visibility->get_ethereal(player_index, this->tile_index);
+	}
+
+	void set_ethereal(const int player_index, const unsigned char value)
+	{
+		this->visibility->set_ethereal(player_index, this->tile_index, value);
+	}
+
+	unsigned char get_radar(const int player_index) const
+	{
+		return this->visibility->get_radar(player_index, this->tile_index);
+	}
+
+	void set_radar(const int player_index, const unsigned char value)
+	{
+		this->visibility->set_radar(player_index, this->tile_index, value);
+	}
+
+	unsigned char get_radar_jammer(const int player_index) const
+	{
+		return this->visibility->get_radar_jammer(player_index, this->tile_index);
+	}
+
+	void set_radar_jammer(const int player_index, const unsigned char value)
+	{
+		this->visibility->set_radar_jammer(player_index, this->tile_index, value);
 	}
 
 	/// Check if a field for the user is explored.
@@ -167,11 +219,9 @@ public:
 	std::vector<std::pair<const wyrmgus::terrain_type *, short>> SeenTransitionTiles;			/// Transition tiles; the pair contains the terrain type and the tile index
 	std::vector<std::pair<const wyrmgus::terrain_type *, short>> SeenOverlayTransitionTiles;		/// Overlay transition tiles; the pair contains the terrain type and the tile index
 	//Wyrmgus end
-	unsigned short Visible[PlayerMax];    /// Seen counter 0 unexplored
-	unsigned char VisCloak[PlayerMax];    /// Visiblity for cloaking.
-	unsigned char VisEthereal[PlayerMax];    /// Visiblity for ethereal.
-	unsigned char Radar[PlayerMax];       /// Visiblity for radar.
-	unsigned char RadarJammer[PlayerMax]; /// Jamming capabilities.
+private:
+	tile_visibility *visibility = nullptr; //the visibility counters of the map layer the tile belongs to
+	unsigned int tile_index = 0; //the index of the tile in its map layer
 };
 
 /// Describes a field of the map
@@ -182,6 +232,8 @@ public:
 
 	void Save(CFile &file) const;
 	void parse(lua_State *l);
+	void save_binary(binary_writer &writer) const;
+	void load_binary(binary_reader &reader);
 
 	//Wyrmgus start
 	void SetTerrain(const terrain_type *terrain_type);
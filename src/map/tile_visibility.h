@@ -0,0 +1,198 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+#include "player_container.h"
+
+namespace wyrmgus {
+
+/**
+**  The per-player visibility counters of the tiles of a map layer.
+**
+**  The counters are stored as one plane per player, with a player's plane only being allocated when
+**  the player first gets visibility on the layer, so that unused player slots take no memory.
+**  Bitmasks of the players which have explored or are currently seeing each tile are kept up to date
+**  as well, so that team visibility can be checked without going through each player.
+**  The number of tiles each player has explored is also counted for square blocks of the layer, so that whether an area has been fully explored can be checked without going through its tiles.
+*/
+class tile_visibility final
+{
+public:
+	static_assert(PlayerMax <= static_cast<int>(sizeof(player_mask) * 8), "Player masks must be able to hold a bit for each player.");
+
+	static constexpr int explored_block_size = 16;
+
+	explicit tile_visibility(const int width, const int height)
+		: width(width), tile_count(width * height),
+		block_columns((width + tile_visibility::explored_block_size - 1) / tile_visibility::explored_block_size),
+		block_count(block_columns * ((height + tile_visibility::explored_block_size - 1) / tile_visibility::explored_block_size)),
+		explored_masks(tile_count, 0), visible_masks(tile_count, 0)
+	{
+	}
+
+	/// Get the sight counter of a player for a tile: 0 if unexplored, 1 if explored and 2 or more if visible
+	unsigned short get_visible(const int player_index, const unsigned int tile_index) const
+	{
+		const player_plane *plane = this->planes[player_index].get();
+		return plane != nullptr ? plane->visible[tile_index] : 0;
+	}
+
+	void set_visible(const int player_index, const unsigned int tile_index, const unsigned short value)
+	{
+		player_plane &plane = this->get_or_create_plane(player_index);
+		plane.visible[tile_index] = value;
+
+		const player_mask mask = get_player_mask(player_index);
+		const bool was_explored = (this->explored_masks[tile_index] & mask) != 0;
+
+		if (value >= 1) {
+			if (!was_explored) {
+				this->explored_masks[tile_index] |= mask;
+				++plane.block_explored_counts[this->get_block_index(tile_index)];
+			}
+		} else if (was_explored) {
+			this->explored_masks[tile_index] &= ~mask;
+			--plane.block_explored_counts[this->get_block_index(tile_index)];
+		}
+
+		if (value >= 2) {
+			this->visible_masks[tile_index] |= mask;
+		} else {
+			this->visible_masks[tile_index] &= ~mask;
+		}
+	}
+
+	unsigned char get_cloak(const int player_index, const unsigned int tile_index) const
+	{
+		const player_plane *plane = this->planes[player_index].get();
+		return plane != nullptr ? plane->cloak[tile_index] : 0;
+	}
+
+	void set_cloak(const int player_index, const unsigned int tile_index, const unsigned char value)
+	{
+		this->get_or_create_plane(player_index).cloak[tile_index] = value;
+	}
+
+	unsigned char get_ethereal(const int player_index, const unsigned int tile_index) const
+	{
+		const player_plane *plane = this->planes[player_index].get();
+		return plane != nullptr ? plane->ethereal[tile_index] : 0;
+	}
+
+	void set_ethereal(const int player_index, const unsigned int tile_index, const unsigned char value)
+	{
+		this->get_or_create_plane(player_index).ethereal[tile_index] = value;
+	}
+
+	unsigned char get_radar(const int player_index, const unsigned int tile_index) const
+	{
+		const player_plane *plane = this->planes[player_index].get();
+		return plane != nullptr ? plane->radar[tile_index] : 0;
+	}
+
+	void set_radar(const int player_index, const unsigned int tile_index, const unsigned char value)
+	{
+		this->get_or_create_plane(player_index).radar[tile_index] = value;
+	}
+
+	unsigned char get_radar_jammer(const int player_index, const unsigned int tile_index) const
+	{
+		const player_plane *plane = this->planes[player_index].get();
+		return plane != nullptr ? plane->radar_jammer[tile_index] : 0;
+	}
+
+	void set_radar_jammer(const int player_index, const unsigned int tile_index, const unsigned char value)
+	{
+		this->get_or_create_plane(player_index).radar_jammer[tile_index] = value;
+	}
+
+	/// Get the mask of the players which have explored a tile
+	player_mask get_explored_mask(const unsigned int tile_index) const
+	{
+		return this->explored_masks[tile_index];
+	}
+
+	/// Get the mask of the players which currently see a tile
+	player_mask get_visible_mask(const unsigned int tile_index) const
+	{
+		return this->visible_masks[tile_index];
+	}
+
+	/// Get the index of the explored block a tile belongs to
+	int get_block_index(const unsigned int tile_index) const
+	{
+		const int x = static_cast<int>(tile_index) % this->width;
+		const int y = static_cast<int>(tile_index) / this->width;
+		return (x / tile_visibility::explored_block_size) + (y / tile_visibility::explored_block_size) * this->block_columns;
+	}
+
+	/// Get how many tiles of a block a player has explored
+	int get_block_explored_count(const int player_index, const int block_index) const
+	{
+		const player_plane *plane = this->planes[player_index].get();
+		return plane != nullptr ? plane->block_explored_counts[block_index] : 0;
+	}
+
+private:
+	/// The visibility counters of a single player, for every tile of the map layer
+	struct player_plane final
+	{
+		explicit player_plane(const int tile_count, const int block_count)
+			: visible(tile_count, 0), cloak(tile_count, 0), ethereal(tile_count, 0), radar(tile_count, 0), radar_jammer(tile_count, 0), block_explored_counts(block_count, 0)
+		{
+		}
+
+		std::vector<unsigned short> visible;
+		std::vector<unsigned char> cloak;
+		std::vector<unsigned char> ethereal;
+		std::vector<unsigned char> radar;
+		std::vector<unsigned char> radar_jammer;
+		std::vector<uint16_t> block_explored_counts; //the number of explored tiles in each block
+	};
+
+	player_plane &get_or_create_plane(const int player_index)
+	{
+		std::unique_ptr<player_plane> &plane = this->planes[player_index];
+
+		if (plane == nullptr) {
+			plane = std::make_unique<player_plane>(this->tile_count, this->block_count);
+		}
+
+		return *plane;
+	}
+
+	const int width = 0;
+	const int tile_count = 0;
+	const int block_columns = 0;
+	const int block_count = 0;
+	std::unique_ptr<player_plane> planes[PlayerMax];
+	std::vector<player_mask> explored_masks;
+	std::vector<player_mask> visible_masks;
+};
+
+}
@@ -39,6 +39,7 @@
 #include "unit/unit.h"
 #include "unit/unit_find.h"
 #include "unit/unit_type_type.h"
+#include "util/generation_stamped_array.h"
 
 #include "pathfinder.h"
 
@@ -84,23 +85,19 @@ const int XY2Heading[3][3] = { {7, 6, 5}, {0, 0, 4}, {1, 2, 3}};
 /// cost matrix
 //Wyrmgus start
 //static Node *AStarMatrix;
-static std::vector<std::unique_ptr<Node[]>> AStarMatrix;
+//the nodes are stamped with the search generation, so that the matrix doesn't need to be cleared between searches
+static std::vector<wyrmgus::generation_stamped_array<Node>> AStarMatrix;
 //Wyrmgus end
 
-/// a list of close nodes, helps to speed up the matrix cleaning
 //Wyrmgus start
+/// a list of close nodes, helps to speed up the matrix cleaning
 //static int *CloseSet;
 //static int CloseSetSize;
 //static int Threshold;
 //static int OpenSetMaxSize;
 //static int AStarMatrixSize;
-static std::vector<std::unique_ptr<int[]>> CloseSet;
-static std::vector<int> CloseSetSize;
-static std::vector<int> Threshold;
 static std::vector<int> OpenSetMaxSize;
-static std::vector<int> AStarMatrixSize;
 //Wyrmgus end
-static constexpr int MAX_CLOSE_SET_RATIO = 4;
 static constexpr int MAX_OPEN_SET_RATIO = 8; // 10,16 to small
 
 /// see pathfinder.h
@@ -137,9 +134,9 @@ static std::vector<int> OpenSetSize;
 
 //Wyrmgus start
 //static int *CostMoveToCache;
-static std::vector<std::unique_ptr<int[]>> CostMoveToCache;
+//static constexpr int CacheNotSet = -5;
+static std::vector<wyrmgus::generation_stamped_array<int>> CostMoveToCache;
 //Wyrmgus end
-static constexpr int CacheNotSet = -5;
 
 /*----------------------------------------------------------------------------
 --  Profile
@@ -304,19 +301,13 @@ void InitAStar()
 		AStarMapWidth.push_back(CMap::Map.Info.MapWidths[z]);
 		AStarMapHeight.push_back(CMap::Map.Info.MapHeights[z]);
 		
-		AStarMatrixSize.push_back(sizeof(Node) * AStarMapWidth[z] * AStarMapHeight[z]);
-		AStarMatrix.push_back(std::make_unique<Node[]>(AStarMapWidth[z] * AStarMapHeight[z]));
-		memset(AStarMatrix[z].get(), 0, AStarMatrixSize[z]);
-
-		Threshold.push_back(AStarMapWidth[z] * AStarMapHeight[z] / MAX_CLOSE_SET_RATIO);
-		CloseSet.push_back(std::make_unique<int[]>(Threshold[z]));
-		CloseSetSize.push_back(0);
+		AStarMatrix.emplace_back(AStarMapWidth[z] * AStarMapHeight[z]);
 
 		OpenSetMaxSize.push_back(AStarMapWidth[z] * AStarMapHeight[z] / MAX_OPEN_SET_RATIO);
 		OpenSet.push_back(std::make_unique<Open[]>(OpenSetMaxSize[z]));
 		OpenSetSize.push_back(0);
 
-		CostMoveToCache.push_back(std::make_unique<int[]>(AStarMapWidth[z] * AStarMapHeight[z]));
+		CostMoveToCache.emplace_back(AStarMapWidth[z] * AStarMapHeight[z]);
 
 		for (int i = 0; i < 9; ++i) {
 			Heading2O[i].push_back(Heading2Y[i] * AStarMapWidth[z]);
@@ -350,10 +341,6 @@ void FreeAStar()
 	CostMoveToCache = nullptr;
 	*/
 	AStarMatrix.clear();
-	AStarMatrixSize.clear();
-	Threshold.clear();
-	CloseSet.clear();
-	CloseSetSize.clear();
 	OpenSet.clear();
 	OpenSetSize.clear();
 	OpenSetMaxSize.clear();
@@ -367,22 +354,10 @@ void FreeAStar()
 	ProfilePrint();
 }
 
-/**
-**  Prepare pathfinder.
-*/
-//Wyrmgus start
-//static void AStarPrepare()
-static void AStarPrepare(int z)
-//Wyrmgus end
-{
-	//Wyrmgus start
-//	memset(AStarMatrix, 0, AStarMatrixSize);
-	memset(AStarMatrix[z].get(), 0, AStarMatrixSize[z]);
-	//Wyrmgus end
-}
-
 /**
 **  Clean up A*
+**
+**  Starts a new search generation, which invalidates all nodes and cached move costs of the previous searches.
 */
 //Wyrmgus start
 //static void AStarCleanUp()
@@ -392,81 +367,24 @@ static void AStarCleanUp(int z)
 	ProfileBegin("AStarCleanUp");
 
 	//Wyrmgus start
-//	if (CloseSetSize >= Threshold) {
-	if (CloseSetSize[z] >= Threshold[z]) {
+	AStarMatrix[z].next_generation();
+	CostMoveToCache[z].next_generation();
 	//Wyrmgus end
-		//Wyrmgus start
-//		AStarPrepare();
-		AStarPrepare(z);
-		//Wyrmgus end
-	} else {
-		for (int i = 0; i < CloseSetSize[z]; ++i) {
-			//Wyrmgus start
-//			AStarMatrix[CloseSet[i]].CostFromStart = 0;
-//			AStarMatrix[CloseSet[i]].InGoal = 0;
-			AStarMatrix[z][CloseSet[z][i]].CostFromStart = 0;
-			AStarMatrix[z][CloseSet[z][i]].InGoal = 0;
-			//Wyrmgus end
-		}
-	}
 	ProfileEnd("AStarCleanUp");
 }
 
 //Wyrmgus start
-//static void CostMoveToCacheCleanUp()
-static void CostMoveToCacheCleanUp(int z)
-//Wyrmgus end
+/**
+**  Get a node of the cost matrix, resetting it first if it is stale from a previous search
+*/
+static inline Node &AStarGetNode(int index, int z)
 {
-	ProfileBegin("CostMoveToCacheCleanUp");
-	//Wyrmgus start
-//	int AStarMapMax =  AStarMapWidth * AStarMapHeight;
-	int AStarMapMax =  AStarMapWidth[z] * AStarMapHeight[z];
-	//Wyrmgus end
-#if 1
-	//Wyrmgus start
-//	int *ptr = CostMoveToCache;
-	int *ptr = CostMoveToCache[z].get();
-	//Wyrmgus end
-#ifdef __x86_64__
-	union {
-		intptr_t d;
-		int i[2];
-	} conv;
-	conv.i[0] = CacheNotSet;
-	conv.i[1] = CacheNotSet;
-
-	if (((uintptr_t)ptr) & 4) {
-		*ptr++ = CacheNotSet;
-		--AStarMapMax;
-	}
-#endif
-	while (AStarMapMax > 3) {
-#ifdef __x86_64__
-		*((intptr_t *)ptr) = conv.d;
-		*((intptr_t *)(ptr + 2)) = conv.d;
-		ptr += 4;
-#else
-		*ptr++ = CacheNotSet;
-		*ptr++ = CacheNotSet;
-		*ptr++ = CacheNotSet;
-		*ptr++ = CacheNotSet;
-#endif
-		AStarMapMax -= 4;
-	};
-	while (AStarMapMax) {
-		*ptr++ = CacheNotSet;
-		--AStarMapMax;
-	}
-#else
-	for (int i = 0; i < AStarMapMax; ++i) {
-		//Wyrmgus start
-//		CostMoveToCache[i] = CacheNotSet;
-		CostMoveToCache[z][i] = CacheNotSet;
-		//Wyrmgus end
-	}
-#endif
-	ProfileEnd("CostMoveToCacheCleanUp");
+	return AStarMatrix[z].get(index, [](Node &node) {
+		node.CostFromStart = 0;
+		node.InGoal = 0;
+	});
 }
+//Wyrmgus end
 
 /**
 **  Find the best node in the current open node set
@@ -533,7 +451,7 @@ static inline int AStarAddNode(const Vec2i &pos, int o, int costs, int z)
 
 	//Wyrmgus start
 //	const int costToGoal = AStarMatrix[o].CostToGoal;
-	const int costToGoal = AStarMatrix[z][o].CostToGoal;
+	const int costToGoal = AStarGetNode(o, z).CostToGoal;
 	//Wyrmgus end
 	const int dist = MyAbs(pos.x - AStarGoalX) + MyAbs(pos.y - AStarGoalY);
 
@@ -548,7 +466,7 @@ static inline int AStarAddNode(const Vec2i &pos, int o, int costs, int z)
 		midcost = open->Costs;
 		//Wyrmgus start
 //		midCostToGoal = AStarMatrix[open->O].CostToGoal;
-		midCostToGoal = AStarMatrix[z][open->O].CostToGoal;
+		midCostToGoal = AStarGetNode(open->O, z).CostToGoal;
 		//Wyrmgus end
 		midDist = MyAbs(open->pos.x - AStarGoalX) + MyAbs(open->pos.y - AStarGoalY);
 		if (costs > midcost || (costs == midcost
@@ -658,25 +576,6 @@ static int AStarFindNode(int eo, int z)
 	return -1;
 }
 
-/**
-**  Add a node to the closed set
-*/
-//Wyrmgus start
-//static void AStarAddToClose(int node)
-static void AStarAddToClose(int node, int z)
-//Wyrmgus end
-{
-	//Wyrmgus start
-//	if (CloseSetSize < Threshold) {
-	if (CloseSetSize[z] < Threshold[z]) {
-	//Wyrmgus end
-		//Wyrmgus start
-//		CloseSet[CloseSetSize++] = node;
-		CloseSet[z][CloseSetSize[z]++] = node;
-		//Wyrmgus end
-	}
-}
-
 //Wyrmgus start
 //#define GetIndex(x, y) (x) + (y) * AStarMapWidth
 #define GetIndex(x, y, z) (x) + (y) * AStarMapWidth[(z)]
@@ -811,16 +710,15 @@ static inline int CostMoveTo(unsigned int index, const CUnit &unit, int z)
 	//Wyrmgus end
 	//Wyrmgus start
 //	int *c = &CostMoveToCache[index];
-	int *c = &CostMoveToCache[z][index];
-	//Wyrmgus end
-	if (*c != CacheNotSet) {
-		return *c;
-	}
-	//Wyrmgus start
+//	if (*c != CacheNotSet) {
+//		return *c;
+//	}
 //	*c = CostMoveToCallBack_Default(index, unit);
-	*c = CostMoveToCallBack_Default(index, unit, z);
+//	return *c;
+	return CostMoveToCache[z].get(index, [index, &unit, z](int &cost) {
+		cost = CostMoveToCallBack_Default(index, unit, z);
+	});
 	//Wyrmgus end
-	return *c;
 }
 
 class AStarGoalMarker
@@ -841,13 +739,12 @@ public:
 		//Wyrmgus end
 			//Wyrmgus start
 //			AStarMatrix[offset].InGoal = 1;
-			AStarMatrix[z][offset].InGoal = 1;
+			AStarGetNode(offset, z).InGoal = 1;
 			//Wyrmgus end
 			*goal_reachable = true;
 		}
 		//Wyrmgus start
 //		AStarAddToClose(offset);
-		AStarAddToClose(offset, z);
 		//Wyrmgus end
 	}
 private:
@@ -1105,7 +1002,7 @@ static int AStarMarkGoal(const Vec2i &goal, int gw, int gh,
 		//Wyrmgus end
 			//Wyrmgus start
 //			AStarMatrix[offset].InGoal = 1;
-			AStarMatrix[z][offset].InGoal = 1;
+			AStarGetNode(offset, z).InGoal = 1;
 			//Wyrmgus end
 			ProfileEnd("AStarMarkGoal");
 			return 1;
@@ -1166,7 +1063,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 	while (curr != startPos) {
 		//Wyrmgus start
 //		direction = AStarMatrix[currO + curr.x].Direction;
-		direction = AStarMatrix[z][currO + curr.x].Direction;
+		direction = AStarGetNode(currO + curr.x, z).Direction;
 		//Wyrmgus end
 		curr.x -= Heading2X[direction];
 		curr.y -= Heading2Y[direction];
@@ -1189,7 +1086,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 		while (curr != startPos) {
 			//Wyrmgus start
 //			direction = AStarMatrix[currO + curr.x].Direction;
-			direction = AStarMatrix[z][currO + curr.x].Direction;
+			direction = AStarGetNode(currO + curr.x, z).Direction;
 			//Wyrmgus end
 			curr.x -= Heading2X[direction];
 			curr.y -= Heading2Y[direction];
@@ -1309,14 +1206,12 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 //	AStarCleanUp();
 //	CostMoveToCacheCleanUp();
 	AStarCleanUp(z);
-	CostMoveToCacheCleanUp(z);
 	//Wyrmgus end
 
 	//Wyrmgus start
 //	OpenSetSize = 0;
 //	CloseSetSize = 0;
 	OpenSetSize[z] = 0;
-	CloseSetSize[z] = 0;
 	//Wyrmgus end
 
 	//Wyrmgus start
@@ -1337,12 +1232,12 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 	// 0 as a way to represent nodes that we have not visited yet.
 	//Wyrmgus start
 //	AStarMatrix[eo].CostFromStart = 1;
-	AStarMatrix[z][eo].CostFromStart = 1;
+	AStarGetNode(eo, z).CostFromStart = 1;
 	//Wyrmgus end
 	// 8 to say we are came from nowhere.
 	//Wyrmgus start
 //	AStarMatrix[eo].Direction = 8;
-	AStarMatrix[z][eo].Direction = 8;
+	AStarGetNode(eo, z).Direction = 8;
 	//Wyrmgus end
 
 	// place start point in open, it that failed, try another pathfinder
@@ -1350,7 +1245,7 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 	//Wyrmgus start
 //	AStarMatrix[eo].CostToGoal = costToGoal;
 //	if (AStarAddNode(startPos, eo, 1 + costToGoal) == PF_FAILED) {
-	AStarMatrix[z][eo].CostToGoal = costToGoal;
+	AStarGetNode(eo, z).CostToGoal = costToGoal;
 	if (AStarAddNode(startPos, eo, 1 + costToGoal, z) == PF_FAILED) {
 	//Wyrmgus end
 		ret = PF_FAILED;
@@ -1360,8 +1255,7 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 	//Wyrmgus start
 //	AStarAddToClose(OpenSet[0].O);
 //	if (AStarMatrix[eo].InGoal) {
-	AStarAddToClose(OpenSet[z][0].O, z);
-	if (AStarMatrix[z][eo].InGoal) {
+	if (AStarGetNode(eo, z).InGoal) {
 	//Wyrmgus end
 		ret = PF_REACHED;
 		ProfileEnd("AStarFindPath");
@@ -1403,7 +1297,7 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 		// If we have reached the goal, then exit.
 		//Wyrmgus start
 //		if (AStarMatrix[o].InGoal == 1) {
-		if (AStarMatrix[z][o].InGoal == 1) {
+		if (AStarGetNode(o, z).InGoal == 1) {
 		//Wyrmgus end
 			endPos.x = x;
 			endPos.y = y;
@@ -1428,8 +1322,8 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 		//Wyrmgus start
 //		const int px = x - Heading2X[(int)AStarMatrix[o].Direction];
 //		const int py = y - Heading2Y[(int)AStarMatrix[o].Direction];
-		const int px = x - Heading2X[(int)AStarMatrix[z][o].Direction];
-		const int py = y - Heading2Y[(int)AStarMatrix[z][o].Direction];
+		const int px = x - Heading2X[(int)AStarGetNode(o, z).Direction];
+		const int py = y - Heading2Y[(int)AStarGetNode(o, z).Direction];
 		//Wyrmgus end
 
 		for (int i = 0; i < 8; ++i) {
@@ -1485,43 +1379,42 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 			//Wyrmgus start
 //			new_cost += AStarMatrix[o].CostFromStart;
 //			if (AStarMatrix[eo].CostFromStart == 0) {
-			new_cost += AStarMatrix[z][o].CostFromStart;
-			if (AStarMatrix[z][eo].CostFromStart == 0) {
+			new_cost += AStarGetNode(o, z).CostFromStart;
+			if (AStarGetNode(eo, z).CostFromStart == 0) {
 			//Wyrmgus end
 				// we are sure the current node has not been already visited
 				//Wyrmgus start
 //				AStarMatrix[eo].CostFromStart = new_cost;
 //				AStarMatrix[eo].Direction = i;
-				AStarMatrix[z][eo].CostFromStart = new_cost;
-				AStarMatrix[z][eo].Direction = i;
+				AStarGetNode(eo, z).CostFromStart = new_cost;
+				AStarGetNode(eo, z).Direction = i;
 				//Wyrmgus end
 				costToGoal = AStarCosts(endPos, goalPos);
 				//Wyrmgus start
 //				AStarMatrix[eo].CostToGoal = costToGoal;
 //				if (AStarAddNode(endPos, eo, AStarMatrix[eo].CostFromStart + costToGoal) == PF_FAILED) {
-				AStarMatrix[z][eo].CostToGoal = costToGoal;
-				if (AStarAddNode(endPos, eo, AStarMatrix[z][eo].CostFromStart + costToGoal, z) == PF_FAILED) {
+				AStarGetNode(eo, z).CostToGoal = costToGoal;
+				if (AStarAddNode(endPos, eo, AStarGetNode(eo, z).CostFromStart + costToGoal, z) == PF_FAILED) {
 				//Wyrmgus end
 					ret = PF_FAILED;
 					ProfileEnd("AStarFindPath");
 					return ret;
 				}
-				// we add the point to the close set
 				//Wyrmgus start
+				// we add the point to the close set
 //				AStarAddToClose(eo);
-				AStarAddToClose(eo, z);
 				//Wyrmgus end
 			//Wyrmgus start
 //			} else if (new_cost < AStarMatrix[eo].CostFromStart) {
-			} else if (new_cost < AStarMatrix[z][eo].CostFromStart) {
+			} else if (new_cost < AStarGetNode(eo, z).CostFromStart) {
 			//Wyrmgus end
 				// Already visited node, but we have here a better path
 				// I know, it's redundant (but simpler like this)
 				//Wyrmgus start
 //				AStarMatrix[eo].CostFromStart = new_cost;
 //				AStarMatrix[eo].Direction = i;
-				AStarMatrix[z][eo].CostFromStart = new_cost;
-				AStarMatrix[z][eo].Direction = i;
+				AStarGetNode(eo, z).CostFromStart = new_cost;
+				AStarGetNode(eo, z).Direction = i;
 				//Wyrmgus end
 				// this point might be already in the OpenSet
 				//Wyrmgus start
@@ -1533,8 +1426,8 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 					//Wyrmgus start
 //					AStarMatrix[eo].CostToGoal = costToGoal;
 //					if (AStarAddNode(endPos, eo, AStarMatrix[eo].CostFromStart + costToGoal) == PF_FAILED) {
-					AStarMatrix[z][eo].CostToGoal = costToGoal;
-					if (AStarAddNode(endPos, eo, AStarMatrix[z][eo].CostFromStart + costToGoal, z) == PF_FAILED) {
+					AStarGetNode(eo, z).CostToGoal = costToGoal;
+					if (AStarAddNode(endPos, eo, AStarGetNode(eo, z).CostFromStart + costToGoal, z) == PF_FAILED) {
 					//Wyrmgus end
 						ret = PF_FAILED;
 						ProfileEnd("AStarFindPath");
@@ -1545,7 +1438,7 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 					//Wyrmgus start
 //					AStarMatrix[eo].CostToGoal = costToGoal;
 //					AStarReplaceNode(j);
-					AStarMatrix[z][eo].CostToGoal = costToGoal;
+					AStarGetNode(eo, z).CostToGoal = costToGoal;
 					AStarReplaceNode(j, z);
 					//Wyrmgus end
 				}
@@ -1597,7 +1490,7 @@ static std::unique_ptr<StatsNode[]> AStarGetStats(const int z)
 	StatsNode *s = stats.get();
 	//Wyrmgus start
 //	Node *m = AStarMatrix;
-	Node *m = AStarMatrix[z].get();
+	int index = 0;
 	//Wyrmgus end
 
 	//Wyrmgus start
@@ -1608,12 +1501,21 @@ static std::unique_ptr<StatsNode[]> AStarGetStats(const int z)
 //		for (int i = 0; i < AStarMapWidth; ++i) {
 		for (int i = 0; i < AStarMapWidth[z]; ++i) {
 		//Wyrmgus end
-			s->Direction = m->Direction;
-			s->InGoal = m->InGoal;
-			s->CostFromStart = m->CostFromStart;
-			s->CostToGoal = m->CostToGoal;
+			//Wyrmgus start
+			//nodes which the last search didn't touch are stale, and are left at their reset values instead of being refreshed, so that getting the statistics doesn't modify the matrix
+			const Node *m = AStarMatrix[z].find(index);
+			if (m != nullptr) {
+				s->Direction = m->Direction;
+				s->InGoal = m->InGoal;
+				s->CostFromStart = m->CostFromStart;
+				s->CostToGoal = m->CostToGoal;
+			}
+			//Wyrmgus end
 			++s;
-			++m;
+			//Wyrmgus start
+//			++m;
+			++index;
+			//Wyrmgus end
 		}
 	}
 
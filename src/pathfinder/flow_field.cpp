@@ -0,0 +1,265 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include "stratagus.h"
+
+#include "pathfinder/flow_field.h"
+
+#include "map/map.h"
+#include "map/tile.h"
+#include "pathfinder.h"
+#include "player.h"
+#include "util/point_util.h"
+#include "util/vector_util.h"
+
+namespace wyrmgus {
+
+const flow_field *flow_field::get(const QRect &goal_rect, const int z, const unsigned long movement_mask, const CPlayer *player, const int unit_id)
+{
+	//discard the fields which haven't been requested for a while; this is only checked once per idle period, rather than on every request
+	if (GameCycle < flow_field::last_cleanup_cycle || GameCycle >= flow_field::last_cleanup_cycle + flow_field::max_idle_cycles) {
+		flow_field::remove_idle_fields();
+		flow_field::last_cleanup_cycle = GameCycle;
+	}
+
+	if (AStarKnowUnseenTerrain) {
+		player = nullptr;
+	}
+
+	cache_entry &entry = flow_field::cache[cache_key(z, goal_rect.x(), goal_rect.y(), goal_rect.width(), goal_rect.height(), movement_mask, player != nullptr ? player->Index : -1)];
+	entry.last_request_cycle = GameCycle;
+
+	if (static_cast<int>(entry.requesting_unit_ids.size()) < flow_field::min_requesting_units && !vector::contains(entry.requesting_unit_ids, unit_id)) {
+		entry.requesting_unit_ids.push_back(unit_id);
+	}
+
+	if (entry.field != nullptr && (entry.field->is_dirty() || entry.field->get_creation_cycle() + flow_field::max_age_cycles < GameCycle)) {
+		entry.field.reset();
+	}
+
+	if (entry.field == nullptr && static_cast<int>(entry.requesting_unit_ids.size()) >= flow_field::min_requesting_units) {
+		entry.field = std::make_unique<flow_field>(goal_rect, z, movement_mask, player);
+	}
+
+	return entry.field.get();
+}
+
+void flow_field::remove_idle_fields()
+{
+	for (auto iterator = flow_field::cache.begin(); iterator != flow_field::cache.end();) {
+		if (iterator->second.last_request_cycle + flow_field::max_idle_cycles < GameCycle) {
+			iterator = flow_field::cache.erase(iterator);
+		} else {
+			++iterator;
+		}
+	}
+}
+
+void flow_field::on_tile_changed(const QPoint &tile_pos, const int z)
+{
+	for (const auto &[key, entry] : flow_field::cache) {
+		if (std::get<0>(key) != z || entry.field == nullptr) {
+			continue;
+		}
+
+		entry.field->update_tile(tile_pos);
+	}
+}
+
+flow_field::flow_field(const QRect &goal_rect, const int z, const unsigned long movement_mask, const CPlayer *player)
+	: z(z), movement_mask(movement_mask), player(player), creation_cycle(GameCycle)
+{
+	this->map_width = CMap::Map.Info.MapWidths[z];
+	this->map_height = CMap::Map.Info.MapHeights[z];
+
+	this->distances.resize(this->map_width * this->map_height, -1);
+
+	const QRect map_goal_rect = goal_rect.intersected(QRect(0, 0, this->map_width, this->map_height));
+
+	std::vector<int> goal_indexes;
+	for (int y = map_goal_rect.top(); y <= map_goal_rect.bottom(); ++y) {
+		for (int x = map_goal_rect.left(); x <= map_goal_rect.right(); ++x) {
+			const int index = point::to_index(x, y, this->map_width);
+			this->distances[index] = 0;
+			goal_indexes.push_back(index);
+		}
+	}
+
+	if (!goal_indexes.empty()) {
+		this->propagate(goal_indexes);
+	}
+}
+
+/**
+**	@brief	Get the cost of stepping into a tile
+**
+**	The tile is only fetched once, as its passability and cost both depend on whether it has been explored.
+**
+**	@param	tile_pos	The position of the tile
+**
+**	@return	The cost of the step, or -1 if the tile can't be crossed
+*/
+int flow_field::get_step_cost(const QPoint &tile_pos) const
+{
+	const tile *tile = CMap::Map.Field(tile_pos.x(), tile_pos.y(), this->z);
+
+	//as for the A* pathfinder, obstacles in tiles which haven't been explored are not known, and the tiles are tended against
+	if (this->player != nullptr && !tile->player_info->IsTeamExplored(*this->player)) {
+		return 1 + std::max(0, AStarUnknownTerrainCost);
+	}
+
+	return TilePassableIgnoringMovingUnits(*tile, this->movement_mask) ? 1 : -1;
+}
+
+/**
+**	@brief	Propagate the distances of the field from tiles which all have the same distance
+**
+**	The step costs are small integers, so tiles are processed in buckets by their distance (Dial's algorithm),
+**	which gives the same result as using a priority queue, but at a lower cost.
+**
+**	@param	start_indexes	The indexes of the tiles to propagate the distances from
+*/
+void flow_field::propagate(const std::vector<int> &start_indexes)
+{
+	const int bucket_count = 2 + (this->player != nullptr ? std::max(0, AStarUnknownTerrainCost) : 0);
+	std::vector<std::vector<int>> buckets(bucket_count);
+
+	int current_distance = this->distances[start_indexes.front()];
+	buckets[current_distance % bucket_count] = start_indexes;
+	size_t pending_count = start_indexes.size();
+
+	int min_x = this->map_width;
+	int min_y = this->map_height;
+	int max_x = -1;
+	int max_y = -1;
+
+	while (pending_count > 0) {
+		//the steps from the tiles of this bucket always go into other buckets, as each step costs at least one, and less than the quantity of buckets
+		std::vector<int> &bucket = buckets[current_distance % bucket_count];
+
+		for (const int index : bucket) {
+			--pending_count;
+
+			if (this->distances[index] != current_distance) {
+				//the tile was reached through a cheaper path in the meantime
+				continue;
+			}
+
+			const QPoint tile_pos = point::from_index(index, this->map_width);
+			min_x = std::min(min_x, tile_pos.x());
+			min_y = std::min(min_y, tile_pos.y());
+			max_x = std::max(max_x, tile_pos.x());
+			max_y = std::max(max_y, tile_pos.y());
+
+			for (int i = 0; i < 8; ++i) {
+				const QPoint adjacent_pos(tile_pos.x() + Heading2X[i], tile_pos.y() + Heading2Y[i]);
+
+				if (adjacent_pos.x() < 0 || adjacent_pos.y() < 0 || adjacent_pos.x() >= this->map_width || adjacent_pos.y() >= this->map_height) {
+					continue;
+				}
+
+				const int step_cost = this->get_step_cost(adjacent_pos);
+				if (step_cost == -1) {
+					continue;
+				}
+
+				const int adjacent_index = point::to_index(adjacent_pos, this->map_width);
+				const int adjacent_distance = current_distance + step_cost;
+				int &distance = this->distances[adjacent_index];
+				if (distance != -1 && distance <= adjacent_distance) {
+					continue;
+				}
+
+				distance = adjacent_distance;
+				buckets[adjacent_distance % bucket_count].push_back(adjacent_index);
+				++pending_count;
+			}
+		}
+
+		bucket.clear();
+		++current_distance;
+	}
+
+	if (max_x != -1) {
+		this->reached_rect |= QRect(QPoint(min_x, min_y), QPoint(max_x, max_y));
+	}
+}
+
+/**
+**	@brief	Update the field for a change in the passability of a tile
+**
+**	@param	tile_pos	The position of the tile
+*/
+void flow_field::update_tile(const QPoint &tile_pos)
+{
+	//only the tiles from which the goal can be reached, and the ones next to them, can affect the field
+	if (this->dirty || !this->reached_rect.adjusted(-1, -1, 1, 1).contains(tile_pos)) {
+		return;
+	}
+
+	const int index = point::to_index(tile_pos, this->map_width);
+	const int step_cost = this->get_step_cost(tile_pos);
+	const bool passable = step_cost != -1;
+	int &distance = this->distances[index];
+
+	if (distance != -1) {
+		//goal tiles are reached regardless of their passability
+		if (!passable && distance != 0) {
+			//paths through the tile are no longer possible, which can make the remaining paths longer, so the field needs to be calculated again
+			this->dirty = true;
+		}
+		return;
+	}
+
+	if (!passable) {
+		return;
+	}
+
+	//the tile became passable, so the field can be repaired by propagating from it, if it is next to a tile from which the goal can be reached
+	int best_adjacent_distance = -1;
+	for (int i = 0; i < 8; ++i) {
+		const QPoint adjacent_pos(tile_pos.x() + Heading2X[i], tile_pos.y() + Heading2Y[i]);
+
+		if (adjacent_pos.x() < 0 || adjacent_pos.y() < 0 || adjacent_pos.x() >= this->map_width || adjacent_pos.y() >= this->map_height) {
+			continue;
+		}
+
+		const int adjacent_distance = this->get_distance(adjacent_pos);
+		if (adjacent_distance != -1 && (best_adjacent_distance == -1 || adjacent_distance < best_adjacent_distance)) {
+			best_adjacent_distance = adjacent_distance;
+		}
+	}
+
+	if (best_adjacent_distance == -1) {
+		return;
+	}
+
+	distance = best_adjacent_distance + step_cost;
+	this->propagate({index});
+}
+
+}
@@ -0,0 +1,116 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+class CPlayer;
+
+namespace wyrmgus {
+
+/**
+**  Integration field with the cost of the path from each tile of a map layer to a goal, for a given movement mask.
+**
+**  When many units are ordered to go to the same goal (e.g. a group move order, or an AI force attacking or retargeting), the field is calculated once and shared by all of them,
+**  instead of each unit performing its own path search. Units then follow the field's gradient towards the goal.
+**
+**  As for the A* pathfinder, the terrain of tiles which the player's team hasn't explored is not known, so such tiles are considered passable, but cost more to cross.
+**
+**  Fields are only created once more than one unit has requested a path to the same goal, and are discarded after not being used for a while.
+**  Repeated requests from a single unit (e.g. when it recalculates its path) don't count, as it alone wouldn't benefit from sharing a field.
+**  When a tile becomes passable, the fields which reached its surroundings are repaired from it; when a tile which a field reached becomes impassable, the field is calculated again on its next request.
+*/
+class flow_field final
+{
+public:
+	static constexpr int min_requesting_units = 2; //the amount of different units requesting the same goal needed for a field to be calculated
+	static constexpr int max_idle_cycles = CYCLES_PER_SECOND * 2; //cycles after the last request after which a field is discarded
+	static constexpr int max_age_cycles = CYCLES_PER_SECOND * 10; //cycles after which a field is calculated again, so that it takes newly explored terrain into account
+
+	/// Get the field for a goal, registering a request for it by a unit; returns null if there is no field (yet) for the goal
+	static const flow_field *get(const QRect &goal_rect, const int z, const unsigned long movement_mask, const CPlayer *player, const int unit_id);
+
+	static void clear()
+	{
+		flow_field::cache.clear();
+		flow_field::last_cleanup_cycle = 0;
+	}
+
+	/// Update the fields of a map layer, as the passability of one of its tiles may have changed
+	static void on_tile_changed(const QPoint &tile_pos, const int z);
+
+private:
+	static void remove_idle_fields();
+
+	struct cache_entry final
+	{
+		std::unique_ptr<flow_field> field;
+		unsigned long last_request_cycle = 0;
+		std::vector<int> requesting_unit_ids; //the different units which have requested the field, only tracked until there are enough of them for it to be calculated
+	};
+
+	using cache_key = std::tuple<int, int, int, int, int, unsigned long, int>; //map layer, goal x, goal y, goal width, goal height, movement mask, player index (-1 if the terrain of unexplored tiles is known)
+
+	static inline std::map<cache_key, cache_entry> cache;
+	static inline unsigned long last_cleanup_cycle = 0;
+
+public:
+	explicit flow_field(const QRect &goal_rect, const int z, const unsigned long movement_mask, const CPlayer *player);
+
+	/// Get the cost of the path from a tile to the goal, or -1 if the goal can't be reached from it
+	int get_distance(const QPoint &tile_pos) const
+	{
+		return this->distances[tile_pos.x() + tile_pos.y() * this->map_width];
+	}
+
+	bool is_dirty() const
+	{
+		return this->dirty;
+	}
+
+	unsigned long get_creation_cycle() const
+	{
+		return this->creation_cycle;
+	}
+
+private:
+	int get_step_cost(const QPoint &tile_pos) const;
+	void propagate(const std::vector<int> &start_indexes);
+	void update_tile(const QPoint &tile_pos);
+
+private:
+	const int z = 0;
+	const unsigned long movement_mask = 0;
+	const CPlayer *player = nullptr; //the player whose explored tiles are used, or null if the terrain of unexplored tiles is known
+	int map_width = 0;
+	int map_height = 0;
+	std::vector<int> distances;
+	QRect reached_rect; //the bounding rectangle of the tiles from which the goal can be reached
+	bool dirty = false;
+	unsigned long creation_cycle = 0;
+};
+
+}
@@ -0,0 +1,436 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include "stratagus.h"
+
+#include "pathfinder/path_cluster_graph.h"
+
+#include "map/map.h"
+#include "map/map_layer.h"
+#include "map/tile.h"
+#include "map/tile_visibility.h"
+#include "pathfinder.h"
+#include "player.h"
+#include "util/point_util.h"
+#include "util/vector_util.h"
+
+namespace wyrmgus {
+
+static_assert(path_cluster_graph::cluster_size == tile_visibility::explored_block_size, "The clusters must match the explored blocks of the tile visibility data, so that their explored tiles are counted.");
+
+static int get_chebyshev_distance(const QPoint &pos, const QPoint &other_pos)
+{
+	return std::max(std::abs(pos.x() - other_pos.x()), std::abs(pos.y() - other_pos.y()));
+}
+
+path_cluster_graph *path_cluster_graph::get(const int z, const unsigned long movement_mask)
+{
+	if (z >= static_cast<int>(path_cluster_graph::graphs.size())) {
+		path_cluster_graph::graphs.resize(z + 1);
+	}
+
+	std::unique_ptr<path_cluster_graph> &graph = path_cluster_graph::graphs[z][movement_mask];
+	if (graph == nullptr) {
+		graph = std::make_unique<path_cluster_graph>(z, movement_mask);
+	}
+
+	return graph.get();
+}
+
+void path_cluster_graph::on_tile_changed(const QPoint &tile_pos, const int z)
+{
+	if (z >= static_cast<int>(path_cluster_graph::graphs.size())) {
+		return;
+	}
+
+	for (const auto &kv_pair : path_cluster_graph::graphs[z]) {
+		kv_pair.second->set_tile_dirty(tile_pos);
+	}
+}
+
+path_cluster_graph::path_cluster_graph(const int z, const unsigned long movement_mask) : z(z), movement_mask(movement_mask)
+{
+	this->map_width = CMap::Map.Info.MapWidths[z];
+	this->map_height = CMap::Map.Info.MapHeights[z];
+	this->cluster_columns = (this->map_width + path_cluster_graph::cluster_size - 1) / path_cluster_graph::cluster_size;
+	this->cluster_rows = (this->map_height + path_cluster_graph::cluster_size - 1) / path_cluster_graph::cluster_size;
+	this->clusters.resize(this->cluster_columns * this->cluster_rows);
+}
+
+void path_cluster_graph::set_tile_dirty(const QPoint &tile_pos)
+{
+	const int cluster_x = tile_pos.x() / path_cluster_graph::cluster_size;
+	const int cluster_y = tile_pos.y() / path_cluster_graph::cluster_size;
+	const int cluster_index = this->get_cluster_index(tile_pos);
+
+	this->clusters[cluster_index].dirty = true;
+
+	//the entrances of a border depend on the tiles at both of its sides, so a change in a border tile affects the neighboring cluster as well
+	const int local_x = tile_pos.x() % path_cluster_graph::cluster_size;
+	const int local_y = tile_pos.y() % path_cluster_graph::cluster_size;
+
+	if (local_x == 0 && cluster_x > 0) {
+		this->clusters[cluster_index - 1].dirty = true;
+	} else if (local_x == path_cluster_graph::cluster_size - 1 && cluster_x < this->cluster_columns - 1) {
+		this->clusters[cluster_index + 1].dirty = true;
+	}
+
+	if (local_y == 0 && cluster_y > 0) {
+		this->clusters[cluster_index - this->cluster_columns].dirty = true;
+	} else if (local_y == path_cluster_graph::cluster_size - 1 && cluster_y < this->cluster_rows - 1) {
+		this->clusters[cluster_index + this->cluster_columns].dirty = true;
+	}
+}
+
+std::vector<QPoint> path_cluster_graph::find_path(const QPoint &start_pos, const QPoint &goal_pos)
+{
+	static constexpr uint64_t start_node_id = UINT64_MAX - 1;
+	static constexpr uint64_t goal_node_id = UINT64_MAX;
+
+	const int start_cluster_index = this->get_cluster_index(start_pos);
+	const int goal_cluster_index = this->get_cluster_index(goal_pos);
+
+	if (start_cluster_index == goal_cluster_index) {
+		return {};
+	}
+
+	const auto to_node_id = [](const int cluster_index, const int node_index) {
+		return (static_cast<uint64_t>(cluster_index) << 32) | static_cast<uint64_t>(node_index);
+	};
+
+	//the cost of the path from each node of the goal's cluster to the goal itself
+	const cluster &goal_cluster = this->get_cluster(goal_cluster_index);
+	const QRect goal_cluster_rect = this->get_cluster_rect(goal_cluster_index);
+	const std::vector<int> goal_distances = this->calculate_distances(goal_cluster_rect, goal_pos);
+	std::vector<int> goal_costs;
+	for (const node &node : goal_cluster.nodes) {
+		goal_costs.push_back(goal_distances[point::to_index(node.tile_pos - goal_cluster_rect.topLeft(), goal_cluster_rect.width())]);
+	}
+
+	//open set entries: estimated total cost, cost from the start, node ID; ordered so that the search is deterministic
+	using open_entry = std::tuple<int, int, uint64_t>;
+	std::priority_queue<open_entry, std::vector<open_entry>, std::greater<open_entry>> open_set;
+	std::map<uint64_t, int> costs_from_start;
+	std::map<uint64_t, uint64_t> parents;
+
+	const auto add_to_open_set = [&](const uint64_t node_id, const uint64_t parent_id, const QPoint &tile_pos, const int cost) {
+		const auto find_iterator = costs_from_start.find(node_id);
+		if (find_iterator != costs_from_start.end() && find_iterator->second <= cost) {
+			return;
+		}
+
+		costs_from_start[node_id] = cost;
+		parents[node_id] = parent_id;
+		open_set.emplace(cost + get_chebyshev_distance(tile_pos, goal_pos), cost, node_id);
+	};
+
+	const cluster &start_cluster = this->get_cluster(start_cluster_index);
+	const QRect start_cluster_rect = this->get_cluster_rect(start_cluster_index);
+	const std::vector<int> start_distances = this->calculate_distances(start_cluster_rect, start_pos);
+	for (size_t i = 0; i < start_cluster.nodes.size(); ++i) {
+		const node &node = start_cluster.nodes[i];
+		const int distance = start_distances[point::to_index(node.tile_pos - start_cluster_rect.topLeft(), start_cluster_rect.width())];
+		if (distance >= 0) {
+			add_to_open_set(to_node_id(start_cluster_index, static_cast<int>(i)), start_node_id, node.tile_pos, distance);
+		}
+	}
+
+	while (!open_set.empty()) {
+		const int cost = std::get<1>(open_set.top());
+		const uint64_t node_id = std::get<2>(open_set.top());
+		open_set.pop();
+
+		if (cost > costs_from_start[node_id]) {
+			continue; //outdated entry
+		}
+
+		if (node_id == goal_node_id) {
+			std::vector<QPoint> waypoints;
+			waypoints.push_back(goal_pos);
+
+			for (uint64_t parent_id = parents[goal_node_id]; parent_id != start_node_id; parent_id = parents[parent_id]) {
+				const int cluster_index = static_cast<int>(parent_id >> 32);
+				const int node_index = static_cast<int>(parent_id & 0xFFFFFFFF);
+				waypoints.push_back(this->clusters[cluster_index].nodes[node_index].tile_pos);
+			}
+
+			std::reverse(waypoints.begin(), waypoints.end());
+			return waypoints;
+		}
+
+		const int cluster_index = static_cast<int>(node_id >> 32);
+		const int node_index = static_cast<int>(node_id & 0xFFFFFFFF);
+		const node &node = this->clusters[cluster_index].nodes[node_index];
+
+		if (cluster_index == goal_cluster_index && goal_costs[node_index] >= 0) {
+			add_to_open_set(goal_node_id, node_id, goal_pos, cost + goal_costs[node_index]);
+		}
+
+		for (const auto &[other_node_index, edge_cost] : node.edges) {
+			add_to_open_set(to_node_id(cluster_index, other_node_index), node_id, this->clusters[cluster_index].nodes[other_node_index].tile_pos, cost + edge_cost);
+		}
+
+		for (const QPoint &exit_pos : node.exits) {
+			const int exit_cluster_index = this->get_cluster_index(exit_pos);
+			const int exit_node_index = path_cluster_graph::find_node_index(this->get_cluster(exit_cluster_index), exit_pos);
+			if (exit_node_index == -1) {
+				continue;
+			}
+
+			add_to_open_set(to_node_id(exit_cluster_index, exit_node_index), node_id, exit_pos, cost + 1);
+		}
+	}
+
+	return {};
+}
+
+/**
+**	@brief	Get whether a player's team has explored all tiles of the clusters which a path through the graph goes through
+**
+**	The graph is built from the actual terrain, so it should only be used for paths through terrain which the player's team knows,
+**	as the A* pathfinder doesn't make use of the terrain of unexplored tiles either.
+**	The explored tile counts kept for each cluster by the tile visibility data are checked first, so that the tiles of a cluster only need to be gone through
+**	when it has been explored in parts by different members of the player's team.
+**
+**	@param	start_pos	The start of the path
+**	@param	waypoints	The waypoints of the path
+**	@param	player		The player
+**
+**	@return	True if the clusters of the start and of each waypoint have been fully explored, or false otherwise
+*/
+bool path_cluster_graph::is_path_explored(const QPoint &start_pos, const std::vector<QPoint> &waypoints, const CPlayer &player) const
+{
+	std::vector<int> checked_cluster_indexes;
+
+	const tile_visibility *visibility = CMap::Map.MapLayers[this->z]->get_visibility();
+	const player_mask team_mask = player.get_mutual_shared_vision_mask() | get_player_mask(player.Index);
+	const bool has_revealed_players = !CPlayer::get_revealed_players().empty();
+
+	const auto is_cluster_explored = [this, &checked_cluster_indexes, &player, visibility, team_mask, has_revealed_players](const QPoint &tile_pos) {
+		const int cluster_index = this->get_cluster_index(tile_pos);
+		if (vector::contains(checked_cluster_indexes, cluster_index)) {
+			return true;
+		}
+
+		checked_cluster_indexes.push_back(cluster_index);
+
+		const QRect cluster_rect = this->get_cluster_rect(cluster_index);
+		const int cluster_tile_count = cluster_rect.width() * cluster_rect.height();
+
+		//a cluster fully explored by any member of the team is explored, while one whose explored tiles can't add up to the whole cluster is not
+		int explored_count_sum = 0;
+		for (player_mask mask = team_mask; mask != 0; mask &= mask - 1) {
+			const int explored_count = visibility->get_block_explored_count(std::countr_zero(mask), cluster_index);
+			if (explored_count == cluster_tile_count) {
+				return true;
+			}
+
+			explored_count_sum += explored_count;
+		}
+
+		//the tiles currently seen by revealed players count as explored as well
+		if (explored_count_sum < cluster_tile_count && !has_revealed_players) {
+			return false;
+		}
+
+		for (int y = cluster_rect.top(); y <= cluster_rect.bottom(); ++y) {
+			for (int x = cluster_rect.left(); x <= cluster_rect.right(); ++x) {
+				if (!CMap::Map.Field(x, y, this->z)->player_info->IsTeamExplored(player)) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	};
+
+	if (!is_cluster_explored(start_pos)) {
+		return false;
+	}
+
+	for (const QPoint &waypoint : waypoints) {
+		if (!is_cluster_explored(waypoint)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+QRect path_cluster_graph::get_cluster_rect(const int cluster_index) const
+{
+	const QPoint top_left((cluster_index % this->cluster_columns) * path_cluster_graph::cluster_size, (cluster_index / this->cluster_columns) * path_cluster_graph::cluster_size);
+	const QPoint bottom_right(std::min(top_left.x() + path_cluster_graph::cluster_size, this->map_width) - 1, std::min(top_left.y() + path_cluster_graph::cluster_size, this->map_height) - 1);
+	return QRect(top_left, bottom_right);
+}
+
+const path_cluster_graph::cluster &path_cluster_graph::get_cluster(const int cluster_index)
+{
+	if (this->clusters[cluster_index].dirty) {
+		this->update_cluster(cluster_index);
+	}
+
+	return this->clusters[cluster_index];
+}
+
+void path_cluster_graph::update_cluster(const int cluster_index)
+{
+	cluster &cluster = this->clusters[cluster_index];
+	cluster.nodes.clear();
+
+	const QRect rect = this->get_cluster_rect(cluster_index);
+
+	if (rect.top() > 0) {
+		this->add_border_entrances(cluster, rect.topLeft(), QPoint(1, 0), rect.width(), QPoint(0, -1));
+	}
+	if (rect.bottom() < this->map_height - 1) {
+		this->add_border_entrances(cluster, rect.bottomLeft(), QPoint(1, 0), rect.width(), QPoint(0, 1));
+	}
+	if (rect.left() > 0) {
+		this->add_border_entrances(cluster, rect.topLeft(), QPoint(0, 1), rect.height(), QPoint(-1, 0));
+	}
+	if (rect.right() < this->map_width - 1) {
+		this->add_border_entrances(cluster, rect.topRight(), QPoint(0, 1), rect.height(), QPoint(1, 0));
+	}
+
+	for (size_t i = 0; i < cluster.nodes.size(); ++i) {
+		node &node = cluster.nodes[i];
+		const std::vector<int> distances = this->calculate_distances(rect, node.tile_pos);
+
+		for (size_t j = 0; j < cluster.nodes.size(); ++j) {
+			if (i == j) {
+				continue;
+			}
+
+			const int distance = distances[point::to_index(cluster.nodes[j].tile_pos - rect.topLeft(), rect.width())];
+			if (distance > 0) {
+				node.edges.emplace_back(static_cast<int>(j), distance);
+			}
+		}
+	}
+
+	cluster.dirty = false;
+}
+
+void path_cluster_graph::add_border_entrances(cluster &cluster, const QPoint &start_pos, const QPoint &direction, const int length, const QPoint &outward_offset) const
+{
+	const auto add_node = [&cluster](const QPoint &tile_pos, const QPoint &exit_pos) {
+		int node_index = path_cluster_graph::find_node_index(cluster, tile_pos);
+		if (node_index == -1) {
+			node_index = static_cast<int>(cluster.nodes.size());
+			cluster.nodes.emplace_back(tile_pos);
+		}
+
+		cluster.nodes[node_index].exits.push_back(exit_pos);
+	};
+
+	//the runs are calculated in the same order from both sides of the border, so that the neighboring cluster places its nodes at the matching tiles
+	int run_start = -1;
+	for (int i = 0; i <= length; ++i) {
+		const QPoint tile_pos = start_pos + direction * i;
+		const bool open = i < length && TilePassableIgnoringMovingUnits(tile_pos, this->z, this->movement_mask) && TilePassableIgnoringMovingUnits(tile_pos + outward_offset, this->z, this->movement_mask);
+
+		if (open) {
+			if (run_start == -1) {
+				run_start = i;
+			}
+			continue;
+		}
+
+		if (run_start == -1) {
+			continue;
+		}
+
+		const int run_end = i - 1;
+		if ((run_end - run_start + 1) >= path_cluster_graph::long_entrance_length) {
+			const QPoint run_start_pos = start_pos + direction * run_start;
+			const QPoint run_end_pos = start_pos + direction * run_end;
+			add_node(run_start_pos, run_start_pos + outward_offset);
+			add_node(run_end_pos, run_end_pos + outward_offset);
+		} else {
+			const QPoint run_middle_pos = start_pos + direction * ((run_start + run_end) / 2);
+			add_node(run_middle_pos, run_middle_pos + outward_offset);
+		}
+
+		run_start = -1;
+	}
+}
+
+/**
+**  Calculate the length of the shortest path from a tile to each tile of a rectangle, without leaving it.
+**
+**  @param rect       The rectangle to search, in map coordinates.
+**  @param start_pos  The starting tile, which is always considered reachable.
+**
+**  @return  The distance to each tile of the rectangle (indexed relative to it), or -1 for unreachable tiles.
+*/
+std::vector<int> path_cluster_graph::calculate_distances(const QRect &rect, const QPoint &start_pos) const
+{
+	std::vector<int> distances(rect.width() * rect.height(), -1);
+	std::queue<QPoint> queue;
+
+	distances[point::to_index(start_pos - rect.topLeft(), rect.width())] = 0;
+	queue.push(start_pos);
+
+	while (!queue.empty()) {
+		const QPoint tile_pos = queue.front();
+		queue.pop();
+
+		const int distance = distances[point::to_index(tile_pos - rect.topLeft(), rect.width())];
+
+		for (int i = 0; i < 8; ++i) {
+			const QPoint adjacent_pos(tile_pos.x() + Heading2X[i], tile_pos.y() + Heading2Y[i]);
+
+			if (!rect.contains(adjacent_pos)) {
+				continue;
+			}
+
+			int &adjacent_distance = distances[point::to_index(adjacent_pos - rect.topLeft(), rect.width())];
+			if (adjacent_distance != -1 || !TilePassableIgnoringMovingUnits(adjacent_pos, this->z, this->movement_mask)) {
+				continue;
+			}
+
+			adjacent_distance = distance + 1;
+			queue.push(adjacent_pos);
+		}
+	}
+
+	return distances;
+}
+
+int path_cluster_graph::find_node_index(const cluster &cluster, const QPoint &tile_pos)
+{
+	for (size_t i = 0; i < cluster.nodes.size(); ++i) {
+		if (cluster.nodes[i].tile_pos == tile_pos) {
+			return static_cast<int>(i);
+		}
+	}
+
+	return -1;
+}
+
+}
@@ -0,0 +1,114 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+class CPlayer;
+
+namespace wyrmgus {
+
+/**
+**  Abstract graph of the map clusters of a map layer and the entrances between them, for a given movement mask.
+**
+**  The map layer is divided into square clusters; each maximal run of passable tiles along a border between two clusters gives one or two entrances, whose tiles are the nodes of the graph.
+**  Nodes in the same cluster are connected by the length of the shortest path between them inside the cluster, and each entrance connects the two clusters with a cost of one step.
+**  A long-distance path can then be found by searching this small graph, and then refined by a local search to the next waypoint.
+**
+**  Only terrain and fixed units (such as buildings) are considered for passability; moving units are left for the local search to handle.
+*/
+class path_cluster_graph final
+{
+public:
+	static constexpr int cluster_size = 16;
+	static constexpr int long_entrance_length = 6; //entrances of at least this length get a node at each of their ends, instead of one in their middle
+
+	static path_cluster_graph *get(const int z, const unsigned long movement_mask);
+
+	static void clear()
+	{
+		path_cluster_graph::graphs.clear();
+	}
+
+	/// Notify the graphs of a map layer that the passability of a tile may have changed
+	static void on_tile_changed(const QPoint &tile_pos, const int z);
+
+private:
+	static inline std::vector<std::map<unsigned long, std::unique_ptr<path_cluster_graph>>> graphs; //graphs per map layer and movement mask
+
+public:
+	explicit path_cluster_graph(const int z, const unsigned long movement_mask);
+
+	void set_tile_dirty(const QPoint &tile_pos);
+
+	/// Find a path between the two tiles through the cluster graph, returning its waypoints (ending with the goal), or an empty vector if both are in the same cluster or there is no path
+	std::vector<QPoint> find_path(const QPoint &start_pos, const QPoint &goal_pos);
+
+	/// Get whether a player's team has explored all tiles of the clusters which a path through the graph goes through
+	bool is_path_explored(const QPoint &start_pos, const std::vector<QPoint> &waypoints, const CPlayer &player) const;
+
+private:
+	struct node final
+	{
+		explicit node(const QPoint &tile_pos) : tile_pos(tile_pos)
+		{
+		}
+
+		QPoint tile_pos;
+		std::vector<QPoint> exits; //tiles in neighboring clusters which can be entered from this node
+		std::vector<std::pair<int, int>> edges; //the index of other nodes of the same cluster, and the cost of the path to them
+	};
+
+	struct cluster final
+	{
+		bool dirty = true;
+		std::vector<node> nodes;
+	};
+
+	int get_cluster_index(const QPoint &tile_pos) const
+	{
+		return (tile_pos.x() / path_cluster_graph::cluster_size) + (tile_pos.y() / path_cluster_graph::cluster_size) * this->cluster_columns;
+	}
+
+	QRect get_cluster_rect(const int cluster_index) const;
+	const cluster &get_cluster(const int cluster_index);
+	void update_cluster(const int cluster_index);
+	void add_border_entrances(cluster &cluster, const QPoint &start_pos, const QPoint &direction, const int length, const QPoint &outward_offset) const;
+	std::vector<int> calculate_distances(const QRect &rect, const QPoint &start_pos) const;
+
+	static int find_node_index(const cluster &cluster, const QPoint &tile_pos);
+
+private:
+	const int z = 0;
+	const unsigned long movement_mask = 0;
+	int map_width = 0;
+	int map_height = 0;
+	int cluster_columns = 0;
+	int cluster_rows = 0;
+	std::vector<cluster> clusters;
+};
+
+}
@@ -38,6 +38,8 @@
 #include "map/map_layer.h"
 #include "map/tile.h"
 #include "map/tileset.h"
+#include "pathfinder/flow_field.h"
+#include "pathfinder/path_cluster_graph.h"
 #include "unit/unit.h"
 #include "unit/unit_type.h"
 #include "util/size_util.h"
@@ -69,6 +71,11 @@ extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, in
 --  Variables
 ----------------------------------------------------------------------------*/
 
+/// paths to goals farther than this (beyond the goal range) are searched for through the cluster graph first
+static constexpr int HierarchicalPathMinDistance = wyrmgus::path_cluster_graph::cluster_size * 2;
+/// how far a long-distance path's next waypoint may be from the unit
+static constexpr int HierarchicalPathRefinementDistance = wyrmgus::path_cluster_graph::cluster_size * 2;
+
 void TerrainTraversal::SetSize(unsigned int width, unsigned int height)
 {
 	m_values.resize((width + 2) * (height + 2));
@@ -266,6 +273,55 @@ void InitPathfinder()
 void FreePathfinder()
 {
 	FreeAStar();
+	wyrmgus::path_cluster_graph::clear();
+	wyrmgus::flow_field::clear();
+}
+
+/**
+**  Notify the pathfinder that the passability of a tile may have changed, so that its cached data can be updated.
+**
+**  @param pos  Map tile position.
+**  @param z    Map layer.
+*/
+void PathfinderTileChanged(const Vec2i &pos, int z)
+{
+	wyrmgus::path_cluster_graph::on_tile_changed(pos, z);
+	wyrmgus::flow_field::on_tile_changed(pos, z);
+}
+
+/**
+**  Check whether a tile can be crossed with a movement mask, counting terrain and fixed units (such as buildings) as obstacles, but not moving units.
+**
+**  @param pos            Map tile position.
+**  @param z              Map layer.
+**  @param movement_mask  The movement mask of the unit type.
+**
+**  @return               True if the tile is passable.
+*/
+bool TilePassableIgnoringMovingUnits(const Vec2i &pos, int z, unsigned long movement_mask)
+{
+	return TilePassableIgnoringMovingUnits(*CMap::Map.Field(pos, z), movement_mask);
+}
+
+/**
+**  Check whether a tile can be crossed with a movement mask, for callers which have already fetched the tile.
+**
+**  @param tile           The map tile.
+**  @param movement_mask  The movement mask of the unit type.
+**
+**  @return               True if the tile is passable.
+*/
+bool TilePassableIgnoringMovingUnits(const wyrmgus::tile &tile, unsigned long movement_mask)
+{
+	//as in the A* pathfinder, don't count MapFieldWaterAllowed and MapFieldCoastAllowed if there is a bridge present
+	unsigned long flags = tile.Flags;
+	if (flags & MapFieldBridge) {
+		flags &= ~(MapFieldWaterAllowed | MapFieldCoastAllowed);
+	}
+
+	flags &= movement_mask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit);
+
+	return flags == 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -463,6 +519,156 @@ PathFinderOutput::PathFinderOutput()
 	memset(this, 0, sizeof(*this));
 }
 
+/**
+**  Find a path for a unit by following the flow field shared by all units whose orders have the same goal (e.g. group move orders, or AI forces attacking a target).
+**
+**  @param input    The pathfinder input of the unit.
+**  @param path     Filled with the directions of the path, starting from its end.
+**  @param pathlen  The maximum length of the path.
+**
+**  @return         The length of the path, or PF_FAILED if it should be searched for with the A* pathfinder instead.
+*/
+static int FindFlowFieldPath(const PathFinderInput &input, char *path, int pathlen)
+{
+	const CUnit &unit = *input.GetUnit();
+	const Vec2i &start_pos = input.GetUnitPos();
+	const Vec2i &goal_pos = input.GetGoalPos();
+	const int z = input.GetGoalMapLayer();
+
+	//the field gives the distance to the goal itself, so it can't be used to keep a minimum range from it
+	if (path == nullptr || input.GetMinRange() != 0) {
+		return PF_FAILED;
+	}
+
+	if (unit.MapLayer->ID != z || unit.Type->get_tile_size() != QSize(1, 1) || unit.Type->BoolFlag[RAIL_INDEX].value) {
+		return PF_FAILED;
+	}
+
+	const QRect goal_rect(goal_pos, QSize(std::max(input.GetGoalSize().x, 1), std::max(input.GetGoalSize().y, 1)));
+	const int max_range = input.GetMaxRange();
+
+	const auto get_goal_rect_distance = [&goal_rect](const Vec2i &pos) {
+		const int x_distance = std::max({goal_rect.left() - pos.x, pos.x - goal_rect.right(), 0});
+		const int y_distance = std::max({goal_rect.top() - pos.y, pos.y - goal_rect.bottom(), 0});
+		return std::max(x_distance, y_distance);
+	};
+
+	//leave the last steps to the A* pathfinder, which knows how to handle the goal range
+	if (get_goal_rect_distance(start_pos) <= max_range + 1) {
+		return PF_FAILED;
+	}
+
+	//the field only takes into account the terrain the unit's player knows about, unless all of it is known to the pathfinder
+	const wyrmgus::flow_field *field = wyrmgus::flow_field::get(goal_rect, z, unit.Type->MovementMask, unit.Player, unit.UnitManagerData.GetUnitId());
+	if (field == nullptr || field->get_distance(start_pos) <= 0) {
+		return PF_FAILED;
+	}
+
+	//follow the gradient of the field; only the first step needs to be free of other units, as the path is recalculated if a later one is blocked
+	char directions[PathFinderOutput::MAX_PATH_LENGTH];
+	int length = 0;
+	Vec2i pos = start_pos;
+	while (length < pathlen && length < PathFinderOutput::MAX_PATH_LENGTH && field->get_distance(pos) > 0 && get_goal_rect_distance(pos) > max_range) {
+		int best_direction = -1;
+		int best_distance = field->get_distance(pos);
+
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i adjacent_pos(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+
+			if (!CMap::Map.Info.IsPointOnMap(adjacent_pos, z)) {
+				continue;
+			}
+
+			const int adjacent_distance = field->get_distance(adjacent_pos);
+			if (adjacent_distance == -1 || adjacent_distance >= best_distance) {
+				continue;
+			}
+
+			if (length == 0 && !UnitCanBeAt(unit, adjacent_pos, z)) {
+				continue;
+			}
+
+			best_direction = i;
+			best_distance = adjacent_distance;
+		}
+
+		if (best_direction == -1) {
+			break;
+		}
+
+		directions[length++] = best_direction;
+		pos.x += Heading2X[best_direction];
+		pos.y += Heading2Y[best_direction];
+	}
+
+	if (length == 0) {
+		return PF_FAILED;
+	}
+
+	//the path is stored from its end, as in the A* pathfinder
+	for (int i = 0; i < length; ++i) {
+		path[length - 1 - i] = directions[i];
+	}
+
+	return length;
+}
+
+/**
+**  Find the next waypoint of a long-distance path, by searching the cluster graph of the map layer.
+**
+**  @param input     The pathfinder input of the unit.
+**  @param waypoint  Set to the waypoint which the unit should move to next.
+**
+**  @return          True if a waypoint was found, or false if the path should be searched for directly.
+*/
+static bool FindPathWaypoint(const PathFinderInput &input, Vec2i &waypoint)
+{
+	const CUnit &unit = *input.GetUnit();
+	const Vec2i &start_pos = input.GetUnitPos();
+	const Vec2i &goal_pos = input.GetGoalPos();
+	const int z = input.GetGoalMapLayer();
+
+	//only single-tile units use the cluster graph, and rail units can't move diagonally as the graph assumes
+	if (unit.MapLayer->ID != z || unit.Type->get_tile_size() != QSize(1, 1) || unit.Type->BoolFlag[RAIL_INDEX].value) {
+		return false;
+	}
+
+	const int distance = std::max(abs(goal_pos.x - start_pos.x), abs(goal_pos.y - start_pos.y));
+	if (distance <= input.GetMaxRange() + HierarchicalPathMinDistance) {
+		return false;
+	}
+
+	wyrmgus::path_cluster_graph *graph = wyrmgus::path_cluster_graph::get(z, unit.Type->MovementMask);
+	const std::vector<QPoint> waypoints = graph->find_path(start_pos, goal_pos);
+	if (waypoints.size() < 2) {
+		//no path through the cluster graph, or only the goal itself
+		return false;
+	}
+
+	//the cluster graph knows the actual terrain, so if the path goes through terrain which the unit's team hasn't explored, search for it directly instead
+	if (!AStarKnowUnseenTerrain && !graph->is_path_explored(start_pos, waypoints, *unit.Player)) {
+		return false;
+	}
+
+	//move to the farthest waypoint which is still within the refinement distance, but never to the goal itself, since its range and size are not taken into account here
+	bool found = false;
+	for (size_t i = 0; i < waypoints.size() - 1; ++i) {
+		const int waypoint_distance = std::max(abs(waypoints[i].x() - start_pos.x), abs(waypoints[i].y() - start_pos.y));
+		if (waypoint_distance == 0) {
+			continue;
+		}
+
+		if (found && waypoint_distance > HierarchicalPathRefinementDistance) {
+			break;
+		}
+
+		waypoint = waypoints[i];
+		found = true;
+	}
+
+	return found;
+}
+
 /**
 **  Find new path.
 **
@@ -479,7 +685,25 @@ PathFinderOutput::PathFinderOutput()
 static int NewPath(PathFinderInput &input, PathFinderOutput &output)
 {
 	char *path = output.Path;
-	int i = AStarFindPath(input.GetUnitPos(),
+	//Wyrmgus start
+	int i = FindFlowFieldPath(input, path, PathFinderOutput::MAX_PATH_LENGTH);
+
+	//for long-distance paths, only search up to the next waypoint of the path through the cluster graph
+	Vec2i waypoint;
+	if (i == PF_FAILED && FindPathWaypoint(input, waypoint)) {
+		i = AStarFindPath(input.GetUnitPos(), waypoint, 1, 1,
+						  input.GetUnitSize().x, input.GetUnitSize().y,
+						  0, 0, path, PathFinderOutput::MAX_PATH_LENGTH,
+						  *input.GetUnit(), 0, input.GetGoalMapLayer());
+		if (i <= 0) {
+			//the waypoint couldn't be reached, fall back to searching for the whole path
+			i = PF_FAILED;
+		}
+	}
+
+	if (i == PF_FAILED) {
+	//Wyrmgus end
+	i = AStarFindPath(input.GetUnitPos(),
 						  input.GetGoalPos(),
 						  input.GetGoalSize().x, input.GetGoalSize().y,
 						  input.GetUnitSize().x, input.GetUnitSize().y,
@@ -489,6 +713,9 @@ static int NewPath(PathFinderInput &input, PathFinderOutput &output)
 //						  *input.GetUnit());
 						  *input.GetUnit(), 0, input.GetGoalMapLayer());
 						  //Wyrmgus end
+	//Wyrmgus start
+	}
+	//Wyrmgus end
 	input.PathRacalculated();
 	if (i == PF_FAILED) {
 		i = PF_UNREACHABLE;
@@ -48,6 +48,11 @@ public:
 		return player->get_age() == this->age;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::player_identity;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -48,6 +48,8 @@ public:
 	virtual bool check(const CPlayer *player, bool ignore_units = false) const override;
 	virtual bool check(const CUnit *unit, bool ignore_units = false) const override;
 
+	virtual condition_dependency get_dependencies() const override;
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		std::string str = "All of these must be true:\n";
@@ -48,6 +48,12 @@ public:
 		return false;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		//whether players are alive depends on their units
+		return scope_condition_base::get_dependencies() | condition_dependency::units;
+	}
+
 	virtual std::string get_scope_name() const override
 	{
 		return "Any other player";
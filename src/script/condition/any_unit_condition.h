@@ -56,6 +56,12 @@ public:
 		return this->check_scope(unit, ignore_units);
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		//whether units are usable depends on their current orders and on whether they are inside containers, which is not tracked
+		return condition_dependency::all;
+	}
+
 	virtual std::string get_scope_name() const override
 	{
 		return "Any unit";
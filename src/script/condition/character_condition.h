@@ -55,6 +55,11 @@ public:
 		return unit->Character == this->character;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::units;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -48,6 +48,11 @@ public:
 		return character->get_unit() != nullptr;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::units;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -147,6 +147,28 @@ std::unique_ptr<const condition> condition::from_sml_scope(const sml_data &scope
 	return condition;
 }
 
+void condition::on_state_changed(const condition_dependency dependencies)
+{
+	++condition::state_change_count;
+
+	for (int i = 0; i < condition::dependency_count; ++i) {
+		if ((dependencies & static_cast<condition_dependency>(1 << i)) != condition_dependency::none) {
+			condition::dependency_change_counts[i] = condition::state_change_count;
+		}
+	}
+}
+
+bool condition::has_state_changed_since(const condition_dependency dependencies, const uint64_t change_count)
+{
+	for (int i = 0; i < condition::dependency_count; ++i) {
+		if ((dependencies & static_cast<condition_dependency>(1 << i)) != condition_dependency::none && condition::dependency_change_counts[i] > change_count) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void condition::ProcessConfigData(const CConfigData *config_data)
 {
 	for (size_t i = 0; i < config_data->Properties.size(); ++i) {
@@ -222,6 +244,17 @@ void and_condition::check_validity() const
 	}
 }
 
+condition_dependency and_condition::get_dependencies() const
+{
+	condition_dependency dependencies = condition_dependency::none;
+
+	for (const auto &condition : this->conditions) {
+		dependencies = dependencies | condition->get_dependencies();
+	}
+
+	return dependencies;
+}
+
 bool and_condition::check(const CPlayer *player, const bool ignore_units) const
 {
 	for (const auto &condition : this->conditions) {
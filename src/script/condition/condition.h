@@ -42,9 +42,44 @@ class sml_property;
 class trigger;
 class unit_type;
 
+//the kinds of game state which the result of a condition can depend on
+enum class condition_dependency {
+	none = 0,
+	units = 1 << 0, //the units owned by players
+	upgrades = 1 << 1, //the upgrades acquired by players or units
+	quests = 1 << 2,
+	season = 1 << 3,
+	player_identity = 1 << 4, //the civilization, faction, dynasty and age of players
+	triggers = 1 << 5, //which triggers have already fired
+	all = (1 << 6) - 1 //used for conditions whose dependencies aren't tracked, so that they are always re-evaluated
+};
+
+inline condition_dependency operator |(const condition_dependency lhs, const condition_dependency rhs)
+{
+	return static_cast<condition_dependency>(static_cast<int>(lhs) | static_cast<int>(rhs));
+}
+
+inline condition_dependency operator &(const condition_dependency lhs, const condition_dependency rhs)
+{
+	return static_cast<condition_dependency>(static_cast<int>(lhs) & static_cast<int>(rhs));
+}
+
 class condition
 {
 public:
+	static constexpr int dependency_count = 6;
+
+	//mark that game state of the given kinds has changed, so that conditions depending on it need to be checked again
+	static void on_state_changed(const condition_dependency dependencies);
+
+	static uint64_t get_state_change_count()
+	{
+		return condition::state_change_count;
+	}
+
+	//whether game state of any of the given kinds has changed after the given state change count
+	static bool has_state_changed_since(const condition_dependency dependencies, const uint64_t change_count);
+
 	static std::unique_ptr<const condition> from_sml_property(const sml_property &property);
 	static std::unique_ptr<const condition> from_sml_scope(const sml_data &scope);
 
@@ -99,6 +134,16 @@ public:
 	{
 		return false;
 	}
+
+	//get the kinds of game state on which the result of the condition depends
+	virtual condition_dependency get_dependencies() const
+	{
+		return condition_dependency::all;
+	}
+
+private:
+	static inline uint64_t state_change_count = 0;
+	static inline uint64_t dependency_change_counts[condition::dependency_count] = {}; //the state change count at which each kind of state last changed
 };
 
 template <bool precondition>
@@ -47,6 +47,11 @@ public:
 		return player->get_dynasty() == this->dynasty;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::player_identity;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -82,6 +82,17 @@ public:
 		return false;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		condition_dependency dependencies = condition_dependency::none;
+
+		for (const auto &condition : this->conditions) {
+			dependencies = dependencies | condition->get_dependencies();
+		}
+
+		return dependencies;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		std::string str = "One of these must be true:\n";
@@ -47,6 +47,11 @@ public:
 		return player->has_quest(this->quest);
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::quests;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
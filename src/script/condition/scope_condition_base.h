@@ -56,6 +56,11 @@ public:
 		return this->conditions.check(scope, ignore_units);
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return this->conditions.get_dependencies();
+	}
+
 	virtual std::string get_scope_name() const = 0;
 
 	virtual std::string get_string(const size_t indent) const override final
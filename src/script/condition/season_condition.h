@@ -54,6 +54,11 @@ public:
 		return unit->MapLayer->GetSeason() == this->Season;
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::season;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -79,6 +79,15 @@ public:
 		return player->HasSettlement(this->settlement);
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		if (this->enemy) {
+			return condition_dependency::all; //diplomatic stances are not tracked
+		}
+
+		return condition_dependency::units | condition_dependency::player_identity;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -51,6 +51,11 @@ public:
 		return vector::contains(trigger::DeactivatedTriggers, this->trigger->get_identifier()); //this works fine for global triggers, but for player triggers perhaps it should check only the player?
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::triggers;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -107,6 +107,15 @@ public:
 		}
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		if (this->settlement != nullptr) {
+			return condition_dependency::all; //the settlement of units is not tracked
+		}
+
+		return condition_dependency::units | condition_dependency::player_identity;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
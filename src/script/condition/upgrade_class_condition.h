@@ -68,6 +68,11 @@ public:
 		return this->check(unit->Player, ignore_units) || unit->GetIndividualUpgrade(upgrade);
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::upgrades | condition_dependency::player_identity;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
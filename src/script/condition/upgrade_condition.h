@@ -58,6 +58,11 @@ public:
 		return this->check(unit->Player, ignore_units) || unit->GetIndividualUpgrade(this->upgrade);
 	}
 
+	virtual condition_dependency get_dependencies() const override
+	{
+		return condition_dependency::upgrades;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -527,6 +527,7 @@ static int CclSetDeactivatedTriggers(lua_State *l)
 
 	for (int j = 0; j < args; ++j) {
 		wyrmgus::trigger::DeactivatedTriggers.push_back(LuaToString(l, j + 1));
+		wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::triggers);
 	}
 	return 0;
 }
@@ -544,10 +545,22 @@ void TriggersEachCycle()
 		return;
 	}
 
+	//skip the triggers whose conditions were false when last checked, and for which none of the state they depend on has changed since, so that the trigger checked in this cycle is one which can fire
+	for (size_t i = 0; i < wyrmgus::trigger::ActiveTriggers.size(); ++i) {
+		if (wyrmgus::trigger::ActiveTriggers[wyrmgus::trigger::CurrentTriggerId]->needs_check()) {
+			break;
+		}
+
+		wyrmgus::trigger::CurrentTriggerId = (wyrmgus::trigger::CurrentTriggerId + 1) % wyrmgus::trigger::ActiveTriggers.size();
+	}
+
 	// go to the next trigger
-	if (wyrmgus::trigger::CurrentTriggerId < wyrmgus::trigger::ActiveTriggers.size()) {
+	if (wyrmgus::trigger::CurrentTriggerId < wyrmgus::trigger::ActiveTriggers.size() && wyrmgus::trigger::ActiveTriggers[wyrmgus::trigger::CurrentTriggerId]->needs_check()) {
 		wyrmgus::trigger *current_trigger = wyrmgus::trigger::ActiveTriggers[wyrmgus::trigger::CurrentTriggerId];
 
+		//the state change count is taken before checking, so that changes made by the trigger's own effects still cause it to be checked again
+		const uint64_t state_change_count = wyrmgus::condition::get_state_change_count();
+
 		bool removed_trigger = false;
 		
 		//old Lua conditions/effects for triggers
@@ -560,6 +573,7 @@ void TriggersEachCycle()
 					current_trigger->Effects->run(1);
 					if (current_trigger->Effects->popBoolean() == false) {
 						wyrmgus::trigger::DeactivatedTriggers.push_back(current_trigger->get_identifier());
+						wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::triggers);
 						wyrmgus::trigger::ActiveTriggers.erase(wyrmgus::trigger::ActiveTriggers.begin() + wyrmgus::trigger::CurrentTriggerId);
 						removed_trigger = true;
 						if (current_trigger->Local) {
@@ -597,8 +611,13 @@ void TriggersEachCycle()
 				}
 			}
 			
+			if (!triggered) {
+				current_trigger->on_conditions_failed(state_change_count);
+			}
+
 			if (triggered && current_trigger->fires_only_once()) {
 				wyrmgus::trigger::DeactivatedTriggers.push_back(current_trigger->get_identifier());
+				wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::triggers);
 				wyrmgus::trigger::ActiveTriggers.erase(wyrmgus::trigger::ActiveTriggers.begin() + wyrmgus::trigger::CurrentTriggerId);
 				removed_trigger = true;
 				if (current_trigger->Local) {
@@ -646,6 +665,7 @@ void trigger::InitActiveTriggers()
 		if (trigger->is_campaign_only() && game::get()->get_current_campaign() == nullptr) {
 			continue;
 		}
+		trigger->reset_check_state();
 		trigger::ActiveTriggers.push_back(trigger);
 	}
 }
@@ -673,7 +693,7 @@ void trigger::ClearActiveTriggers()
 	GameTimer.Reset();
 }
 
-trigger::trigger(const std::string &identifier) : data_entry(identifier)
+trigger::trigger(const std::string &identifier) : data_entry(identifier), dependencies(condition_dependency::all)
 {
 }
 
@@ -681,6 +701,35 @@ trigger::~trigger()
 {
 }
 
+void trigger::reset_check_state()
+{
+	if (this->Conditions != nullptr) {
+		this->dependencies = condition_dependency::all;
+	} else {
+		this->dependencies = condition_dependency::none;
+
+		if (this->get_preconditions() != nullptr) {
+			this->dependencies = this->dependencies | this->get_preconditions()->get_dependencies();
+		}
+
+		if (this->get_conditions() != nullptr) {
+			this->dependencies = this->dependencies | this->get_conditions()->get_dependencies();
+		}
+	}
+
+	this->conditions_failed = false;
+	this->failed_state_change_count = 0;
+}
+
+bool trigger::needs_check() const
+{
+	if (!this->conditions_failed || this->dependencies == condition_dependency::all) {
+		return true;
+	}
+
+	return condition::has_state_changed_since(this->dependencies, this->failed_state_change_count);
+}
+
 void trigger::process_sml_property(const sml_property &property)
 {
 	const std::string &key = property.get_key();
@@ -43,6 +43,7 @@ namespace wyrmgus {
 	class faction;
 	class resource;
 	class unit_type;
+	enum class condition_dependency;
 
 	template <typename scope_type>
 	class effect_list;
@@ -126,6 +127,17 @@ public:
 		return this->effects;
 	}
 
+	void reset_check_state();
+
+	//whether the trigger's conditions may have a different result than when they were last checked
+	bool needs_check() const;
+
+	void on_conditions_failed(const uint64_t state_change_count)
+	{
+		this->conditions_failed = true;
+		this->failed_state_change_count = state_change_count;
+	}
+
 	TriggerType Type = TriggerType::GlobalTrigger;
 	bool Local = false;
 private:
@@ -138,6 +150,9 @@ private:
 	std::unique_ptr<condition> preconditions;
 	std::unique_ptr<condition> conditions;
 	std::unique_ptr<effect_list<CPlayer>> effects;
+	condition_dependency dependencies; //the kinds of game state the trigger's conditions depend on
+	bool conditions_failed = false; //whether the conditions were false when last checked
+	uint64_t failed_state_change_count = 0; //the condition state change count when the conditions were last checked, if they were false
 };
 
 }
@@ -51,6 +51,7 @@
 //Wyrmgus end
 #include "util/queue_util.h"
 #include "util/qunique_ptr.h"
+#include "util/spsc_queue.h"
 
 #include "SDL.h"
 
@@ -58,6 +59,11 @@
 #include <oaml.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WYRMGUS_SOUND_SSE2
+#include <emmintrin.h>
+#endif
+
 static bool SoundInitialized;    /// is sound initialized
 static bool MusicPlaying;        /// flag true if playing music
 
@@ -67,7 +73,7 @@ static int MusicVolume = 128;    /// music volume
 static bool MusicEnabled = true;
 static bool EffectsEnabled = true;
 
-/// Channels for sound effects and unit speech
+/// Channels for sound effects and unit speech, as seen by the game
 struct SoundChannel {
 	wyrmgus::sample *Sample;       /// sample to play
 	std::unique_ptr<Origin> Unit;          /// pointer to unit, who plays the sound, if any
@@ -78,15 +84,61 @@ struct SoundChannel {
 	//Wyrmgus end
 
 	bool Playing;          /// channel is currently playing
-	int Point;             /// point in sample if playing or next free channel
+	int Point;             /// next free channel, if not playing
+	unsigned int Generation; /// incremented each time the channel starts playing, so that mixer events for a previous sample can be told apart
 
 	void (*FinishedCallback)(int channel); /// Callback for when a sample finishes playing
 };
 
-static constexpr int MaxChannels = 64; //how many channels are supported
+static constexpr int MaxChannels = 128; //how many channels are supported
 
 static SoundChannel Channels[MaxChannels];
 static int NextFreeChannel;
+static std::recursive_mutex ChannelMutex; /// protects the channels, so that changing them never has to wait for the mixer
+
+/// State of a channel in the mixer, only accessed by the audio thread
+struct MixerVoice {
+	wyrmgus::sample *Sample = nullptr;
+	unsigned int Generation = 0;
+	int Point = 0;              /// current frame in the sample
+	int Fraction = 0;           /// fractional part of the position in the sample, in 16.16 fixed point
+	unsigned char Volume = 0;
+	signed char Stereo = 0;
+	int GainLeft = 0;           /// gain currently applied to the left channel, in Q15 fixed point
+	int GainRight = 0;
+	bool Playing = false;
+	bool FinishPending = false; /// the sample has ended, but the game could not be notified yet
+};
+
+static MixerVoice MixerVoices[MaxChannels];
+
+enum class MixerCommandType {
+	Play,
+	SetVolume,
+	SetStereo
+};
+
+/// A channel change sent from the game to the mixer
+struct MixerCommand {
+	MixerCommandType Type = MixerCommandType::Play;
+	int Channel = 0;
+	unsigned int Generation = 0;
+	wyrmgus::sample *Sample = nullptr;
+	unsigned char Volume = 0;
+	signed char Stereo = 0;
+};
+
+/// A channel having finished playing, sent from the mixer to the game
+struct MixerFinishedEvent {
+	int Channel = 0;
+	unsigned int Generation = 0;
+};
+
+static constexpr size_t MixerQueueCapacity = 1024;
+static wyrmgus::spsc_queue<MixerCommand, MixerQueueCapacity> MixerCommands;
+static wyrmgus::spsc_queue<MixerFinishedEvent, MixerQueueCapacity> MixerFinishedEvents;
+
+static constexpr int GainRampFrames = 64; /// over how many frames volume and stereo changes are applied, to avoid clicks
 
 static struct {
 	std::unique_ptr<wyrmgus::sample> Sample;       /// Music sample
@@ -94,6 +146,7 @@ static struct {
 } MusicChannel;
 
 static void ChannelFinished(int channel);
+static void ProcessFinishedChannels();
 
 static struct {
 	SDL_AudioSpec Format;
@@ -102,6 +155,7 @@ static struct {
 	SDL_Thread *Thread;
 
 	std::unique_ptr<int[]> MixerBuffer;
+	std::unique_ptr<short[]> ResampleBuffer;
 	std::unique_ptr<Uint8[]> Buffer;
 	bool Running;
 } Audio;
@@ -192,31 +246,18 @@ static void MixMusicToStereo32(int *buffer, int size)
 }
 
 /**
-**  Mix sample to buffer.
-**
-**  The input samples are adjusted by the local volume and resampled
-**  to the output frequence.
-**
-**  @param sample  Input sample
-**  @param index   Position into input sample
-**  @param volume  Volume of the input sample
-**  @param stereo  Stereo (left/right) position of sample
-**  @param buffer  Output buffer
-**  @param size    Size of output buffer (in samples per channel)
+**  Get the gains of a channel for each side of the output.
 **
-**  @return        The number of bytes used to fill buffer
-**
-**  @todo          Can mix faster if signed 8 bit buffers are used.
+**  @param volume      Volume of the channel
+**  @param stereo      Stereo (left/right) position of the channel
+**  @param gain_left   Set to the gain of the left side, in Q15 fixed point
+**  @param gain_right  Set to the gain of the right side, in Q15 fixed point
 */
-static int MixSampleToStereo32(wyrmgus::sample *sample, int index, unsigned char volume,
-							   char stereo, int *buffer, int size)
+static void GetChannelGains(const unsigned char volume, const signed char stereo, int &gain_left, int &gain_right)
 {
-	static int buf[SOUND_BUFFER_SIZE / 2];
-	unsigned char left;
-	unsigned char right;
-
-	int div = 176400 / (sample->get_format().sampleRate() * (sample->get_format().sampleSize() / 8) * sample->get_format().channelCount());
-	int local_volume = (int)volume * EffectsVolume / MaxVolume;
+	const int local_volume = static_cast<int>(volume) * EffectsVolume / MaxVolume;
+	int left;
+	int right;
 
 	if (stereo < 0) {
 		left = 128;
@@ -226,20 +267,191 @@ static int MixSampleToStereo32(wyrmgus::sample *sample, int index, unsigned char
 		right = 128;
 	}
 
-	Assert(!(index & 1));
+	// FIXME: why taking out '/ 2' leads to distortion
+	gain_left = local_volume * left * 32768 / (128 * MaxVolume * 2);
+	gain_right = local_volume * right * 32768 / (128 * MaxVolume * 2);
+}
+
+/**
+**  Read the next frames of a voice, resampled to the output frequency and converted to stereo 16 bit.
+**
+**  @param voice   Voice to read
+**  @param output  Buffer for the converted frames
+**  @param frames  Number of frames wanted, set to the number of frames read
+**
+**  @return        The read frames, either within the sample itself or within the output buffer
+*/
+static const short *ReadVoiceFrames(MixerVoice &voice, short *output, int &frames)
+{
+	const wyrmgus::sample *sample = voice.Sample;
+	const int bytes = sample->get_format().sampleSize() / 8;
+	const int channels = sample->get_format().channelCount();
+	const int rate = sample->get_format().sampleRate();
+
+	if (bytes <= 0 || channels <= 0 || rate <= 0) {
+		frames = 0;
+		return output;
+	}
+
+	const int total_frames = sample->get_length() / (bytes * channels);
+
+	if (voice.Point >= total_frames) {
+		frames = 0;
+		return output;
+	}
+
+	if (rate == Audio.Format.freq && bytes == 2 && channels == 2) {
+		//the sample is already in the output format, so it can be mixed directly
+		frames = std::min(frames, total_frames - voice.Point);
+		const short *frames_start = reinterpret_cast<const short *>(sample->get_buffer()) + voice.Point * 2;
+		voice.Point += frames;
+		return frames_start;
+	}
+
+	const auto get_value = [sample, bytes, channels](const int frame, const int channel) -> int {
+		const int index = frame * channels + std::min(channel, channels - 1);
+
+		if (bytes == 1) {
+			return (static_cast<int>(sample->get_buffer()[index]) - 128) << 8;
+		}
+
+		return reinterpret_cast<const short *>(sample->get_buffer())[index];
+	};
+
+	//the step in the sample per output frame, in 16.16 fixed point
+	const int step = static_cast<int>((static_cast<int64_t>(rate) << 16) / Audio.Format.freq);
+
+	int read_frames = 0;
+	while (read_frames < frames && voice.Point < total_frames) {
+		const int next_point = std::min(voice.Point + 1, total_frames - 1);
+
+		for (int channel = 0; channel < 2; ++channel) {
+			const int value = get_value(voice.Point, channel);
+			const int next_value = get_value(next_point, channel);
+			output[read_frames * 2 + channel] = static_cast<short>(value + static_cast<int>((static_cast<int64_t>(next_value - value) * voice.Fraction) >> 16));
+		}
+
+		++read_frames;
+		voice.Fraction += step;
+		voice.Point += voice.Fraction >> 16;
+		voice.Fraction &= 0xFFFF;
+	}
+
+	frames = read_frames;
+	return output;
+}
+
+/**
+**  Add stereo 16 bit frames to a stereo 32 bit buffer.
+**
+**  @param input       Stereo 16 bit frames
+**  @param output      Stereo 32 bit buffer
+**  @param frames      Number of frames to add
+**  @param gain_left   Gain of the left side, in Q15 fixed point
+**  @param gain_right  Gain of the right side, in Q15 fixed point
+*/
+static void AddStereo16ToStereo32(const short *input, int *output, const int frames, const int gain_left, const int gain_right)
+{
+	const int size = frames * 2;
+	int i = 0;
+
+#ifdef WYRMGUS_SOUND_SSE2
+	//the gains fit in 16 bits, so the low and high halves of each product can be interleaved back into 32-bit values
+	const __m128i gains = _mm_set_epi16(gain_right, gain_left, gain_right, gain_left, gain_right, gain_left, gain_right, gain_left);
 
-	size = std::min((sample->get_length() - index) * div / 2, size);
+	for (; i + 8 <= size; i += 8) {
+		const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+		const __m128i products_low = _mm_mullo_epi16(values, gains);
+		const __m128i products_high = _mm_mulhi_epi16(values, gains);
 
-	size = ConvertToStereo32((char *)(sample->get_buffer() + index), (char *)buf, sample->get_format().sampleRate(), sample->get_format().sampleSize() / 8, sample->get_format().channelCount(), size * 2 / div);
+		__m128i *output_ptr = reinterpret_cast<__m128i *>(output + i);
+		_mm_storeu_si128(output_ptr, _mm_add_epi32(_mm_loadu_si128(output_ptr), _mm_srai_epi32(_mm_unpacklo_epi16(products_low, products_high), 15)));
+		_mm_storeu_si128(output_ptr + 1, _mm_add_epi32(_mm_loadu_si128(output_ptr + 1), _mm_srai_epi32(_mm_unpackhi_epi16(products_low, products_high), 15)));
+	}
+#endif
 
-	size /= 2;
-	for (int i = 0; i < size; i += 2) {
-		// FIXME: why taking out '/ 2' leads to distortion
-		buffer[i] += ((short *)buf)[i] * local_volume * left / 128 / MaxVolume / 2;
-		buffer[i + 1] += ((short *)buf)[i + 1] * local_volume * right / 128 / MaxVolume / 2;
+	for (; i < size; i += 2) {
+		output[i] += (input[i] * gain_left) >> 15;
+		output[i + 1] += (input[i + 1] * gain_right) >> 15;
 	}
+}
 
-	return 2 * size / div;
+/**
+**  Mix a voice to stereo 32 bit.
+**
+**  If the gains of the voice changed, they are ramped to the new values over the first frames.
+**
+**  @param voice   Voice to mix
+**  @param buffer  Buffer for mixed samples
+**  @param frames  Number of frames that fit into the buffer
+**
+**  @return        True if the sample of the voice has ended
+*/
+static bool MixVoiceToStereo32(MixerVoice &voice, int *buffer, const int frames)
+{
+	int voice_frames = frames;
+	const short *input = ReadVoiceFrames(voice, Audio.ResampleBuffer.get(), voice_frames);
+
+	int gain_left;
+	int gain_right;
+	GetChannelGains(voice.Volume, voice.Stereo, gain_left, gain_right);
+
+	int ramp_frames = 0;
+	if (gain_left != voice.GainLeft || gain_right != voice.GainRight) {
+		ramp_frames = std::min(voice_frames, GainRampFrames);
+
+		for (int i = 0; i < ramp_frames; ++i) {
+			const int ramp_gain_left = voice.GainLeft + (gain_left - voice.GainLeft) * (i + 1) / ramp_frames;
+			const int ramp_gain_right = voice.GainRight + (gain_right - voice.GainRight) * (i + 1) / ramp_frames;
+			buffer[i * 2] += (input[i * 2] * ramp_gain_left) >> 15;
+			buffer[i * 2 + 1] += (input[i * 2 + 1] * ramp_gain_right) >> 15;
+		}
+
+		if (ramp_frames > 0) {
+			voice.GainLeft = gain_left;
+			voice.GainRight = gain_right;
+		}
+	}
+
+	AddStereo16ToStereo32(input + ramp_frames * 2, buffer + ramp_frames * 2, voice_frames - ramp_frames, voice.GainLeft, voice.GainRight);
+
+	return voice_frames < frames;
+}
+
+/**
+**  Apply the channel changes sent by the game to the mixer voices.
+*/
+static void ProcessMixerCommands()
+{
+	MixerCommand command;
+
+	while (MixerCommands.pop(command)) {
+		MixerVoice &voice = MixerVoices[command.Channel];
+
+		switch (command.Type) {
+			case MixerCommandType::Play:
+				voice.Sample = command.Sample;
+				voice.Generation = command.Generation;
+				voice.Point = 0;
+				voice.Fraction = 0;
+				voice.Volume = command.Volume;
+				voice.Stereo = command.Stereo;
+				GetChannelGains(voice.Volume, voice.Stereo, voice.GainLeft, voice.GainRight);
+				voice.Playing = true;
+				voice.FinishPending = false;
+				break;
+			case MixerCommandType::SetVolume:
+				if (voice.Generation == command.Generation) {
+					voice.Volume = command.Volume;
+				}
+				break;
+			case MixerCommandType::SetStereo:
+				if (voice.Generation == command.Generation) {
+					voice.Stereo = command.Stereo;
+				}
+				break;
+		}
+	}
 }
 
 /**
@@ -255,22 +467,22 @@ static int MixChannelsToStereo32(int *buffer, int size)
 	int new_free_channels = 0;
 
 	for (int channel = 0; channel < MaxChannels; ++channel) {
-		if (Channels[channel].Playing && Channels[channel].Sample) {
-			//Wyrmgus start
-			if ((Channels[channel].Point & 1)) {
-				fprintf(stderr, "Sound effect error; Index: %d, Voice: %d, Origin: \"%s\", Sample Length: %d\n", Channels[channel].Point, Channels[channel].Voice, (Channels[channel].Unit && Channels[channel].Unit->Base) ? UnitManager.GetSlotUnit(Channels[channel].Unit->Id).Type->Ident.c_str() : "", Channels[channel].Sample->get_length());
-			}
-			//Wyrmgus end
-			int i = MixSampleToStereo32(Channels[channel].Sample,
-										Channels[channel].Point, Channels[channel].Volume,
-										Channels[channel].Stereo, buffer, size);
-			Channels[channel].Point += i;
-			Assert(Channels[channel].Point <= Channels[channel].Sample->get_length());
-
-			if (Channels[channel].Point == Channels[channel].Sample->get_length()) {
-				ChannelFinished(channel);
-				++new_free_channels;
-			}
+		MixerVoice &voice = MixerVoices[channel];
+
+		if (!voice.Playing) {
+			continue;
+		}
+
+		if (!voice.FinishPending && MixVoiceToStereo32(voice, buffer, size / 2)) {
+			voice.FinishPending = true;
+		}
+
+		//the channel itself is freed by the game when it receives the event; if the queue is full, try again on the next pass
+		if (voice.FinishPending && MixerFinishedEvents.push(MixerFinishedEvent{channel, voice.Generation})) {
+			voice.Playing = false;
+			voice.FinishPending = false;
+			voice.Sample = nullptr;
+			++new_free_channels;
 		}
 	}
 	return new_free_channels;
@@ -285,12 +497,20 @@ static int MixChannelsToStereo32(int *buffer, int size)
 */
 static void ClipMixToStereo16(const int *mix, int size, short *output)
 {
-	const int *end = mix + size;
+	int i = 0;
+
+#ifdef WYRMGUS_SOUND_SSE2
+	for (; i + 8 <= size; i += 8) {
+		const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + i));
+		const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mix + i + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packs_epi32(low, high));
+	}
+#endif
 
-	while (mix < end) {
-		int s = (*mix++);
+	for (; i < size; ++i) {
+		int s = mix[i];
 		clamp(&s, SHRT_MIN, SHRT_MAX);
-		*output++ = s;
+		output[i] = s;
 	}
 }
 
@@ -305,6 +525,8 @@ static void MixIntoBuffer(void *buffer, int samples)
 	// FIXME: can save the memset here, if first channel sets the values
 	memset(Audio.MixerBuffer.get(), 0, samples * sizeof(*Audio.MixerBuffer.get()));
 
+	ProcessMixerCommands();
+
 	if (EffectsEnabled) {
 		// Add channels to mixer buffer
 		MixChannelsToStereo32(Audio.MixerBuffer.get(), samples);
@@ -384,6 +606,9 @@ static int FillThread(void *)
 */
 bool SampleIsPlaying(wyrmgus::sample *sample)
 {
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
+	ProcessFinishedChannels();
+
 	for (int i = 0; i < MaxChannels; ++i) {
 		if (Channels[i].Sample == sample && Channels[i].Playing) {
 			return true;
@@ -394,6 +619,9 @@ bool SampleIsPlaying(wyrmgus::sample *sample)
 
 bool UnitSoundIsPlaying(Origin *origin)
 {
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
+	ProcessFinishedChannels();
+
 	for (int i = 0; i < MaxChannels; ++i) {
 		//Wyrmgus start
 //		if (origin && Channels[i].Unit && origin->Id && Channels[i].Unit->Id
@@ -431,6 +659,66 @@ static void ChannelFinished(int channel)
 	NextFreeChannel = channel;
 }
 
+/**
+**  Free the channels which the mixer reported as having finished playing
+*/
+static void ProcessFinishedChannels()
+{
+	MixerFinishedEvent event;
+
+	while (MixerFinishedEvents.pop(event)) {
+		//the channel may have been stopped, and even played another sample, after the mixer finished it
+		if (Channels[event.Channel].Playing && Channels[event.Channel].Generation == event.Generation) {
+			ChannelFinished(event.Channel);
+		}
+	}
+}
+
+/**
+**  Send the state of a playing channel to the mixer
+**
+**  @param type     Which part of the channel state is sent
+**  @param channel  Channel to send
+**
+**  @return         False if the mixer's command queue is full
+*/
+static bool SendMixerCommand(const MixerCommandType type, const int channel)
+{
+	MixerCommand command;
+	command.Type = type;
+	command.Channel = channel;
+	command.Generation = Channels[channel].Generation;
+	command.Sample = Channels[channel].Sample;
+	command.Volume = Channels[channel].Volume;
+	command.Stereo = Channels[channel].Stereo;
+	return MixerCommands.push(command);
+}
+
+/**
+**  Stop the mixer voices of channels which were stopped by the game
+**
+**  This waits for the mixer, so that the samples of the stopped channels may be freed right afterwards.
+**
+**  @param channel  Channel to stop, or -1 for all channels
+*/
+static void StopMixerVoices(const int channel)
+{
+	SDL_LockMutex(Audio.Lock);
+
+	//apply pending commands first, so that they cannot restart the voices afterwards
+	ProcessMixerCommands();
+
+	for (int i = 0; i < MaxChannels; ++i) {
+		if ((channel == -1 || channel == i) && !Channels[i].Playing) {
+			MixerVoices[i].Playing = false;
+			MixerVoices[i].FinishPending = false;
+			MixerVoices[i].Sample = nullptr;
+		}
+	}
+
+	SDL_UnlockMutex(Audio.Lock);
+}
+
 /**
 **  Put a sound request in the next free channel.
 */
@@ -459,8 +747,15 @@ static int FillChannel(wyrmgus::sample *sample, unsigned char volume, char stere
 		source->Id = origin->Id;
 		Channels[NextFreeChannel].Unit = std::move(source);
 	}
+	++Channels[NextFreeChannel].Generation;
 	NextFreeChannel = next_free;
 
+	if (!SendMixerCommand(MixerCommandType::Play, old_free)) {
+		//the mixer is too far behind, so drop the sound
+		ChannelFinished(old_free);
+		return -1;
+	}
+
 	return old_free;
 }
 
@@ -478,15 +773,18 @@ int SetChannelVolume(int channel, int volume)
 		return -1;
 	}
 
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
+
 	if (volume < 0) {
 		volume = Channels[channel].Volume;
 	} else {
-		SDL_LockMutex(Audio.Lock);
-
 		volume = std::min(MaxVolume, volume);
 		Channels[channel].Volume = volume;
 
-		SDL_UnlockMutex(Audio.Lock);
+		//if the command queue is full, the channel keeps its previous volume in the mixer
+		if (Channels[channel].Playing) {
+			SendMixerCommand(MixerCommandType::SetVolume, channel);
+		}
 	}
 	return volume;
 }
@@ -508,12 +806,16 @@ int SetChannelStereo(int channel, int stereo)
 		return -1;
 	}
 
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
+
 	if (stereo < -128 || stereo > 127) {
 		stereo = Channels[channel].Stereo;
 	} else {
-		SDL_LockMutex(Audio.Lock);
 		Channels[channel].Stereo = stereo;
-		SDL_UnlockMutex(Audio.Lock);
+
+		if (Channels[channel].Playing) {
+			SendMixerCommand(MixerCommandType::SetStereo, channel);
+		}
 	}
 	return stereo;
 }
@@ -530,9 +832,8 @@ void SetChannelVoiceGroup(int channel, const wyrmgus::unit_sound_type voice)
 		return;
 	}
 
-	SDL_LockMutex(Audio.Lock);
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
 	Channels[channel].Voice = voice;
-	SDL_UnlockMutex(Audio.Lock);
 }
 //Wyrmgus end
 
@@ -547,6 +848,8 @@ void SetChannelFinishedCallback(int channel, void (*callback)(int channel))
 	if (channel < 0 || channel >= MaxChannels) {
 		return;
 	}
+
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
 	Channels[channel].FinishedCallback = callback;
 }
 
@@ -558,6 +861,9 @@ wyrmgus::sample *GetChannelSample(int channel)
 	if (channel < 0 || channel >= MaxChannels) {
 		return nullptr;
 	}
+
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
+	ProcessFinishedChannels();
 	return Channels[channel].Sample;
 }
 
@@ -568,13 +874,13 @@ wyrmgus::sample *GetChannelSample(int channel)
 */
 void StopChannel(int channel)
 {
-	SDL_LockMutex(Audio.Lock);
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
 	if (channel >= 0 && channel < MaxChannels) {
 		if (Channels[channel].Playing) {
 			ChannelFinished(channel);
+			StopMixerVoices(channel);
 		}
 	}
-	SDL_UnlockMutex(Audio.Lock);
 }
 
 /**
@@ -582,13 +888,13 @@ void StopChannel(int channel)
 */
 void StopAllChannels()
 {
-	SDL_LockMutex(Audio.Lock);
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
 	for (int i = 0; i < MaxChannels; ++i) {
 		if (Channels[i].Playing) {
 			ChannelFinished(i);
 		}
 	}
-	SDL_UnlockMutex(Audio.Lock);
+	StopMixerVoices(-1);
 }
 
 /**
@@ -682,11 +988,12 @@ int PlaySample(wyrmgus::sample *sample, Origin *origin)
 {
 	int channel = -1;
 
-	SDL_LockMutex(Audio.Lock);
+	std::lock_guard<std::recursive_mutex> lock(ChannelMutex);
+	ProcessFinishedChannels();
+
 	if (SoundEnabled() && EffectsEnabled && sample && NextFreeChannel != MaxChannels) {
 		channel = FillChannel(sample, EffectsVolume, 0, origin);
 	}
-	SDL_UnlockMutex(Audio.Lock);
 	return channel;
 }
 
@@ -1092,11 +1399,14 @@ int InitSound()
 		Channels[i].Voice = wyrmgus::unit_sound_type::none;
 		Channels[i].Playing = false;
 		//Wyrmgus end
+		Channels[i].Generation = 0;
+		MixerVoices[i] = MixerVoice();
 	}
 
 	// Create mutex and cond for FillThread
 	Audio.MixerBuffer = std::make_unique<int[]>(Audio.Format.samples * Audio.Format.channels);
 	memset(Audio.MixerBuffer.get(), 0, Audio.Format.samples * Audio.Format.channels * sizeof(int));
+	Audio.ResampleBuffer = std::make_unique<short[]>(Audio.Format.samples * 2);
 	Audio.Buffer = std::make_unique<Uint8[]>(Audio.Format.size);
 	memset(Audio.Buffer.get(), 0, Audio.Format.size);
 	Audio.Lock = SDL_CreateMutex();
@@ -1129,5 +1439,6 @@ void QuitSound()
 	// Mustn't call SDL_CloseAudio here, it'll be called again from SDL_Quit
 	SoundInitialized = false;
 	Audio.MixerBuffer.reset();
+	Audio.ResampleBuffer.reset();
 	Audio.Buffer.reset();
 }
@@ -42,6 +42,7 @@
 #include "network.h"
 //Wyrmgus end
 #include "script.h"
+#include "script/condition/condition.h"
 #include "spell/spell.h"
 #include "unit/unit.h"
 //Wyrmgus start
@@ -187,6 +188,7 @@ int Spell_Polymorph::Cast(CUnit &caster, const wyrmgus::spell &spell, CUnit *tar
 	//Wyrmgus start
 	if (target->Character && (this->PlayerNeutral == 1 || this->PlayerNeutral == 2)) {
 		target->Player->Heroes.erase(std::remove(target->Player->Heroes.begin(), target->Player->Heroes.end(), target), target->Player->Heroes.end());
+		wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::units);
 		target->Character = nullptr;
 	}
 //	UnitLost(*target);
@@ -154,6 +154,17 @@ long CFile::tell()
 	return pimpl->tell();
 }
 
+/**
+**  CLwrite Library file write
+**
+**  @param buf  Pointer to the data to write.
+**  @param len  number of bytes to write.
+*/
+int CFile::write(const void *buf, size_t len)
+{
+	return pimpl->write(buf, len);
+}
+
 /**
 **  CLprintf Library file write
 **
@@ -462,6 +462,9 @@ static void DisplayLoop()
 	}
 #endif
 	if (FastForwardCycle <= GameCycle || GameCycle <= 10 || !(GameCycle & 0x3f)) {
+		//upload the minimap texels changed by its update or by terrain changes before it is drawn
+		UI.get_minimap()->upload_textures();
+
 		//FIXME: this might be better placed somewhere at front of the
 		// program, as we now still have a game on the background and
 		// need to go through the game-menu or supply a map file
@@ -220,13 +220,12 @@
 **    Production of resources per minute (or estimates)
 **    Used just as information (statistics) for the player...
 **
-**  CPlayer::UnitTypesCount[::UnitTypeMax]
+**  CPlayer::unit_type_counts
 **
-**    Total count for each different unit type. Used by the AI and
-**    for condition checks. The addition of all counts should
-**    be CPlayer::TotalNumUnits.
-**    @note Should not use the maximum number of unit-types here,
-**    only the real number of unit-types used.
+**    Total count for each different unit type, indexed by the unit
+**    type's index. Used by the AI and for condition checks. The
+**    addition of all counts should be CPlayer::TotalNumUnits.
+**    @note Only grows up to the highest unit type index in use.
 **
 **  CPlayer::AiEnabled
 **
@@ -423,6 +422,8 @@ void InitPlayers()
 			CPlayer::Players[p]->Type = PlayerNobody;
 		}
 	}
+
+	CPlayer::update_diplomacy_masks();
 }
 
 /**
@@ -560,15 +561,15 @@ void CPlayer::Save(CFile &file) const
 
 	file.printf(" \"enemy\", \"");
 	for (int j = 0; j < PlayerMax; ++j) {
-		file.printf("%c", p.enemies.contains(j) ? 'X' : '_');
+		file.printf("%c", (p.enemy_mask & wyrmgus::get_player_mask(j)) ? 'X' : '_');
 	}
 	file.printf("\", \"allied\", \"");
 	for (int j = 0; j < PlayerMax; ++j) {
-		file.printf("%c", p.allies.contains(j) ? 'X' : '_');
+		file.printf("%c", (p.ally_mask & wyrmgus::get_player_mask(j)) ? 'X' : '_');
 	}
 	file.printf("\", \"shared-vision\", \"");
 	for (int j = 0; j < PlayerMax; ++j) {
-		file.printf("%c", p.shared_vision.contains(j) ? 'X' : '_');
+		file.printf("%c", (p.shared_vision_mask & wyrmgus::get_player_mask(j)) ? 'X' : '_');
 	}
 	file.printf("\",\n  \"start\", {%d, %d},\n", p.StartPos.x, p.StartPos.y);
 	//Wyrmgus start
@@ -652,7 +653,7 @@ void CPlayer::Save(CFile &file) const
 	}
 	//Wyrmgus end
 
-	// UnitTypesCount done by load units.
+	// unit type counts done by load units.
 
 	file.printf("},\n  \"%s\",\n", p.AiEnabled ? "ai-enabled" : "ai-disabled");
 
@@ -938,8 +939,8 @@ void CPlayer::Init(/* PlayerTypes */ int type)
 	this->overlord = nullptr;
 	this->vassalage_type = wyrmgus::vassalage_type::none;
 	this->Team = team;
-	this->enemies.clear();
-	this->allies.clear();
+	this->enemy_mask = 0;
+	this->ally_mask = 0;
 	this->AiName = "ai-passive";
 
 	//  Calculate enemy/allied mask.
@@ -954,35 +955,35 @@ void CPlayer::Init(/* PlayerTypes */ int type)
 				// Computer allied with computer and enemy of all persons.
 				// make computer players be hostile to each other by default
 				if (other_player->Type == PlayerComputer || other_player->Type == PlayerPerson || other_player->Type == PlayerRescueActive) {
-					this->enemies.insert(i);
-					other_player->enemies.insert(NumPlayers);
+					this->enemy_mask |= wyrmgus::get_player_mask(i);
+					other_player->enemy_mask |= wyrmgus::get_player_mask(NumPlayers);
 				}
 				break;
 			case PlayerPerson:
 				// Humans are enemy of all?
 				if (other_player->Type == PlayerComputer || other_player->Type == PlayerPerson) {
-					this->enemies.insert(i);
-					other_player->enemies.insert(NumPlayers);
+					this->enemy_mask |= wyrmgus::get_player_mask(i);
+					other_player->enemy_mask |= wyrmgus::get_player_mask(NumPlayers);
 				} else if (other_player->Type == PlayerRescueActive || other_player->Type == PlayerRescuePassive) {
-					this->allies.insert(i);
-					other_player->allies.insert(NumPlayers);
+					this->ally_mask |= wyrmgus::get_player_mask(i);
+					other_player->ally_mask |= wyrmgus::get_player_mask(NumPlayers);
 				}
 				break;
 			case PlayerRescuePassive:
 				// Rescue passive are allied with persons
 				if (other_player->Type == PlayerPerson) {
-					this->allies.insert(i);
-					other_player->allies.insert(NumPlayers);
+					this->ally_mask |= wyrmgus::get_player_mask(i);
+					other_player->ally_mask |= wyrmgus::get_player_mask(NumPlayers);
 				}
 				break;
 			case PlayerRescueActive:
 				// Rescue active are allied with persons and enemies of computer
 				if (other_player->Type == PlayerComputer) {
-					this->enemies.insert(i);
-					other_player->enemies.insert(NumPlayers);
+					this->enemy_mask |= wyrmgus::get_player_mask(i);
+					other_player->enemy_mask |= wyrmgus::get_player_mask(NumPlayers);
 				} else if (other_player->Type == PlayerPerson) {
-					this->allies.insert(i);
-					other_player->allies.insert(NumPlayers);
+					this->ally_mask |= wyrmgus::get_player_mask(i);
+					other_player->ally_mask |= wyrmgus::get_player_mask(NumPlayers);
 				}
 				break;
 		}
@@ -1001,9 +1002,11 @@ void CPlayer::Init(/* PlayerTypes */ int type)
 	}
 
 	//Wyrmgus start
-	this->UnitTypesCount.clear();
-	this->UnitTypesUnderConstructionCount.clear();
-	this->UnitTypesAiActiveCount.clear();
+	this->unit_type_counts.clear();
+	this->unit_type_under_construction_counts.clear();
+	this->unit_type_ai_active_counts.clear();
+	this->unit_class_counts.clear();
+	this->unit_class_ai_active_counts.clear();
 	this->Heroes.clear();
 	this->Deities.clear();
 	this->units_by_type.clear();
@@ -1031,6 +1034,8 @@ void CPlayer::Init(/* PlayerTypes */ int type)
 	}
 	this->revealed = false;
 	++NumPlayers;
+
+	CPlayer::update_diplomacy_masks();
 }
 
 bool CPlayer::is_neutral_player() const
@@ -1055,6 +1060,8 @@ const wyrmgus::civilization *CPlayer::get_civilization() const
 //Wyrmgus start
 void CPlayer::set_civilization(const wyrmgus::civilization *civilization)
 {
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::player_identity);
+
 	if (this->get_civilization() != nullptr && (GameRunning || GameEstablishing)) {
 		const wyrmgus::civilization *old_civilization = this->get_civilization();
 		if (old_civilization->get_upgrade() != nullptr && this->Allow.Upgrades[old_civilization->get_upgrade()->ID] == 'R') {
@@ -1100,6 +1107,8 @@ wyrmgus::faction *CPlayer::get_faction() const
 
 void CPlayer::SetFaction(const wyrmgus::faction *faction)
 {
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::player_identity);
+
 	int old_faction_id = this->Faction;
 	
 	if (faction != nullptr && faction->get_civilization() != this->get_civilization()) {
@@ -1317,6 +1326,8 @@ void CPlayer::set_dynasty(const wyrmgus::dynasty *dynasty)
 		return;
 	}
 
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::player_identity);
+
 	const wyrmgus::dynasty *old_dynasty = this->dynasty;
 	
 	if (old_dynasty != nullptr) {
@@ -1388,6 +1399,7 @@ void CPlayer::set_age(const wyrmgus::age *age)
 	}
 	
 	this->age = age;
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::player_identity);
 	
 	if (this == CPlayer::GetThisPlayer()) {
 		if (this->age) {
@@ -1972,8 +1984,12 @@ std::vector<const CUpgrade *> CPlayer::GetResearchableUpgrades()
 {
 	std::vector<const CUpgrade *> researchable_upgrades;
 
-	for (const auto &kv_pair : this->UnitTypesAiActiveCount) {
-		const wyrmgus::unit_type *type = kv_pair.first;
+	for (size_t i = 0; i < this->unit_type_ai_active_counts.size(); ++i) {
+		if (this->unit_type_ai_active_counts[i] <= 0) {
+			continue;
+		}
+
+		const wyrmgus::unit_type *type = wyrmgus::unit_type::get_all()[i];
 
 		for (const CUpgrade *upgrade : AiHelpers.get_researched_upgrades(type)) {
 			if (!wyrmgus::vector::contains(researchable_upgrades, upgrade)) {
@@ -2016,9 +2032,12 @@ void CPlayer::Clear()
 	this->vassals.clear();
 	this->AiName.clear();
 	this->Team = 0;
-	this->enemies.clear();
-	this->allies.clear();
-	this->shared_vision.clear();
+	this->enemy_mask = 0;
+	this->ally_mask = 0;
+	this->shared_vision_mask = 0;
+	this->hostile_mask = 0;
+	this->mutual_ally_mask = 0;
+	this->mutual_shared_vision_mask = 0;
 	this->StartPos.x = 0;
 	this->StartPos.y = 0;
 	//Wyrmgus start
@@ -2034,9 +2053,11 @@ void CPlayer::Clear()
 	memset(this->ResourceDemand, 0, sizeof(this->ResourceDemand));
 	memset(this->StoredResourceDemand, 0, sizeof(this->StoredResourceDemand));
 	//Wyrmgus end
-	this->UnitTypesCount.clear();
-	this->UnitTypesUnderConstructionCount.clear();
-	this->UnitTypesAiActiveCount.clear();
+	this->unit_type_counts.clear();
+	this->unit_type_under_construction_counts.clear();
+	this->unit_type_ai_active_counts.clear();
+	this->unit_class_counts.clear();
+	this->unit_class_ai_active_counts.clear();
 	//Wyrmgus start
 	this->Heroes.clear();
 	this->Deities.clear();
@@ -2106,6 +2127,7 @@ void CPlayer::AddUnit(CUnit &unit)
 	this->Units.push_back(&unit);
 	unit.Player = this;
 	Assert(this->Units[unit.PlayerSlot] == &unit);
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::units);
 }
 
 void CPlayer::RemoveUnit(CUnit &unit)
@@ -2118,6 +2140,7 @@ void CPlayer::RemoveUnit(CUnit &unit)
 	}
 	//Wyrmgus end
 	Assert(this->Units[unit.PlayerSlot] == &unit);
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::units);
 
 	//	unit.Player = nullptr; // we can remove dying unit...
 	CUnit *last = this->Units.back();
@@ -2404,6 +2427,7 @@ void CPlayer::accept_quest(wyrmgus::quest *quest)
 	
 	wyrmgus::vector::remove(this->available_quests, quest);
 	this->current_quests.push_back(quest);
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::quests);
 	
 	for (const auto &quest_objective : quest->get_objectives()) {
 		auto objective = std::make_unique<wyrmgus::player_quest_objective>(quest_objective.get());
@@ -2493,6 +2517,7 @@ void CPlayer::fail_quest(wyrmgus::quest *quest, const std::string &fail_reason)
 void CPlayer::remove_current_quest(wyrmgus::quest *quest)
 {
 	wyrmgus::vector::remove(this->current_quests, quest);
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::quests);
 	
 	for (int i = (this->quest_objectives.size()  - 1); i >= 0; --i) {
 		if (this->quest_objectives[i]->get_quest_objective()->get_quest() == quest) {
@@ -3459,19 +3484,54 @@ int CPlayer::GetUpgradeCostsMask(const CUpgrade *upgrade) const
 
 //Wyrmgus end
 
+/**
+**	@brief	Get a count from a vector of counts indexed by unit type or unit class index
+*/
+static int get_indexed_count(const std::vector<int> &counts, const int index)
+{
+	if (index < 0 || index >= static_cast<int>(counts.size())) {
+		return 0;
+	}
+
+	return counts[index];
+}
+
+/**
+**	@brief	Set a count in a vector of counts indexed by unit type or unit class index, growing it if necessary
+**
+**	@return	The change in the count
+*/
+static int set_indexed_count(std::vector<int> &counts, const int index, const int quantity, const size_t max_count)
+{
+	const int old_quantity = get_indexed_count(counts, index);
+	const int new_quantity = std::max(quantity, 0);
+
+	if (new_quantity == old_quantity) {
+		return 0;
+	}
+
+	if (index >= static_cast<int>(counts.size())) {
+		counts.resize(std::max(max_count, static_cast<size_t>(index) + 1), 0);
+	}
+
+	counts[index] = new_quantity;
+	return new_quantity - old_quantity;
+}
+
 void CPlayer::SetUnitTypeCount(const wyrmgus::unit_type *type, int quantity)
 {
 	if (!type) {
 		return;
 	}
 	
-	if (quantity <= 0) {
-		if (this->UnitTypesCount.find(type) != this->UnitTypesCount.end()) {
-			this->UnitTypesCount.erase(type);
-		}
-	} else {
-		this->UnitTypesCount[type] = quantity;
+	const int change = set_indexed_count(this->unit_type_counts, type->get_index(), quantity, wyrmgus::unit_type::get_all().size());
+
+	if (change != 0 && type->get_unit_class() != nullptr) {
+		const int class_index = type->get_unit_class()->get_index();
+		set_indexed_count(this->unit_class_counts, class_index, get_indexed_count(this->unit_class_counts, class_index) + change, wyrmgus::unit_class::get_all().size());
 	}
+
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::units);
 }
 
 void CPlayer::ChangeUnitTypeCount(const wyrmgus::unit_type *type, int quantity)
@@ -3481,11 +3541,11 @@ void CPlayer::ChangeUnitTypeCount(const wyrmgus::unit_type *type, int quantity)
 
 int CPlayer::GetUnitTypeCount(const wyrmgus::unit_type *type) const
 {
-	if (type != nullptr && this->UnitTypesCount.find(type) != this->UnitTypesCount.end()) {
-		return this->UnitTypesCount.find(type)->second;
-	} else {
+	if (type == nullptr) {
 		return 0;
 	}
+
+	return get_indexed_count(this->unit_type_counts, type->get_index());
 }
 
 void CPlayer::SetUnitTypeUnderConstructionCount(const wyrmgus::unit_type *type, int quantity)
@@ -3494,13 +3554,7 @@ void CPlayer::SetUnitTypeUnderConstructionCount(const wyrmgus::unit_type *type,
 		return;
 	}
 	
-	if (quantity <= 0) {
-		if (this->UnitTypesUnderConstructionCount.find(type) != this->UnitTypesUnderConstructionCount.end()) {
-			this->UnitTypesUnderConstructionCount.erase(type);
-		}
-	} else {
-		this->UnitTypesUnderConstructionCount[type] = quantity;
-	}
+	set_indexed_count(this->unit_type_under_construction_counts, type->get_index(), quantity, wyrmgus::unit_type::get_all().size());
 }
 
 void CPlayer::ChangeUnitTypeUnderConstructionCount(const wyrmgus::unit_type *type, int quantity)
@@ -3510,11 +3564,11 @@ void CPlayer::ChangeUnitTypeUnderConstructionCount(const wyrmgus::unit_type *typ
 
 int CPlayer::GetUnitTypeUnderConstructionCount(const wyrmgus::unit_type *type) const
 {
-	if (type && this->UnitTypesUnderConstructionCount.find(type) != this->UnitTypesUnderConstructionCount.end()) {
-		return this->UnitTypesUnderConstructionCount.find(type)->second;
-	} else {
+	if (type == nullptr) {
 		return 0;
 	}
+
+	return get_indexed_count(this->unit_type_under_construction_counts, type->get_index());
 }
 
 void CPlayer::SetUnitTypeAiActiveCount(const wyrmgus::unit_type *type, int quantity)
@@ -3523,12 +3577,11 @@ void CPlayer::SetUnitTypeAiActiveCount(const wyrmgus::unit_type *type, int quant
 		return;
 	}
 	
-	if (quantity <= 0) {
-		if (this->UnitTypesAiActiveCount.find(type) != this->UnitTypesAiActiveCount.end()) {
-			this->UnitTypesAiActiveCount.erase(type);
-		}
-	} else {
-		this->UnitTypesAiActiveCount[type] = quantity;
+	const int change = set_indexed_count(this->unit_type_ai_active_counts, type->get_index(), quantity, wyrmgus::unit_type::get_all().size());
+
+	if (change != 0 && type->get_unit_class() != nullptr) {
+		const int class_index = type->get_unit_class()->get_index();
+		set_indexed_count(this->unit_class_ai_active_counts, class_index, get_indexed_count(this->unit_class_ai_active_counts, class_index) + change, wyrmgus::unit_class::get_all().size());
 	}
 }
 
@@ -3539,11 +3592,29 @@ void CPlayer::ChangeUnitTypeAiActiveCount(const wyrmgus::unit_type *type, int qu
 
 int CPlayer::GetUnitTypeAiActiveCount(const wyrmgus::unit_type *type) const
 {
-	if (type && this->UnitTypesAiActiveCount.find(type) != this->UnitTypesAiActiveCount.end()) {
-		return this->UnitTypesAiActiveCount.find(type)->second;
-	} else {
+	if (type == nullptr) {
+		return 0;
+	}
+
+	return get_indexed_count(this->unit_type_ai_active_counts, type->get_index());
+}
+
+int CPlayer::get_unit_class_count(const wyrmgus::unit_class *unit_class) const
+{
+	if (unit_class == nullptr) {
+		return 0;
+	}
+
+	return get_indexed_count(this->unit_class_counts, unit_class->get_index());
+}
+
+int CPlayer::get_unit_class_ai_active_count(const wyrmgus::unit_class *unit_class) const
+{
+	if (unit_class == nullptr) {
 		return 0;
 	}
+
+	return get_indexed_count(this->unit_class_ai_active_counts, unit_class->get_index());
 }
 
 void CPlayer::IncreaseCountsForUnit(CUnit *unit, bool type_change)
@@ -3646,13 +3717,17 @@ int CPlayer::get_population() const
 {
 	int people_count = 0;
 
-	for (const auto &kv_pair : this->UnitTypesCount) {
-		const wyrmgus::unit_type *unit_type = kv_pair.first;
+	for (size_t i = 0; i < this->unit_type_counts.size(); ++i) {
+		if (this->unit_type_counts[i] <= 0) {
+			continue;
+		}
+
+		const wyrmgus::unit_type *unit_type = wyrmgus::unit_type::get_all()[i];
 		if (!unit_type->BoolFlag[ORGANIC_INDEX].value || unit_type->BoolFlag[FAUNA_INDEX].value) {
 			continue;
 		}
 
-		people_count += kv_pair.second;
+		people_count += this->unit_type_counts[i];
 	}
 
 	return static_cast<int>(pow(people_count, 2)) * wyrmgus::base_population_per_unit;
@@ -3866,8 +3941,9 @@ void CPlayer::Notify(const char *fmt, ...) const
 
 void CPlayer::SetDiplomacyNeutralWith(const CPlayer &player)
 {
-	this->enemies.erase(player.Index);
-	this->allies.erase(player.Index);
+	this->enemy_mask &= ~wyrmgus::get_player_mask(player.Index);
+	this->ally_mask &= ~wyrmgus::get_player_mask(player.Index);
+	CPlayer::update_diplomacy_masks();
 
 	//Wyrmgus start
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
@@ -3878,8 +3954,9 @@ void CPlayer::SetDiplomacyNeutralWith(const CPlayer &player)
 
 void CPlayer::SetDiplomacyAlliedWith(const CPlayer &player)
 {
-	this->enemies.erase(player.Index);
-	this->allies.insert(player.Index);
+	this->enemy_mask &= ~wyrmgus::get_player_mask(player.Index);
+	this->ally_mask |= wyrmgus::get_player_mask(player.Index);
+	CPlayer::update_diplomacy_masks();
 	
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
 		CPlayer::GetThisPlayer()->Notify(_("%s changed their diplomatic stance with us to Ally"), _(this->Name.c_str()));
@@ -3888,8 +3965,9 @@ void CPlayer::SetDiplomacyAlliedWith(const CPlayer &player)
 
 void CPlayer::SetDiplomacyEnemyWith(CPlayer &player)
 {
-	this->enemies.insert(player.Index);
-	this->allies.erase(player.Index);
+	this->enemy_mask |= wyrmgus::get_player_mask(player.Index);
+	this->ally_mask &= ~wyrmgus::get_player_mask(player.Index);
+	CPlayer::update_diplomacy_masks();
 	
 	if (GameCycle > 0) {
 		if (player.Index == CPlayer::GetThisPlayer()->Index) {
@@ -3918,8 +3996,9 @@ void CPlayer::SetDiplomacyEnemyWith(CPlayer &player)
 
 void CPlayer::SetDiplomacyCrazyWith(const CPlayer &player)
 {
-	this->enemies.insert(player.Index);
-	this->allies.insert(player.Index);
+	this->enemy_mask |= wyrmgus::get_player_mask(player.Index);
+	this->ally_mask |= wyrmgus::get_player_mask(player.Index);
+	CPlayer::update_diplomacy_masks();
 	
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
 		CPlayer::GetThisPlayer()->Notify(_("%s changed their diplomatic stance with us to Crazy"), _(this->Name.c_str()));
@@ -3928,7 +4007,8 @@ void CPlayer::SetDiplomacyCrazyWith(const CPlayer &player)
 
 void CPlayer::ShareVisionWith(const CPlayer &player)
 {
-	this->shared_vision.insert(player.Index);
+	this->shared_vision_mask |= wyrmgus::get_player_mask(player.Index);
+	CPlayer::update_diplomacy_masks();
 	
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
 		CPlayer::GetThisPlayer()->Notify(_("%s is now sharing vision with us"), _(this->Name.c_str()));
@@ -3937,7 +4017,8 @@ void CPlayer::ShareVisionWith(const CPlayer &player)
 
 void CPlayer::UnshareVisionWith(const CPlayer &player)
 {
-	this->shared_vision.erase(player.Index);
+	this->shared_vision_mask &= ~wyrmgus::get_player_mask(player.Index);
+	CPlayer::update_diplomacy_masks();
 	
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
 		CPlayer::GetThisPlayer()->Notify(_("%s is no longer sharing vision with us"), _(this->Name.c_str()));
@@ -3969,6 +4050,7 @@ void CPlayer::set_overlord(CPlayer *overlord, const wyrmgus::vassalage_type)
 
 	this->overlord = overlord;
 	this->vassalage_type = vassalage_type;
+	CPlayer::update_diplomacy_masks();
 
 	if (overlord != nullptr) {
 		overlord->vassals.push_back(this);
@@ -4014,16 +4096,64 @@ void CPlayer::break_overlordship_alliance(CPlayer *overlord)
 }
 
 /**
-**  Check if the player is an enemy
+**	@brief	Recalculate the relations of all players which depend on the diplomatic stances of more than one player
+**
+**	This needs to be called whenever a stance, a shared vision or an overlord changes, so that relation queries can be answered by checking a single bit.
 */
-bool CPlayer::IsEnemy(const CPlayer &player) const
+void CPlayer::update_diplomacy_masks()
 {
-	if (this->get_overlord() != nullptr && this->get_overlord()->IsEnemy(player)) {
-		return true;
+	static_assert(PlayerMax <= 64, "Player masks must be able to hold all player indexes.");
+
+	for (CPlayer *player : CPlayer::Players) {
+		const wyrmgus::player_mask player_mask = wyrmgus::get_player_mask(player->Index);
+
+		player->hostile_mask = player->enemy_mask & ~player_mask;
+		player->mutual_ally_mask = 0;
+		player->mutual_shared_vision_mask = 0;
+
+		for (const CPlayer *other_player : CPlayer::Players) {
+			if (other_player == player || other_player->Index == player->Index) {
+				continue;
+			}
+
+			const wyrmgus::player_mask other_player_mask = wyrmgus::get_player_mask(other_player->Index);
+
+			//be hostile to the other player if they are hostile, even if the diplomatic stance hasn't been changed
+			if ((other_player->enemy_mask & player_mask) != 0) {
+				player->hostile_mask |= other_player_mask;
+			}
+
+			//only consider yourself to be the ally of another player if they have the allied stance with you as well
+			if ((player->ally_mask & other_player_mask) != 0 && (other_player->ally_mask & player_mask) != 0) {
+				player->mutual_ally_mask |= other_player_mask;
+			}
+
+			if ((player->shared_vision_mask & other_player_mask) != 0 && (other_player->shared_vision_mask & player_mask) != 0) {
+				player->mutual_shared_vision_mask |= other_player_mask;
+			}
+		}
+	}
+
+	//players are also hostile to those hostile to their overlords, which must be calculated with the hostile masks of the overlords before they are themselves changed
+	std::vector<wyrmgus::player_mask> overlord_hostile_masks(CPlayer::Players.size(), 0);
+
+	for (size_t i = 0; i < CPlayer::Players.size(); ++i) {
+		for (const CPlayer *overlord = CPlayer::Players[i]->get_overlord(); overlord != nullptr; overlord = overlord->get_overlord()) {
+			overlord_hostile_masks[i] |= overlord->hostile_mask;
+		}
 	}
 
-	//be hostile to the other player if they are hostile, even if the diplomatic stance hasn't been changed
-	return this->IsEnemy(player.Index) || player.IsEnemy(this->Index);
+	for (size_t i = 0; i < CPlayer::Players.size(); ++i) {
+		CPlayer::Players[i]->hostile_mask |= overlord_hostile_masks[i];
+	}
+}
+
+/**
+**  Check if the player is an enemy
+*/
+bool CPlayer::IsEnemy(const CPlayer &player) const
+{
+	return (this->hostile_mask & wyrmgus::get_player_mask(player.Index)) != 0;
 }
 
 /**
@@ -4062,8 +4192,7 @@ bool CPlayer::IsEnemy(const CUnit &unit) const
 */
 bool CPlayer::IsAllied(const CPlayer &player) const
 {
-	//only consider yourself to be the ally of another player if they have the allied stance with you as well
-	return this->IsAllied(player.Index) && player.IsAllied(this->Index);
+	return (this->mutual_ally_mask & wyrmgus::get_player_mask(player.Index)) != 0;
 }
 
 /**
@@ -4076,7 +4205,7 @@ bool CPlayer::IsAllied(const CUnit &unit) const
 
 bool CPlayer::IsVisionSharing() const
 {
-	return !this->shared_vision.empty();
+	return this->shared_vision_mask != 0;
 }
 
 bool CPlayer::has_shared_vision_with(const CPlayer &player) const
@@ -4091,7 +4220,7 @@ bool CPlayer::has_shared_vision_with(const CUnit &unit) const
 
 bool CPlayer::has_mutual_shared_vision_with(const CPlayer &player) const
 {
-	return this->shared_vision.contains(player.Index) && player.shared_vision.contains(this->Index);
+	return (this->mutual_shared_vision_mask & wyrmgus::get_player_mask(player.Index)) != 0;
 }
 
 bool CPlayer::has_mutual_shared_vision_with(const CUnit &unit) const
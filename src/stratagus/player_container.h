@@ -30,5 +30,11 @@
 namespace wyrmgus {
 
 using player_index_set = std::set<unsigned char>;
+using player_mask = uint64_t; //a set of player indexes, as bits
+
+constexpr player_mask get_player_mask(const int player_index)
+{
+	return static_cast<player_mask>(1) << player_index;
+}
 
 }
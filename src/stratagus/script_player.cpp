@@ -171,27 +171,27 @@ void CPlayer::Load(lua_State *l)
 			value = LuaToString(l, j + 1);
 			for (int i = 0; i < PlayerMax && *value; ++i, ++value) {
 				if (*value == '-' || *value == '_' || *value == ' ') {
-					this->enemies.erase(i);
+					this->enemy_mask &= ~wyrmgus::get_player_mask(i);
 				} else {
-					this->enemies.insert(i);
+					this->enemy_mask |= wyrmgus::get_player_mask(i);
 				}
 			}
 		} else if (!strcmp(value, "allied")) {
 			value = LuaToString(l, j + 1);
 			for (int i = 0; i < PlayerMax && *value; ++i, ++value) {
 				if (*value == '-' || *value == '_' || *value == ' ') {
-					this->allies.erase(i);
+					this->ally_mask &= ~wyrmgus::get_player_mask(i);
 				} else {
-					this->allies.insert(i);
+					this->ally_mask |= wyrmgus::get_player_mask(i);
 				}
 			}
 		} else if (!strcmp(value, "shared-vision")) {
 			value = LuaToString(l, j + 1);
 			for (int i = 0; i < PlayerMax && *value; ++i, ++value) {
 				if (*value == '-' || *value == '_' || *value == ' ') {
-					this->shared_vision.erase(i);
+					this->shared_vision_mask &= ~wyrmgus::get_player_mask(i);
 				} else {
-					this->shared_vision.insert(i);
+					this->shared_vision_mask |= wyrmgus::get_player_mask(i);
 				}
 			}
 		} else if (!strcmp(value, "start")) {
@@ -509,6 +509,8 @@ void CPlayer::Load(lua_State *l)
 			this->set_resource(wyrmgus::resource::get_all()[i], this->Resources[i] + this->StoredResources[i], STORE_BOTH);
 		}
 	}
+
+	CPlayer::update_diplomacy_masks();
 }
 
 /**
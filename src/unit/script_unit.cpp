@@ -563,6 +563,8 @@ static int CclUnit(lua_State *l)
 			lua_pop(l, 1);
 		} else if (!strcmp(value, "wait")) {
 			unit->Wait = LuaToNumber(l, 2, j + 1);
+		} else if (!strcmp(value, "skipped-cycles")) {
+			unit->Sleep.SkippedCycles = LuaToNumber(l, 2, j + 1);
 		} else if (!strcmp(value, "anim-data")) {
 			lua_rawgeti(l, 2, j + 1);
 			wyrmgus::animation_set::LoadUnitAnim(l, *unit, -1);
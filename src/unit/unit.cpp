@@ -87,6 +87,7 @@
 #include "unit/unit_type.h"
 #include "unit/unit_type_type.h"
 #include "unit/unit_type_variation.h"
+#include "unit/unit_wakeup_scheduler.h"
 #include "upgrade/upgrade.h"
 #include "upgrade/upgrade_modifier.h"
 //Wyrmgus start
@@ -511,6 +512,9 @@ void CUnit::Init()
 	MineLow = 0;
 	memset(&Anim, 0, sizeof(Anim));
 	memset(&WaitBackup, 0, sizeof(WaitBackup));
+	//Wyrmgus start
+	this->Sleep = _unit_sleep_();
+	//Wyrmgus end
 	GivesResource = 0;
 	CurrentResource = 0;
 	StepCount = 0;
@@ -918,6 +922,7 @@ void CUnit::HealingItemAutoUse()
 			) {
 				if (this->CriticalOrder == nullptr) {
 					this->CriticalOrder = COrder::NewActionUse(*uins);
+					wyrmgus::unit_wakeup_scheduler::get()->wake(*this);
 				}
 				break;
 			}
@@ -933,6 +938,7 @@ void CUnit::set_character(wyrmgus::character *character)
 
 	if (this->Character != nullptr) {
 		wyrmgus::vector::remove(this->Player->Heroes, this);
+		wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::units);
 
 		this->Variable[HERO_INDEX].Max = this->Variable[HERO_INDEX].Value = this->Variable[HERO_INDEX].Enable = 0;
 	}
@@ -1070,6 +1076,7 @@ void CUnit::set_character(wyrmgus::character *character)
 
 	if (this->Character != nullptr) {
 		this->Player->Heroes.push_back(this);
+		wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::units);
 	}
 
 	this->Variable[HERO_INDEX].Max = this->Variable[HERO_INDEX].Value = this->Variable[HERO_INDEX].Enable = 1;
@@ -3281,6 +3288,25 @@ void UpdateUnitSightRange(CUnit &unit)
 	}
 }
 
+/**
+**  Notify the pathfinder if the unit is a fixed obstacle, whose field flags change the passability of its tiles.
+**
+**  @param unit  unit which marked or unmarked its field flags.
+*/
+static void UpdatePathfinderForUnit(const CUnit &unit)
+{
+	if ((unit.Type->FieldFlags & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) == 0) {
+		return;
+	}
+
+	const QPoint bottom_right_pos = unit.get_bottom_right_tile_pos();
+	for (int y = unit.tilePos.y; y <= bottom_right_pos.y(); ++y) {
+		for (int x = unit.tilePos.x; x <= bottom_right_pos.x(); ++x) {
+			PathfinderTileChanged(Vec2i(x, y), unit.MapLayer->ID);
+		}
+	}
+}
+
 /**
 **  Mark the field with the FieldFlags.
 **
@@ -3308,6 +3334,8 @@ void MarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += unit.MapLayer->get_width();
 	} while (--h);
+
+	UpdatePathfinderForUnit(unit);
 }
 
 class _UnmarkUnitFieldFlags
@@ -3356,6 +3384,8 @@ void UnmarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += unit.MapLayer->get_width();
 	} while (--h);
+
+	UpdatePathfinderForUnit(unit);
 }
 
 /**
@@ -3706,6 +3736,8 @@ void CUnit::MoveToXY(const Vec2i &pos, int z)
 	UnitInXY(*this, pos, z);
 	//Wyrmgus end
 
+	wyrmgus::unit_wakeup_scheduler::get()->on_unit_moved(*this);
+
 	CMap::Map.Insert(*this);
 	MarkUnitFieldFlags(*this);
 	//  Recalculate the seen count.
@@ -4006,6 +4038,7 @@ void CUnit::Remove(CUnit *host)
 	CMap::Map.Remove(*this);
 	MapUnmarkUnitSight(*this);
 	UnmarkUnitFieldFlags(*this);
+	wyrmgus::unit_wakeup_scheduler::get()->on_unit_moved(*this);
 	if (host) {
 		AddInContainer(*host);
 		UpdateUnitSightRange(*this);
@@ -4250,6 +4283,7 @@ void UnitClearOrders(CUnit &unit)
 {
 	unit.Orders.clear();
 	unit.Orders.push_back(COrder::NewActionStill());
+	wyrmgus::unit_wakeup_scheduler::get()->wake(unit);
 }
 
 /**
@@ -4506,12 +4540,12 @@ void UnitCountSeen(CUnit &unit)
 				int x = width;
 				do {
 					if (unit.Type->BoolFlag[PERMANENTCLOAK_INDEX].value && unit.Player != CPlayer::Players[p]) {
-						if (mf->player_info->VisCloak[p]) {
+						if (mf->player_info->get_cloak(p)) {
 							newv++;
 						}
 					//Wyrmgus start
 					} else if (unit.Type->BoolFlag[ETHEREAL_INDEX].value && unit.Player != CPlayer::Players[p]) {
-						if (mf->player_info->VisEthereal[p]) {
+						if (mf->player_info->get_ethereal(p)) {
 							newv++;
 						}
 					//Wyrmgus end
@@ -4565,11 +4599,9 @@ bool CUnit::IsVisible(const CPlayer &player) const
 		return true;
 	}
 
-	for (const int p : player.get_shared_vision()) {
-		if (this->VisCount[p]) {
-			if (CPlayer::Players[p]->has_shared_vision_with(player_index)) { //if the shared vision is mutual
-				return true;
-			}
+	for (wyrmgus::player_mask mask = player.get_mutual_shared_vision_mask(); mask != 0; mask &= mask - 1) {
+		if (this->VisCount[std::countr_zero(mask)]) {
+			return true;
 		}
 	}
 
@@ -5519,6 +5551,8 @@ void CUnit::SetIndividualUpgrade(const CUpgrade *upgrade, int quantity)
 	} else {
 		this->IndividualUpgrades[upgrade->ID] = quantity;
 	}
+
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::upgrades);
 }
 
 int CUnit::GetIndividualUpgrade(const CUpgrade *upgrade) const
@@ -7035,6 +7069,7 @@ static void HitUnit_LastAttack(const CUnit *attacker, CUnit &target)
 	const unsigned long last_attack_cycle = target.Attacked;
 
 	target.Attacked = GameCycle ? GameCycle : 1;
+	wyrmgus::unit_wakeup_scheduler::get()->wake(target);
 	if (target.Type->BoolFlag[WALL_INDEX].value || (last_attack_cycle && GameCycle <= (last_attack_cycle + 2 * CYCLES_PER_SECOND))) {
 		return;
 	}
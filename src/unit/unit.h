@@ -529,7 +529,7 @@ public:
 		}
 
 	private:
-		int slot = -1;           /// index in UnitManager::unitSlots
+		int slot = -1;           /// index of the unit slot in UnitManager
 		int unitSlot = -1;       /// index in UnitManager::units
 
 		friend class CUnitManager;
@@ -674,6 +674,20 @@ public:
 		int Unbreakable;             /// Unbreakable
 	} Anim, WaitBackup;
 
+	//Wyrmgus start
+	struct _unit_sleep_ {
+		bool Asleep = false;             /// Whether the unit is sleeping, in which case its action isn't handled
+		bool Woken = false;              /// Whether the sleeping unit has been woken, and its action is to be handled in this cycle
+		bool CountsDownWait = false;     /// Whether the unit's action wait counts down while it sleeps, besides its animation wait
+		unsigned long Cycle = 0;         /// Cycle in which the unit's action was last handled before it went to sleep
+		unsigned long LastSkippedCycle = 0; /// Last cycle in which the unit's action was skipped
+		unsigned long WakeupCycle = 0;   /// Cycle in which the unit is due to be woken
+		const CUnit *Goal = nullptr;     /// Goal of the unit's order when it went to sleep, whose moving wakes the unit
+		_unit_anim_ Anim {};             /// Animation state when the unit went to sleep
+		unsigned int Wait = 0;           /// Action wait when the unit went to sleep
+		int SkippedCycles = 0;           /// Cycles slept through before the current handling of the unit's action
+	} Sleep;
+	//Wyrmgus end
 
 	std::vector<std::unique_ptr<COrder>> Orders; /// orders to process
 	std::unique_ptr<COrder> SavedOrder;         /// order to continue after current
@@ -715,7 +729,7 @@ public:
 		DeselectInMine(false),
 		//Wyrmgus start
 		PlayerColorCircle(false), SepiaForGrayscale(false),
-		ShowPathlines(false),
+		ShowPathlines(false), SaveMapFieldsAsText(false), TextureVariantMemoryBudget(256), DecodedImageMemoryBudget(256),
 //		ShowOrders(0), ShowNameDelay(0), ShowNameTime(0), AutosaveMinutes(5) {};
 		ShowOrders(0), ShowNameDelay(0), ShowNameTime(0), AutosaveMinutes(5), HotkeySetup(0) {};
 		//Wyrmgus end
@@ -737,11 +751,14 @@ public:
 	bool PlayerColorCircle;		/// Show a player color circle below each unit
 	bool ShowPathlines;			/// Show order pathlines
 	//Wyrmgus end
+	bool SaveMapFieldsAsText;	/// Save the map fields as Lua tables instead of in the binary format
 
 	int ShowOrders;			/// How many second show orders of unit on map.
 	int ShowNameDelay;		/// How many cycles need to wait until unit's name popup will appear.
 	int ShowNameTime;		/// How many cycles need to show unit's name popup.
 	int AutosaveMinutes;	/// Autosave the game every X minutes; autosave is disabled if the value is 0
+	int TextureVariantMemoryBudget;	/// Video memory budget in megabytes for player color and time of day texture variants; least recently used variants are freed above it, 0 means no limit
+	int DecodedImageMemoryBudget;	/// Memory budget in megabytes for decoded graphic images; least recently used images are released above it and decoded again when needed, 0 means no limit
 	//Wyrmgus start
 	int HotkeySetup;			/// Hotkey layout (0 = default, 1 = position-based, 2 = position-based (except commands))
 	//Wyrmgus end
@@ -0,0 +1,124 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+class CUnit;
+
+namespace wyrmgus {
+
+/**
+**  Coarse grid over a map layer, in which each cell holds the units occupying any of its tiles.
+**
+**  It is kept up to date together with the tiles' unit caches, and allows range queries to skip whole empty cells instead of visiting each of their tiles, as well as to look at the units in an area without going through the tiles at all.
+*/
+class unit_bucket_grid final
+{
+public:
+	static constexpr int cell_size = 8;
+
+	explicit unit_bucket_grid(const QSize &map_size)
+		: columns((map_size.width() + unit_bucket_grid::cell_size - 1) / unit_bucket_grid::cell_size),
+		rows((map_size.height() + unit_bucket_grid::cell_size - 1) / unit_bucket_grid::cell_size)
+	{
+		this->cells.resize(this->columns * this->rows);
+	}
+
+	/// Add a unit to the cells overlapping its tile rectangle
+	void insert(CUnit *unit, const QRect &tile_rect)
+	{
+		this->for_each_cell_index(tile_rect, [this, unit](const int cell_index) {
+			this->cells[cell_index].push_back(unit);
+		});
+	}
+
+	/// Remove a unit from the cells overlapping its tile rectangle
+	void remove(CUnit *unit, const QRect &tile_rect)
+	{
+		this->for_each_cell_index(tile_rect, [this, unit](const int cell_index) {
+			std::vector<CUnit *> &cell = this->cells[cell_index];
+			const auto find_iterator = std::find(cell.begin(), cell.end(), unit);
+			if (find_iterator != cell.end()) {
+				cell.erase(find_iterator);
+			}
+		});
+	}
+
+	const std::vector<CUnit *> &get_cell_units(const QPoint &tile_pos) const
+	{
+		return this->cells[this->get_cell_index(tile_pos)];
+	}
+
+	bool is_cell_empty(const QPoint &tile_pos) const
+	{
+		return this->get_cell_units(tile_pos).empty();
+	}
+
+	/// Get the x coordinate of the last tile in the same cell row as a tile
+	static int get_cell_end_x(const int tile_x)
+	{
+		return (tile_x / unit_bucket_grid::cell_size + 1) * unit_bucket_grid::cell_size - 1;
+	}
+
+	/// Call a function for each unit in the cells overlapping a tile rectangle; units in more than one of those cells are visited once for each cell
+	template <typename function_type>
+	void for_each_unit_in_cells(const QRect &tile_rect, const function_type &function) const
+	{
+		this->for_each_cell_index(tile_rect, [this, &function](const int cell_index) {
+			for (CUnit *unit : this->cells[cell_index]) {
+				function(unit);
+			}
+		});
+	}
+
+private:
+	int get_cell_index(const QPoint &tile_pos) const
+	{
+		return tile_pos.x() / unit_bucket_grid::cell_size + (tile_pos.y() / unit_bucket_grid::cell_size) * this->columns;
+	}
+
+	template <typename function_type>
+	void for_each_cell_index(const QRect &tile_rect, const function_type &function) const
+	{
+		const int min_cell_x = std::max(tile_rect.left(), 0) / unit_bucket_grid::cell_size;
+		const int min_cell_y = std::max(tile_rect.top(), 0) / unit_bucket_grid::cell_size;
+		const int max_cell_x = std::min(tile_rect.right() / unit_bucket_grid::cell_size, this->columns - 1);
+		const int max_cell_y = std::min(tile_rect.bottom() / unit_bucket_grid::cell_size, this->rows - 1);
+
+		for (int cell_y = min_cell_y; cell_y <= max_cell_y; ++cell_y) {
+			for (int cell_x = min_cell_x; cell_x <= max_cell_x; ++cell_x) {
+				function(cell_x + cell_y * this->columns);
+			}
+		}
+	}
+
+	int columns = 0;
+	int rows = 0;
+	std::vector<std::vector<CUnit *>> cells;
+};
+
+}
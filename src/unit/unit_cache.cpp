@@ -39,6 +39,7 @@
 #include "map/map_layer.h"
 #include "map/tile.h"
 #include "unit/unit.h"
+#include "unit/unit_bucket_grid.h"
 #include "unit/unit_type.h"
 
 /**
@@ -63,6 +64,8 @@ void CMap::Insert(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < unit.MapLayer->get_width());
 		index += unit.MapLayer->get_width();
 	} while (--i && unit.tilePos.y + (i - h) < unit.MapLayer->get_height());
+
+	unit.MapLayer->get_unit_buckets().insert(&unit, QRect(unit.tilePos, unit.Type->get_tile_size()));
 }
 
 /**
@@ -87,6 +90,8 @@ void CMap::Remove(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < unit.MapLayer->get_width());
 		index += unit.MapLayer->get_width();
 	} while (--i && unit.tilePos.y + (i - h) < unit.MapLayer->get_height());
+
+	unit.MapLayer->get_unit_buckets().remove(&unit, QRect(unit.tilePos, unit.Type->get_tile_size()));
 }
 
 //Wyrmgus start
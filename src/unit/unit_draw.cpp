@@ -54,6 +54,7 @@
 #include "unit/construction.h"
 #include "unit/unit.h"
 #include "unit/unit_find.h"
+#include "unit/unit_manager.h"
 #include "unit/unit_type.h"
 #include "unit/unit_type_type.h"
 #include "unit/unit_type_variation.h"
@@ -1319,32 +1320,71 @@ void CUnit::Draw(const CViewport &vp) const
 }
 
 /**
-**  Compare what order 2 units should be drawn on the map
-**
-**  @param c1  First Unit to compare (*Unit)
-**  @param c2  Second Unit to compare (*Unit)
+**  The draw order key of a unit, calculated once per frame instead of for each comparison when sorting.
+*/
+struct unit_draw_order_entry final
+{
+	unit_draw_order_entry()
+	{
+	}
+
+	explicit unit_draw_order_entry(CUnit *unit, const int tile_height) : unit(unit)
+	{
+		this->draw_level = unit->GetDrawLevel();
+		// compares unit's Y positions (bottom of sprite) on the map, and uses X position in case Y positions are equal
+		this->bottom_y = (unit->tilePos.y + unit->Type->get_tile_height() - 1) * tile_height + unit->get_pixel_offset().y();
+		this->x = unit->tilePos.x;
+		this->unit_number = UnitNumber(*unit);
+	}
+
+	bool operator <(const unit_draw_order_entry &other) const
+	{
+		return std::tie(this->draw_level, this->bottom_y, this->x, this->unit_number) < std::tie(other.draw_level, other.bottom_y, other.x, other.unit_number);
+	}
+
+	CUnit *unit = nullptr;
+	int draw_level = 0;
+	int bottom_y = 0;
+	int x = 0;
+	int unit_number = 0;
+};
+
+/**
+**  Sort draw order entries which are expected to be nearly sorted already.
 **
+**  Insertion sort is used, falling back to a regular sort if too many entries are out of place.
 */
-static inline bool DrawLevelCompare(const CUnit *c1, const CUnit *c2)
+static void SortNearlySortedDrawOrder(std::vector<unit_draw_order_entry> &entries, const size_t count)
 {
-	int drawlevel1 = c1->GetDrawLevel();
-	int drawlevel2 = c2->GetDrawLevel();
-
-	if (drawlevel1 == drawlevel2) {
-		// diffpos compares unit's Y positions (bottom of sprite) on the map
-		// and uses X position in case Y positions are equal.
-		const int pos1 = (c1->tilePos.y + c1->Type->get_tile_height() - 1) * wyrmgus::defines::get()->get_tile_height() + c1->get_pixel_offset().y();
-		const int pos2 = (c2->tilePos.y + c2->Type->get_tile_height() - 1) * wyrmgus::defines::get()->get_tile_height() + c2->get_pixel_offset().y();
-		return pos1 == pos2 ?
-			   (c1->tilePos.x != c2->tilePos.x ? c1->tilePos.x < c2->tilePos.x : UnitNumber(*c1) < UnitNumber(*c2)) : pos1 < pos2;
-	} else {
-		return drawlevel1 < drawlevel2;
+	const size_t max_moves = count * 8;
+	size_t moves = 0;
+
+	for (size_t i = 1; i < count; ++i) {
+		if (!(entries[i] < entries[i - 1])) {
+			continue;
+		}
+
+		const unit_draw_order_entry entry = entries[i];
+		size_t j = i;
+		do {
+			entries[j] = entries[j - 1];
+			--j;
+			++moves;
+		} while (j > 0 && entry < entries[j - 1]);
+		entries[j] = entry;
+
+		if (moves > max_moves) {
+			std::sort(entries.begin(), entries.begin() + count);
+			return;
+		}
 	}
 }
 
 /**
 **  Find all units to draw in viewport.
 **
+**  The units are sorted starting from the order in which they were drawn in the previous frame, since it rarely changes much from one frame to the next. Units which were not drawn in the previous frame are sorted separately and merged in.
+**
 **  @param vp     Viewport to be drawn.
 **  @param table  Table of units to return in sorted order
 **
@@ -1370,6 +1410,55 @@ int FindAndSortUnits(const CViewport &vp, std::vector<CUnit *> &table)
 		}
 	}
 	Assert(n == table.size());
-	std::sort(table.begin(), table.begin() + n, DrawLevelCompare);
+
+	//the index of each selected unit in the new entries, by unit number, or -1 if not selected or already placed
+	static std::vector<int> entry_indexes;
+	static std::vector<unit_draw_order_entry> new_entries;
+	static std::vector<unit_draw_order_entry> entries;
+
+	const int tile_height = wyrmgus::defines::get()->get_tile_height();
+
+	if (entry_indexes.size() < UnitManager.GetUsedSlotCount()) {
+		entry_indexes.resize(UnitManager.GetUsedSlotCount(), -1);
+	}
+
+	new_entries.clear();
+	for (CUnit *unit : table) {
+		entry_indexes[UnitNumber(*unit)] = static_cast<int>(new_entries.size());
+		new_entries.emplace_back(unit, tile_height);
+	}
+
+	//place the units drawn in the previous frame in their previous order first
+	entries.clear();
+	for (const int unit_number : vp.unit_draw_order) {
+		if (unit_number >= static_cast<int>(entry_indexes.size()) || entry_indexes[unit_number] == -1) {
+			continue;
+		}
+
+		entries.push_back(new_entries[entry_indexes[unit_number]]);
+		entry_indexes[unit_number] = -1;
+	}
+
+	const size_t previous_count = entries.size();
+
+	for (const unit_draw_order_entry &entry : new_entries) {
+		if (entry_indexes[entry.unit_number] == -1) {
+			continue;
+		}
+
+		entries.push_back(entry);
+		entry_indexes[entry.unit_number] = -1;
+	}
+
+	SortNearlySortedDrawOrder(entries, previous_count);
+	std::sort(entries.begin() + previous_count, entries.end());
+	std::inplace_merge(entries.begin(), entries.begin() + previous_count, entries.end());
+
+	vp.unit_draw_order.clear();
+	for (size_t i = 0; i < entries.size(); ++i) {
+		table[i] = entries[i].unit;
+		vp.unit_draw_order.push_back(entries[i].unit_number);
+	}
+
 	return n;
 }
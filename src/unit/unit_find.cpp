@@ -1558,6 +1558,25 @@ CUnit *AttackUnitsInDistance(const CUnit &unit, int range, CUnitFilter pred, boo
 	} else {
 		// If unit is removed, use containers x and y
 		const CUnit *firstContainer = unit.GetFirstContainer();
+
+		//if every unit near the attacker belongs to its own player, there can be no target, so the tile-by-tile search can be skipped; this is not done for neutral units, since e.g. neutral predators can attack other neutral fauna
+		if (unit.Player->Type != PlayerNeutral) {
+			const Vec2i offset(range, range);
+			const Vec2i type_size(firstContainer->Type->get_tile_size() - QSize(1, 1));
+			const QRect search_rect(firstContainer->tilePos - offset, firstContainer->tilePos + type_size + offset);
+			bool has_other_player_unit = false;
+
+			firstContainer->MapLayer->get_unit_buckets().for_each_unit_in_cells(search_rect, [&unit, &has_other_player_unit](const CUnit *other_unit) {
+				if (other_unit->Player != unit.Player) {
+					has_other_player_unit = true;
+				}
+			});
+
+			if (!has_other_player_unit) {
+				return nullptr;
+			}
+		}
+
 		std::vector<CUnit *> table;
 
 		SelectAroundUnit(*firstContainer, range, table,
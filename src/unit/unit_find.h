@@ -34,6 +34,7 @@
 #include "map/map_layer.h"
 #include "pathfinder.h"
 #include "unit/unit.h"
+#include "unit/unit_bucket_grid.h"
 #include "unit/unit_cache.h"
 #include "unit/unit_type.h"
 
@@ -347,8 +348,16 @@ void SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos, std::vector<CUnit *> &u
 	}
 	//Wyrmgus end
 
+	const wyrmgus::unit_bucket_grid &unit_buckets = CMap::Map.MapLayers[z]->get_unit_buckets();
+
 	for (Vec2i posIt = ltPos; posIt.y != rbPos.y + 1; ++posIt.y) {
 		for (posIt.x = ltPos.x; posIt.x != rbPos.x + 1; ++posIt.x) {
+			if (unit_buckets.is_cell_empty(posIt)) {
+				//skip the rest of the cell's tiles in this row, keeping the tile visiting order (and thus the order of the selected units) the same
+				posIt.x = std::min<int>(rbPos.x, wyrmgus::unit_bucket_grid::get_cell_end_x(posIt.x));
+				continue;
+			}
+
 			//Wyrmgus start
 			if (circle) {
 				const double rel_x = posIt.x - middle_x;
@@ -441,8 +450,15 @@ CUnit *FindUnit_IfFixed(const Vec2i &ltPos, const Vec2i &rbPos, int z, Pred pred
 	Assert(CMap::Map.Info.IsPointOnMap(ltPos, z));
 	Assert(CMap::Map.Info.IsPointOnMap(rbPos, z));
 
+	const wyrmgus::unit_bucket_grid &unit_buckets = CMap::Map.MapLayers[z]->get_unit_buckets();
+
 	for (Vec2i posIt = ltPos; posIt.y != rbPos.y + 1; ++posIt.y) {
 		for (posIt.x = ltPos.x; posIt.x != rbPos.x + 1; ++posIt.x) {
+			if (unit_buckets.is_cell_empty(posIt)) {
+				posIt.x = std::min<int>(rbPos.x, wyrmgus::unit_bucket_grid::get_cell_end_x(posIt.x));
+				continue;
+			}
+
 			const CUnitCache &cache = CMap::Map.get_tile_unit_cache(posIt, z);
 
 			CUnitCache::const_iterator it = std::find_if(cache.begin(), cache.end(), pred);
@@ -34,6 +34,7 @@
 //Wyrmgus end
 #include "unit/unit_manager.h"
 #include "unit/unit.h"
+#include "unit/unit_wakeup_scheduler.h"
 #include "iolib.h"
 #include "script.h"
 
@@ -43,6 +44,10 @@ CUnitManager::CUnitManager() : lastCreated(nullptr)
 {
 }
 
+CUnitManager::~CUnitManager()
+{
+}
+
 /**
 **  Initial memory allocation for units.
 */
@@ -51,15 +56,32 @@ void CUnitManager::Init()
 	this->lastCreated = nullptr;
 	//Assert(units.empty());
 	this->units.clear();
-	// Release memory of units in release list.
-	while (!this->released_units.empty()) {
-		CUnit *unit = this->released_units.front();
-		this->released_units.pop_front();
-		delete unit;
+	this->released_units.clear();
+	wyrmgus::unit_wakeup_scheduler::get()->clear();
+
+	// Release the memory of all unit slots
+	this->unit_slabs.clear();
+	this->used_slot_count = 0;
+}
+
+/**
+**  Add a new unit slot, allocating a new slab if the existing ones are full
+**
+**  @return  The unit of the new slot
+*/
+CUnit *CUnitManager::AddSlotUnit()
+{
+	const int slot = static_cast<int>(this->used_slot_count);
+
+	if (slot / CUnitManager::slab_size >= static_cast<int>(this->unit_slabs.size())) {
+		this->unit_slabs.push_back(std::make_unique<CUnit[]>(CUnitManager::slab_size));
 	}
 
-	// Initialize the free unit slots
-	this->unitSlots.clear();
+	++this->used_slot_count;
+
+	CUnit *unit = &this->GetSlotUnit(slot);
+	unit->UnitManagerData.slot = slot;
+	return unit;
 }
 
 /**
@@ -79,11 +101,7 @@ CUnit *CUnitManager::AllocUnit()
 		unit->UnitManagerData.unitSlot = -1;
 		return unit;
 	} else {
-		auto unit = std::make_unique<CUnit>();
-
-		unit->UnitManagerData.slot = unitSlots.size();
-		unitSlots.push_back(unit.get());
-		return unit.release();
+		return this->AddSlotUnit();
 	}
 }
 
@@ -108,6 +126,8 @@ void CUnitManager::ReleaseUnit(CUnit *unit)
 		unit->UnitManagerData.unitSlot = -1;
 		this->units.pop_back();
 	}
+	//a released unit is no longer handled, so it must not be left registered as sleeping
+	wyrmgus::unit_wakeup_scheduler::get()->wake(*unit);
 	this->released_units.push_back(unit);
 	unit->ReleaseCycle = GameCycle + 500; // can be reused after this time
 	//Refs = GameCycle + (NetworkMaxLag << 1); // could be reuse after this time
@@ -115,12 +135,12 @@ void CUnitManager::ReleaseUnit(CUnit *unit)
 
 CUnit &CUnitManager::GetSlotUnit(int index) const
 {
-	return *unitSlots[index];
+	return this->unit_slabs[index / CUnitManager::slab_size][index % CUnitManager::slab_size];
 }
 
 unsigned int CUnitManager::GetUsedSlotCount() const
 {
-	return static_cast<unsigned int>(unitSlots.size());
+	return this->used_slot_count;
 }
 
 CUnitManager::Iterator CUnitManager::begin()
@@ -157,7 +177,7 @@ void CUnitManager::Add(CUnit *unit)
 */
 void CUnitManager::Save(CFile &file) const
 {
-	file.printf("SlotUsage(%lu, {", (long unsigned int)unitSlots.size());
+	file.printf("SlotUsage(%lu, {", (long unsigned int) this->used_slot_count);
 
 	for (const CUnit *unit : this->released_units) {
 		file.printf("{Slot = %d, FreeCycle = %u}, ", UnitNumber(*unit), unit->ReleaseCycle);
@@ -195,9 +215,7 @@ void CUnitManager::Load(lua_State *l)
 		LuaError(l, "incorrect argument");
 	}
 	for (unsigned int i = 0; i < unitCount; i++) {
-		CUnit *unit = new CUnit;
-		unitSlots.push_back(unit);
-		unit->UnitManagerData.slot = i;
+		this->AddSlotUnit();
 	}
 	const unsigned int args = lua_rawlen(l, 2);
 	for (unsigned int i = 0; i < args; i++) {
@@ -217,8 +235,9 @@ void CUnitManager::Load(lua_State *l)
 			}
 		}
 		Assert(unit_index != -1 && cycle != static_cast<unsigned long>(-1));
-		ReleaseUnit(unitSlots[unit_index]);
-		unitSlots[unit_index]->ReleaseCycle = cycle;
+		CUnit *unit = &this->GetSlotUnit(unit_index);
+		ReleaseUnit(unit);
+		unit->ReleaseCycle = cycle;
 		lua_pop(l, 1);
 	}
 }
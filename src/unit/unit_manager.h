@@ -42,6 +42,8 @@ public:
 	typedef std::vector<CUnit *>::iterator Iterator;
 public:
 	CUnitManager();
+	~CUnitManager();
+
 	void Init();
 
 	CUnit *AllocUnit();
@@ -62,9 +64,14 @@ public:
 	unsigned int GetUsedSlotCount() const;
 
 private:
+	static constexpr int slab_size = 256; //how many unit slots are allocated together
+
+	CUnit *AddSlotUnit();
+
 	std::vector<CUnit *> units;
-	std::vector<CUnit *> unitSlots;
-	std::list<CUnit *> released_units;
+	std::vector<std::unique_ptr<CUnit[]>> unit_slabs; //the units are stored contiguously in slabs, which never move, so that unit pointers stay valid while the slots are in use
+	unsigned int used_slot_count = 0;
+	std::deque<CUnit *> released_units;
 	CUnit *lastCreated;
 };
 
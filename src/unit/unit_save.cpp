@@ -311,6 +311,9 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	unit.pathFinderData->output.Save(file);
 
 	file.printf("\"wait\", %d, ", unit.Wait);
+	if (unit.Sleep.SkippedCycles != 0) {
+		file.printf("\"skipped-cycles\", %d, ", unit.Sleep.SkippedCycles);
+	}
 	wyrmgus::animation_set::SaveUnitAnim(file, unit);
 	file.printf(",\n  \"blink\", %d,", unit.Blink);
 	if (unit.Moving) {
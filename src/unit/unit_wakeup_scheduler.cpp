@@ -0,0 +1,208 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include "stratagus.h"
+
+#include "unit/unit_wakeup_scheduler.h"
+
+#include "actions.h"
+#include "animation.h"
+#include "unit/unit.h"
+#include "unit/unit_manager.h"
+#include "util/vector_util.h"
+
+namespace wyrmgus {
+
+void unit_wakeup_scheduler::clear()
+{
+	this->wakeup_queue = {};
+	this->sleeping_unit_slots_by_goal.clear();
+}
+
+void unit_wakeup_scheduler::try_sleep(CUnit &unit)
+{
+	unit.Sleep.SkippedCycles = 0;
+
+	if (unit.Destroyed || unit.Orders.empty() || unit.CriticalOrder != nullptr) {
+		return;
+	}
+
+	const COrder &order = *unit.Orders.front();
+
+	//the unit's order queue must not be about to change when its action is next handled
+	if (!unit.Anim.Unbreakable) {
+		if (order.Finished && (order.Action != UnitAction::Still || unit.Orders.size() > 1)) {
+			return;
+		}
+
+		if (order.Action == UnitAction::StandGround && unit.Orders.size() > 1) {
+			return;
+		}
+	}
+
+	const int sleep_cycles = order.get_sleep_cycles(unit);
+	if (sleep_cycles <= 0) {
+		return;
+	}
+
+	unit.Sleep.Asleep = true;
+	unit.Sleep.Woken = false;
+	unit.Sleep.CountsDownWait = order.counts_down_wait_while_asleep();
+	unit.Sleep.Cycle = GameCycle;
+	unit.Sleep.LastSkippedCycle = GameCycle;
+	unit.Sleep.WakeupCycle = GameCycle + sleep_cycles + 1;
+	unit.Sleep.Goal = order.GetGoal();
+	unit.Sleep.Anim = unit.Anim;
+	unit.Sleep.Wait = unit.Wait;
+
+	const int slot = UnitNumber(unit);
+	this->wakeup_queue.emplace(unit.Sleep.WakeupCycle, slot);
+
+	if (unit.Sleep.Goal != nullptr) {
+		this->sleeping_unit_slots_by_goal[unit.Sleep.Goal].push_back(slot);
+	}
+}
+
+void unit_wakeup_scheduler::wake(CUnit &unit)
+{
+	if (!unit.Sleep.Asleep || unit.Sleep.Woken) {
+		return;
+	}
+
+	unit.Sleep.Woken = true;
+
+	if (unit.Sleep.Goal != nullptr) {
+		const auto find_iterator = this->sleeping_unit_slots_by_goal.find(unit.Sleep.Goal);
+		if (find_iterator != this->sleeping_unit_slots_by_goal.end()) {
+			vector::remove(find_iterator->second, UnitNumber(unit));
+			if (find_iterator->second.empty()) {
+				this->sleeping_unit_slots_by_goal.erase(find_iterator);
+			}
+		}
+
+		unit.Sleep.Goal = nullptr;
+	}
+}
+
+void unit_wakeup_scheduler::wake_and_apply(CUnit &unit)
+{
+	if (!unit.Sleep.Asleep) {
+		return;
+	}
+
+	this->wake(unit);
+	this->apply_skipped_cycles(unit);
+}
+
+void unit_wakeup_scheduler::wake_and_apply_all()
+{
+	for (CUnit *unit : UnitManager) {
+		this->wake_and_apply(*unit);
+	}
+
+	//no unit is sleeping anymore, so all the queue entries are stale
+	this->clear();
+}
+
+void unit_wakeup_scheduler::wake_due_units()
+{
+	while (!this->wakeup_queue.empty() && this->wakeup_queue.top().first <= GameCycle) {
+		const auto [wakeup_cycle, slot] = this->wakeup_queue.top();
+		this->wakeup_queue.pop();
+
+		if (slot >= static_cast<int>(UnitManager.GetUsedSlotCount())) {
+			continue;
+		}
+
+		//the entry is stale if the unit has been woken in the meantime, and may have gone to sleep again with another wakeup cycle
+		CUnit &unit = UnitManager.GetSlotUnit(slot);
+		if (unit.Sleep.Asleep && unit.Sleep.WakeupCycle == wakeup_cycle) {
+			this->wake(unit);
+		}
+	}
+}
+
+void unit_wakeup_scheduler::on_unit_moved(const CUnit &unit)
+{
+	if (this->sleeping_unit_slots_by_goal.empty()) {
+		return;
+	}
+
+	const auto find_iterator = this->sleeping_unit_slots_by_goal.find(&unit);
+	if (find_iterator == this->sleeping_unit_slots_by_goal.end()) {
+		return;
+	}
+
+	const std::vector<int> slots = std::move(find_iterator->second);
+	this->sleeping_unit_slots_by_goal.erase(find_iterator);
+
+	for (const int slot : slots) {
+		CUnit &sleeping_unit = UnitManager.GetSlotUnit(slot);
+		if (sleeping_unit.Sleep.Goal == &unit) {
+			this->wake(sleeping_unit);
+		}
+	}
+}
+
+bool unit_wakeup_scheduler::handle_sleep(CUnit &unit)
+{
+	if (!unit.Sleep.Asleep) {
+		return false;
+	}
+
+	if (!unit.Sleep.Woken) {
+		unit.Sleep.LastSkippedCycle = GameCycle;
+		return true;
+	}
+
+	this->apply_skipped_cycles(unit);
+
+	return false;
+}
+
+void unit_wakeup_scheduler::apply_skipped_cycles(CUnit &unit)
+{
+	//the action wasn't handled in the cycles after the one in which the unit went to sleep, up to the last one in which it was skipped
+	const int skipped_cycles = static_cast<int>(unit.Sleep.LastSkippedCycle - unit.Sleep.Cycle);
+
+	//count the wait timers down as handling the action in the skipped cycles would have, unless something else has changed them in the meantime
+	if (skipped_cycles > 0) {
+		if (unit.Anim.Anim == unit.Sleep.Anim.Anim && unit.Anim.CurrAnim == unit.Sleep.Anim.CurrAnim && unit.Anim.Wait == unit.Sleep.Anim.Wait) {
+			UnitCountDownAnimationWait(unit, skipped_cycles);
+		}
+
+		if (unit.Sleep.CountsDownWait && unit.Wait == unit.Sleep.Wait) {
+			unit.Wait -= skipped_cycles;
+		}
+	}
+
+	unit.Sleep.Asleep = false;
+	unit.Sleep.Woken = false;
+	unit.Sleep.SkippedCycles = std::max(skipped_cycles, 0);
+}
+
+}
@@ -0,0 +1,77 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+#include "util/singleton.h"
+
+class CUnit;
+
+namespace wyrmgus {
+
+/**
+**  Scheduler which lets units sleep through the cycles in which handling their action would only count down their wait timers.
+**
+**  A sleeping unit is woken when the cycle in which it is due comes, or by an event: the unit being attacked, a change of its orders, or the goal of its order moving.
+**  Its timers are counted down for the skipped cycles when it wakes, and its action is then handled in the same position in the unit list as before, so that games stay in sync.
+*/
+class unit_wakeup_scheduler final : public singleton<unit_wakeup_scheduler>
+{
+public:
+	void clear();
+
+	/// Put the unit to sleep if its current order would only count down its wait timers in the following cycles
+	void try_sleep(CUnit &unit);
+
+	/// Wake the unit; the skipped cycles are applied when its action is next handled
+	void wake(CUnit &unit);
+
+	/// Wake the unit and count its wait timers down for the cycles it has slept through so far, for when they are read outside the handling of its action
+	void wake_and_apply(CUnit &unit);
+
+	/// Wake all sleeping units and apply their skipped cycles, so that no unit is sleeping when the game is saved
+	void wake_and_apply_all();
+
+	/// Mark the units which are due in the current cycle as woken
+	void wake_due_units();
+
+	/// Wake the units sleeping with the unit as the goal of their order
+	void on_unit_moved(const CUnit &unit);
+
+	/// Get whether the action of the unit should be skipped in the current cycle; if the unit was woken, its wait timers are counted down for the cycles it slept through
+	bool handle_sleep(CUnit &unit);
+
+private:
+	void apply_skipped_cycles(CUnit &unit);
+
+
+	//units waiting for their wakeup cycle, ordered by the cycle and then by their slot, so that the order in which they are woken is deterministic
+	std::priority_queue<std::pair<unsigned long, int>, std::vector<std::pair<unsigned long, int>>, std::greater<>> wakeup_queue;
+	std::map<const CUnit *, std::vector<int>> sleeping_unit_slots_by_goal;
+};
+
+}
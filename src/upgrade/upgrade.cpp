@@ -1348,6 +1348,8 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 			}
 		}
 	}
+
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::upgrades);
 	
 	//Wyrmgus start
 	for (size_t i = 0; i < um->RemoveUpgrades.size(); ++i) {
@@ -1648,6 +1650,8 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 		}
 	}
 
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::upgrades);
+
 	for (wyrmgus::unit_type *unit_type : wyrmgus::unit_type::get_all()) {
 		if (unit_type->is_template()) {
 			continue;
@@ -2416,6 +2420,7 @@ void AllowUpgradeId(CPlayer &player, int id, char af)
 {
 	Assert(af == 'A' || af == 'F' || af == 'R');
 	player.Allow.Upgrades[id] = af;
+	wyrmgus::condition::on_state_changed(wyrmgus::condition_dependency::upgrades);
 }
 
 /**
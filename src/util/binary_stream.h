@@ -0,0 +1,202 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+namespace wyrmgus {
+
+//writes values into a little-endian binary buffer
+class binary_writer final
+{
+public:
+	const std::string &get_data() const
+	{
+		return this->data;
+	}
+
+	void write_uint8(const uint8_t value)
+	{
+		this->data.push_back(static_cast<char>(value));
+	}
+
+	void write_uint16(const uint16_t value)
+	{
+		this->write_bytes<2>(value);
+	}
+
+	void write_uint32(const uint32_t value)
+	{
+		this->write_bytes<4>(value);
+	}
+
+	void write_uint64(const uint64_t value)
+	{
+		this->write_bytes<8>(value);
+	}
+
+	void write_int16(const int16_t value)
+	{
+		this->write_uint16(static_cast<uint16_t>(value));
+	}
+
+	void write_int32(const int32_t value)
+	{
+		this->write_uint32(static_cast<uint32_t>(value));
+	}
+
+	void write_string(const std::string &str)
+	{
+		this->write_uint32(static_cast<uint32_t>(str.size()));
+		this->data += str;
+	}
+
+	//write an identifier string; each distinct identifier is only written in full the first time, and afterwards referred to by its index
+	void write_identifier(const std::string &identifier)
+	{
+		const auto find_iterator = this->identifier_indexes.find(identifier);
+		if (find_iterator != this->identifier_indexes.end()) {
+			this->write_uint32(find_iterator->second + 1);
+			return;
+		}
+
+		const uint32_t index = static_cast<uint32_t>(this->identifier_indexes.size());
+		this->identifier_indexes[identifier] = index;
+		this->write_uint32(0);
+		this->write_string(identifier);
+	}
+
+private:
+	//append the lowest bytes of a value at once, rather than growing the buffer for each of them
+	template <size_t byte_count>
+	void write_bytes(const uint64_t value)
+	{
+		char bytes[byte_count];
+		for (size_t i = 0; i < byte_count; ++i) {
+			bytes[i] = static_cast<char>(value >> (i * 8));
+		}
+		this->data.append(bytes, byte_count);
+	}
+
+	std::string data;
+	std::unordered_map<std::string, uint32_t> identifier_indexes;
+};
+
+//reads values written by a binary writer
+class binary_reader final
+{
+public:
+	explicit binary_reader(const char *data, const size_t size) : data(data), size(size)
+	{
+	}
+
+	bool is_at_end() const
+	{
+		return this->position == this->size;
+	}
+
+	uint8_t read_uint8()
+	{
+		this->check_remaining(1);
+		return static_cast<uint8_t>(this->data[this->position++]);
+	}
+
+	uint16_t read_uint16()
+	{
+		const uint16_t low = this->read_uint8();
+		const uint16_t high = this->read_uint8();
+		return static_cast<uint16_t>(low | (high << 8));
+	}
+
+	uint32_t read_uint32()
+	{
+		const uint32_t low = this->read_uint16();
+		const uint32_t high = this->read_uint16();
+		return low | (high << 16);
+	}
+
+	uint64_t read_uint64()
+	{
+		const uint64_t low = this->read_uint32();
+		const uint64_t high = this->read_uint32();
+		return low | (high << 32);
+	}
+
+	int16_t read_int16()
+	{
+		return static_cast<int16_t>(this->read_uint16());
+	}
+
+	int32_t read_int32()
+	{
+		return static_cast<int32_t>(this->read_uint32());
+	}
+
+	std::string read_string()
+	{
+		const uint32_t length = this->read_uint32();
+		this->check_remaining(length);
+		std::string str(this->data + this->position, length);
+		this->position += length;
+		return str;
+	}
+
+	//the identifier is returned by value, since the table of identifiers read so far can be reallocated when further ones are read
+	std::string read_identifier()
+	{
+		const uint32_t index = this->read_uint32();
+
+		if (index == 0) {
+			this->identifiers.push_back(this->read_string());
+			return this->identifiers.back();
+		}
+
+		if (index > this->identifiers.size()) {
+			throw std::runtime_error("Invalid identifier index in binary data: " + std::to_string(index) + ".");
+		}
+
+		return this->identifiers[index - 1];
+	}
+
+private:
+	void check_remaining(const size_t count) const
+	{
+		if (count > this->size - this->position) {
+			throw std::runtime_error("Unexpected end of binary data.");
+		}
+	}
+
+	const char *data = nullptr;
+	size_t size = 0;
+	size_t position = 0;
+	std::vector<std::string> identifiers;
+};
+
+}
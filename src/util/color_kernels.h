@@ -0,0 +1,177 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WYRMGUS_IMAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+//the color kernels operate on raw RGBA8888 pixel data, and do not depend on Qt, so that they can be benchmarked on their own
+
+namespace wyrmgus::image {
+
+//get the value of a RGBA8888 pixel as loaded into a little-endian 32-bit integer
+inline constexpr uint32_t get_pixel_value(const int red, const int green, const int blue, const int alpha)
+{
+	return static_cast<uint32_t>(red) | (static_cast<uint32_t>(green) << 8) | (static_cast<uint32_t>(blue) << 16) | (static_cast<uint32_t>(alpha) << 24);
+}
+
+/**
+**	@brief	Replace colors in RGBA8888 pixel data one pixel at a time, keeping the alpha of the pixels
+**
+**	@param	data		The pixel data
+**	@param	begin		The index of the first pixel to process
+**	@param	end			The index after the last pixel to process
+**	@param	old_rgbs	The pixel values of the colors to be replaced, with a zero alpha
+**	@param	new_rgbs	The pixel values of the colors to replace them with, with a zero alpha
+**	@param	color_count	The number of colors
+*/
+inline void replace_colors_scalar(unsigned char *data, const size_t begin, const size_t end, const uint32_t *old_rgbs, const uint32_t *new_rgbs, const size_t color_count)
+{
+	for (size_t i = begin; i < end; ++i) {
+		unsigned char &red = data[i * 4];
+		unsigned char &green = data[i * 4 + 1];
+		unsigned char &blue = data[i * 4 + 2];
+
+		for (size_t z = 0; z < color_count; ++z) {
+			if (get_pixel_value(red, green, blue, 0) == old_rgbs[z]) {
+				red = static_cast<unsigned char>(new_rgbs[z] & 0xFF);
+				green = static_cast<unsigned char>((new_rgbs[z] >> 8) & 0xFF);
+				blue = static_cast<unsigned char>((new_rgbs[z] >> 16) & 0xFF);
+			}
+		}
+	}
+}
+
+//get whether RGBA8888 pixel data contains any of the given colors, ignoring the alpha of the pixels
+inline bool contains_any_color(const unsigned char *data, const size_t pixel_count, const uint32_t *rgbs, const size_t color_count)
+{
+	for (size_t i = 0; i < pixel_count; ++i) {
+		const uint32_t rgb = get_pixel_value(data[i * 4], data[i * 4 + 1], data[i * 4 + 2], 0);
+
+		for (size_t z = 0; z < color_count; ++z) {
+			if (rgb == rgbs[z]) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+#ifdef WYRMGUS_IMAGE_SSE2
+//replace colors four pixels at a time, returning the number of pixels processed; SSE2 implies little-endian, so the pixel values match the 32-bit lanes
+inline size_t replace_colors_sse2(unsigned char *data, const size_t pixel_count, const uint32_t *old_rgbs, const uint32_t *new_rgbs, const size_t color_count)
+{
+	const __m128i rgb_mask = _mm_set1_epi32(static_cast<int32_t>(get_pixel_value(255, 255, 255, 0)));
+
+	size_t i = 0;
+	for (; i + 4 <= pixel_count; i += 4) {
+		__m128i *pixel_ptr = reinterpret_cast<__m128i *>(data + i * 4);
+		__m128i pixels = _mm_loadu_si128(pixel_ptr);
+
+		for (size_t z = 0; z < color_count; ++z) {
+			const __m128i matches = _mm_cmpeq_epi32(_mm_and_si128(pixels, rgb_mask), _mm_set1_epi32(static_cast<int32_t>(old_rgbs[z])));
+			const __m128i replaced_pixels = _mm_or_si128(_mm_andnot_si128(rgb_mask, pixels), _mm_set1_epi32(static_cast<int32_t>(new_rgbs[z])));
+			pixels = _mm_or_si128(_mm_and_si128(matches, replaced_pixels), _mm_andnot_si128(matches, pixels));
+		}
+
+		_mm_storeu_si128(pixel_ptr, pixels);
+	}
+
+	return i;
+}
+#endif
+
+//replace colors in RGBA8888 pixel data, using the vectorized kernel where available and the scalar one for the remaining pixels
+inline void replace_colors(unsigned char *data, const size_t pixel_count, const uint32_t *old_rgbs, const uint32_t *new_rgbs, const size_t color_count)
+{
+	size_t i = 0;
+
+#ifdef WYRMGUS_IMAGE_SSE2
+	i = replace_colors_sse2(data, pixel_count, old_rgbs, new_rgbs, color_count);
+#endif
+
+	replace_colors_scalar(data, i, pixel_count, old_rgbs, new_rgbs, color_count);
+}
+
+//add a color modification to the pixels in [begin, end) of RGBA8888 pixel data one pixel at a time, clamping the result
+inline void apply_color_modification_scalar(unsigned char *data, const size_t begin, const size_t end, const int red, const int green, const int blue)
+{
+	for (size_t i = begin; i < end; ++i) {
+		data[i * 4] = static_cast<unsigned char>(std::clamp(data[i * 4] + red, 0, 255));
+		data[i * 4 + 1] = static_cast<unsigned char>(std::clamp(data[i * 4 + 1] + green, 0, 255));
+		data[i * 4 + 2] = static_cast<unsigned char>(std::clamp(data[i * 4 + 2] + blue, 0, 255));
+	}
+}
+
+#ifdef WYRMGUS_IMAGE_SSE2
+//add a color modification four pixels at a time, returning the number of pixels processed
+inline size_t apply_color_modification_sse2(unsigned char *data, const size_t pixel_count, const int red, const int green, const int blue)
+{
+	//a saturating addition of the positive part and a saturating subtraction of the negative part of each modification gives the same result as clamping the sum
+	const __m128i additions = _mm_set1_epi32(static_cast<int32_t>(get_pixel_value(std::clamp(red, 0, 255), std::clamp(green, 0, 255), std::clamp(blue, 0, 255), 0)));
+	const __m128i subtractions = _mm_set1_epi32(static_cast<int32_t>(get_pixel_value(std::clamp(-red, 0, 255), std::clamp(-green, 0, 255), std::clamp(-blue, 0, 255), 0)));
+
+	size_t i = 0;
+	for (; i + 4 <= pixel_count; i += 4) {
+		__m128i *pixel_ptr = reinterpret_cast<__m128i *>(data + i * 4);
+		const __m128i pixels = _mm_loadu_si128(pixel_ptr);
+		_mm_storeu_si128(pixel_ptr, _mm_subs_epu8(_mm_adds_epu8(pixels, additions), subtractions));
+	}
+
+	return i;
+}
+#endif
+
+/**
+**	@brief	Add a color modification to RGBA8888 pixel data, clamping the result
+**
+**	@param	data		The pixel data
+**	@param	pixel_count	The number of pixels
+**	@param	red			The modification to the red channel
+**	@param	green		The modification to the green channel
+**	@param	blue		The modification to the blue channel
+*/
+inline void apply_color_modification(unsigned char *data, const size_t pixel_count, const int red, const int green, const int blue)
+{
+	size_t i = 0;
+
+#ifdef WYRMGUS_IMAGE_SSE2
+	i = apply_color_modification_sse2(data, pixel_count, red, green, blue);
+#endif
+
+	apply_color_modification_scalar(data, i, pixel_count, red, green, blue);
+}
+
+}
@@ -0,0 +1,109 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace wyrmgus {
+
+/**
+**	@brief	Array whose elements are stamped with the generation in which they were last written
+**
+**	Starting a new generation invalidates every element at once, without having to clear the array: elements
+**	from older generations are only refreshed the next time they are accessed.
+*/
+template <typename T>
+class generation_stamped_array final
+{
+public:
+	explicit generation_stamped_array(const size_t size)
+		: entries(std::make_unique<entry[]>(size)), size(size)
+	{
+	}
+
+	/// Invalidate all elements
+	void next_generation()
+	{
+		++this->generation;
+
+		if (this->generation == 0) {
+			//the generation counter wrapped around, so stamps from old generations could be mistaken for current ones; clear everything instead
+			std::fill_n(this->entries.get(), this->size, entry());
+			this->generation = 1;
+		}
+	}
+
+	/**
+	**	@brief	Get an element, refreshing it first if it was last written in an older generation
+	**
+	**	@param	index				The index of the element
+	**	@param	refresh_function	The function called with the element to bring it up to date, if it is stale
+	**
+	**	@return	The element
+	*/
+	template <typename function_type>
+	T &get(const size_t index, const function_type &refresh_function)
+	{
+		entry &entry = this->entries[index];
+
+		if (entry.generation != this->generation) {
+			refresh_function(entry.value);
+			entry.generation = this->generation;
+		}
+
+		return entry.value;
+	}
+
+	/// Get an element without refreshing it, or null if it was last written in an older generation
+	const T *find(const size_t index) const
+	{
+		const entry &entry = this->entries[index];
+
+		if (entry.generation != this->generation) {
+			return nullptr;
+		}
+
+		return &entry.value;
+	}
+
+private:
+	struct entry final
+	{
+		T value = T();
+		unsigned int generation = 0;
+	};
+
+	std::unique_ptr<entry[]> entries;
+	size_t size = 0;
+	unsigned int generation = 1; //start from generation 1, so that the value-initialized entries count as stale
+};
+
+}
@@ -34,6 +34,56 @@
 
 namespace wyrmgus::image {
 
+//run a function for each index in [0, count) on several threads, each taking the next unprocessed index until none are left
+template <typename function_type>
+static void parallel_for(const size_t count, const function_type &function)
+{
+	std::atomic<size_t> next_index(0);
+	std::exception_ptr exception;
+	std::mutex exception_mutex;
+
+	const auto process_indexes = [&]() {
+		for (size_t i = next_index++; i < count; i = next_index++) {
+			try {
+				function(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(exception_mutex);
+				if (exception == nullptr) {
+					exception = std::current_exception();
+				}
+			}
+		}
+	};
+
+	const size_t thread_count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 1; i < thread_count; ++i) {
+		futures.push_back(std::async(std::launch::async, process_indexes));
+	}
+
+	process_indexes();
+
+	for (std::future<void> &future : futures) {
+		future.wait();
+	}
+
+	if (exception != nullptr) {
+		std::rethrow_exception(exception);
+	}
+}
+
+static QImage scale_single_threaded(const QImage &src_image, const int scale_factor)
+{
+	QImage result_image(src_image.size() * scale_factor, QImage::Format_RGBA8888);
+
+	const unsigned char *src_data = src_image.constBits();
+	unsigned char *dst_data = result_image.bits();
+	xbrz::scale(scale_factor, reinterpret_cast<const uint32_t *>(src_data), reinterpret_cast<uint32_t *>(dst_data), src_image.width(), src_image.height());
+
+	return result_image;
+}
+
 QImage scale(const QImage &src_image, const int scale_factor)
 {
 	if (src_image.format() != QImage::Format_RGBA8888) {
@@ -41,11 +91,29 @@ QImage scale(const QImage &src_image, const int scale_factor)
 		return image::scale(reformatted_src_image, scale_factor);
 	}
 
+	static constexpr int min_slice_height = 32;
+
+	const int slice_count = std::min<int>(std::max(std::thread::hardware_concurrency(), 1u), std::max(src_image.height() / min_slice_height, 1));
+	if (slice_count <= 1) {
+		return scale_single_threaded(src_image, scale_factor);
+	}
+
 	QImage result_image(src_image.size() * scale_factor, QImage::Format_RGBA8888);
 
-	const unsigned char *src_data = src_image.constBits();
-	unsigned char *dst_data = result_image.bits();
-	xbrz::scale(scale_factor, reinterpret_cast<const uint32_t *>(src_data), reinterpret_cast<uint32_t *>(dst_data), src_image.width(), src_image.height());
+	if (result_image.isNull()) {
+		throw std::runtime_error("Failed to allocate image to be scaled.");
+	}
+
+	const uint32_t *src_data = reinterpret_cast<const uint32_t *>(src_image.constBits());
+	uint32_t *dst_data = reinterpret_cast<uint32_t *>(result_image.bits());
+
+	//scale slices of rows on separate threads; xBRZ reads the rows around each slice from the whole source image, so the result is the same as when scaling the image in one go
+	const int slice_height = (src_image.height() + slice_count - 1) / slice_count;
+	parallel_for(static_cast<size_t>(slice_count), [&](const size_t slice_index) {
+		const int y_first = static_cast<int>(slice_index) * slice_height;
+		const int y_last = std::min(y_first + slice_height, src_image.height());
+		xbrz::scale(scale_factor, src_data, dst_data, src_image.width(), src_image.height(), xbrz::ScalerCfg(), y_first, y_last);
+	});
 
 	return result_image;
 }
@@ -72,33 +140,28 @@ QImage scale(const QImage &src_image, const int scale_factor, const QSize &old_f
 		throw std::runtime_error("Failed to allocate image to be scaled.");
 	}
 
-	unsigned char *dst_data = result_image.bits();
-
 	//if a simple scale factor is being used for the resizing, then use xBRZ for the rescaling
 	const int horizontal_frame_count = src_image.width() / old_frame_size.width();
 	const int vertical_frame_count = src_image.height() / old_frame_size.height();
 
-	//scale each frame individually
-	for (int frame_x = 0; frame_x < horizontal_frame_count; ++frame_x) {
-		for (int frame_y = 0; frame_y < vertical_frame_count; ++frame_y) {
-			const QImage src_frame_image = src_image.copy(frame_x * old_frame_size.width(), frame_y * old_frame_size.height(), old_frame_size.width(), old_frame_size.height());
-			QImage result_frame_image = image::scale(src_frame_image, scale_factor);
-
-			const unsigned char *frame_data = result_frame_image.constBits();
-
-			for (int x = 0; x < new_frame_size.width(); ++x) {
-				for (int y = 0; y < new_frame_size.height(); ++y) {
-					const int frame_pixel_index = y * new_frame_size.width() + x;
-					const int pixel_x = frame_x * new_frame_size.width() + x;
-					const int pixel_y = frame_y * new_frame_size.height() + y;
-					const int pixel_index = pixel_y * result_image.width() + pixel_x;
-					for (int i = 0; i < bpp; ++i) {
-						dst_data[pixel_index * bpp + i] = frame_data[frame_pixel_index * bpp + i];
-					}
-				}
-			}
+	//get the pointer to the result data once, since getting it detaches the image, which is not thread-safe
+	unsigned char *dst_data = result_image.bits();
+	const int dst_bytes_per_line = result_image.bytesPerLine();
+
+	//scale each frame individually, with the frames distributed over several threads; each frame is written to its own area of the result image
+	parallel_for(static_cast<size_t>(horizontal_frame_count) * vertical_frame_count, [&](const size_t frame_index) {
+		const int frame_x = static_cast<int>(frame_index) % horizontal_frame_count;
+		const int frame_y = static_cast<int>(frame_index) / horizontal_frame_count;
+
+		const QImage src_frame_image = src_image.copy(frame_x * old_frame_size.width(), frame_y * old_frame_size.height(), old_frame_size.width(), old_frame_size.height());
+		const QImage result_frame_image = scale_single_threaded(src_frame_image, scale_factor);
+
+		for (int y = 0; y < new_frame_size.height(); ++y) {
+			const unsigned char *frame_row = result_frame_image.constScanLine(y);
+			unsigned char *result_row = dst_data + (frame_y * new_frame_size.height() + y) * dst_bytes_per_line + frame_x * new_frame_size.width() * bpp;
+			memcpy(result_row, frame_row, new_frame_size.width() * bpp);
 		}
-	}
+	});
 
 	return result_image;
 }
@@ -275,4 +338,53 @@ void index_to_palette(QImage &image, const color_set &palette)
 	}
 }
 
+/**
+**	@brief	Replace colors in RGBA8888 pixel data, keeping the alpha of the pixels
+**
+**	@param	data		The pixel data
+**	@param	pixel_count	The number of pixels
+**	@param	old_colors	The colors to be replaced
+**	@param	new_colors	The colors to replace them with, in the same order
+**
+**	The replacements are applied in order, so that a pixel whose color was replaced can be replaced again by a later pair, as it would be if each pixel were checked against the colors one by one.
+*/
+void replace_colors(unsigned char *data, const size_t pixel_count, const std::vector<QColor> &old_colors, const std::vector<QColor> &new_colors)
+{
+	const size_t color_count = std::min(old_colors.size(), new_colors.size());
+
+	std::vector<uint32_t> old_rgbs;
+	std::vector<uint32_t> new_rgbs;
+	old_rgbs.reserve(color_count);
+	new_rgbs.reserve(color_count);
+	for (size_t z = 0; z < color_count; ++z) {
+		old_rgbs.push_back(get_pixel_value(old_colors[z].red(), old_colors[z].green(), old_colors[z].blue(), 0));
+		new_rgbs.push_back(get_pixel_value(new_colors[z].red(), new_colors[z].green(), new_colors[z].blue(), 0));
+	}
+
+	image::replace_colors(data, pixel_count, old_rgbs.data(), new_rgbs.data(), color_count);
+}
+
+/**
+**	@brief	Get whether an image contains any of the given colors, ignoring alpha
+**
+**	@param	image	The image
+**	@param	colors	The colors
+**
+**	This stops at the first pixel with one of the colors, and does not build the set of all of the image's colors.
+*/
+bool has_any_color(const QImage &image, const std::vector<QColor> &colors)
+{
+	if (image.format() != QImage::Format_RGBA8888) {
+		return image::has_any_color(image.convertToFormat(QImage::Format_RGBA8888), colors);
+	}
+
+	std::vector<uint32_t> rgbs;
+	rgbs.reserve(colors.size());
+	for (const QColor &color : colors) {
+		rgbs.push_back(get_pixel_value(color.red(), color.green(), color.blue(), 0));
+	}
+
+	return image::contains_any_color(image.constBits(), static_cast<size_t>(image.width()) * image.height(), rgbs.data(), rgbs.size());
+}
+
 }
@@ -28,6 +28,7 @@
 #pragma once
 
 #include "util/color_container.h"
+#include "util/color_kernels.h"
 
 namespace wyrmgus::image {
 
@@ -58,6 +59,11 @@ extern void pack_folder(const std::filesystem::path &dir_path, const frame_order
 
 extern void index_to_palette(QImage &image, const color_set &palette);
 
+//operates on RGBA8888 pixel data, and is safe to call from any thread, as are the kernels in color_kernels.h
+extern void replace_colors(unsigned char *data, const size_t pixel_count, const std::vector<QColor> &old_colors, const std::vector<QColor> &new_colors);
+
+extern bool has_any_color(const QImage &image, const std::vector<QColor> &colors);
+
 inline void index_to_image_palette(QImage &image, const QImage &other_image)
 {
 	image::index_to_palette(image, image::get_colors(other_image));
@@ -0,0 +1,79 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+namespace wyrmgus {
+
+/**
+**	@brief	Fixed-capacity lock-free queue, for passing values from a single producer thread to a single consumer thread
+**
+**	Neither side ever waits for the other: pushing to a full queue and popping from an empty one fail instead.
+*/
+template <typename T, size_t capacity>
+class spsc_queue final
+{
+	static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "The capacity of a single-producer single-consumer queue must be a power of two.");
+
+public:
+	/// Add a value to the queue; must only be called from the producer thread
+	bool push(const T &value)
+	{
+		const size_t write_index = this->write_index.load(std::memory_order_relaxed);
+		if (write_index - this->read_index.load(std::memory_order_acquire) == capacity) {
+			return false;
+		}
+
+		this->values[write_index & (capacity - 1)] = value;
+		this->write_index.store(write_index + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Take the oldest value from the queue; must only be called from the consumer thread
+	bool pop(T &value)
+	{
+		const size_t read_index = this->read_index.load(std::memory_order_relaxed);
+		if (read_index == this->write_index.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		value = this->values[read_index & (capacity - 1)];
+		this->read_index.store(read_index + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T values[capacity];
+	alignas(64) std::atomic<size_t> write_index = 0;
+	alignas(64) std::atomic<size_t> read_index = 0;
+};
+
+}
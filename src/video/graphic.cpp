@@ -50,6 +50,7 @@
 //Wyrmgus end
 #include "util/image_util.h"
 #include "util/point_util.h"
+#include "util/vector_util.h"
 #include "video/video.h"
 #include "xbrz.h"
 
@@ -75,7 +76,288 @@ CGraphic::~CGraphic()
 	}
 
 	for (const auto &kv_pair : this->texture_color_modifications) {
-		glDeleteTextures(this->NumTextures, kv_pair.second.get());
+		glDeleteTextures(this->NumTextures, kv_pair.second.textures.get());
+	}
+
+	this->clear_image();
+}
+
+CGraphic::texture_variant::~texture_variant()
+{
+	CGraphic::unlink_texture_variant(*this);
+	CGraphic::texture_variant_memory_usage -= this->memory_size;
+}
+
+/**
+**  Mark a texture variant as used in the current frame, moving it to the end of the list of variants ordered by when they were last used.
+*/
+void CGraphic::use_texture_variant(const texture_variant &variant)
+{
+	variant.last_used_frame = FrameCounter;
+
+	if (CGraphic::most_recently_used_texture_variant == &variant) {
+		return;
+	}
+
+	CGraphic::unlink_texture_variant(variant);
+
+	variant.previous_used = CGraphic::most_recently_used_texture_variant;
+	if (CGraphic::most_recently_used_texture_variant != nullptr) {
+		CGraphic::most_recently_used_texture_variant->next_used = &variant;
+	} else {
+		CGraphic::least_recently_used_texture_variant = &variant;
+	}
+	CGraphic::most_recently_used_texture_variant = &variant;
+}
+
+void CGraphic::unlink_texture_variant(const texture_variant &variant)
+{
+	if (variant.previous_used == nullptr && CGraphic::least_recently_used_texture_variant != &variant) {
+		return; //not in the list
+	}
+
+	if (variant.previous_used != nullptr) {
+		variant.previous_used->next_used = variant.next_used;
+	} else {
+		CGraphic::least_recently_used_texture_variant = variant.next_used;
+	}
+
+	if (variant.next_used != nullptr) {
+		variant.next_used->previous_used = variant.previous_used;
+	} else {
+		CGraphic::most_recently_used_texture_variant = variant.previous_used;
+	}
+
+	variant.previous_used = nullptr;
+	variant.next_used = nullptr;
+}
+
+/**
+**  Free the least recently used texture variants if their memory usage is over the budget, until it is down to three quarters of the budget, so that the next variants created do not immediately cause more to be freed.
+**
+**  Variants used in the current frame are kept. The freed variants are recreated when they are next drawn.
+*/
+void CGraphic::free_least_recently_used_texture_variants()
+{
+	if (Preference.TextureVariantMemoryBudget <= 0) {
+		return;
+	}
+
+	const size_t budget = static_cast<size_t>(Preference.TextureVariantMemoryBudget) * 1024 * 1024;
+
+	if (CGraphic::texture_variant_memory_usage <= budget) {
+		return;
+	}
+
+	while (CGraphic::texture_variant_memory_usage > budget / 4 * 3) {
+		const texture_variant *variant = CGraphic::least_recently_used_texture_variant;
+
+		if (variant == nullptr || variant->last_used_frame == FrameCounter) {
+			break; //the remaining variants have all been used in the current frame
+		}
+
+		CGraphic *graphic = variant->graphic;
+		glDeleteTextures(graphic->NumTextures, variant->textures.get());
+
+		//erasing the variant from its container unlinks it and updates the memory usage
+		if (variant->player_color == nullptr) {
+			const CColor color_modification = variant->color_modification.value();
+			graphic->texture_color_modifications.erase(color_modification);
+			continue;
+		}
+
+		CPlayerColorGraphic *cg = static_cast<CPlayerColorGraphic *>(graphic);
+		const wyrmgus::player_color *player_color = variant->player_color;
+
+		if (variant->color_modification.has_value()) {
+			const CColor color_modification = variant->color_modification.value();
+			auto find_iterator = cg->player_color_texture_color_modifications.find(player_color);
+			find_iterator->second.erase(color_modification);
+			if (find_iterator->second.empty()) {
+				cg->player_color_texture_color_modifications.erase(find_iterator);
+			}
+		} else {
+			cg->player_color_textures.erase(player_color);
+		}
+	}
+}
+
+/**
+**  Get the image of the graphic, decoding it again if it has been released.
+*/
+const QImage &CGraphic::get_image() const
+{
+	if (!this->image_reloadable) {
+		return this->image;
+	}
+
+	if (this->image_released) {
+		if (this->image_future.valid()) {
+			wyrmgus::vector::remove(CGraphic::image_decoding_graphics, this);
+			this->image = this->image_future.get();
+		} else {
+			this->image = LoadImagePNG(this->get_filepath());
+		}
+		this->image_released = false;
+		CGraphic::decoded_image_memory_usage += static_cast<size_t>(this->image.sizeInBytes());
+		this->use_image();
+		CGraphic::release_least_recently_used_images();
+	} else {
+		this->use_image();
+	}
+
+	return this->image;
+}
+
+/**
+**  Get whether the image of the graphic has been decoded, starting to decode it on a worker thread if it hasn't.
+**
+**  This is used when drawing, so that a placeholder can be drawn until the image is ready instead of waiting for it to be decoded.
+*/
+bool CGraphic::is_image_ready() const
+{
+	if (!this->image_released) {
+		return true;
+	}
+
+	if (!this->image_future.valid()) {
+		if (CGraphic::image_decoding_graphics.size() >= CGraphic::max_image_decoding_graphics) {
+			//take the images which have finished decoding, including those of graphics which haven't been drawn again since, to make room for this one
+			const std::vector<const CGraphic *> image_decoding_graphics = CGraphic::image_decoding_graphics;
+			for (const CGraphic *graphic : image_decoding_graphics) {
+				if (graphic->image_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+					graphic->get_image();
+				}
+			}
+
+			if (CGraphic::image_decoding_graphics.size() >= CGraphic::max_image_decoding_graphics) {
+				return false;
+			}
+		}
+
+		this->image_future = std::async(std::launch::async, LoadImagePNG, this->get_filepath());
+		CGraphic::image_decoding_graphics.push_back(this);
+		return false;
+	}
+
+	if (this->image_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		return false;
+	}
+
+	this->get_image();
+	return true;
+}
+
+/**
+**  Make the textures of the graphic which have been left to be made when it is first drawn, if its image is ready.
+*/
+void CGraphic::request_textures()
+{
+	if (!this->is_image_ready()) {
+		return;
+	}
+
+	if (this->textures == nullptr) {
+		MakeTexture(this, false, nullptr);
+	}
+
+	if (this->grayscale_textures_deferred) {
+		this->grayscale_textures_deferred = false;
+		MakeTexture(this, true, nullptr);
+	}
+
+	CGraphic::release_least_recently_used_images();
+}
+
+/**
+**  Move the graphic to the end of the list of graphics ordered by when their image was last used.
+*/
+void CGraphic::use_image() const
+{
+	if (CGraphic::most_recently_used_image_graphic == this) {
+		return;
+	}
+
+	this->unlink_image();
+
+	this->previous_image_used = CGraphic::most_recently_used_image_graphic;
+	if (CGraphic::most_recently_used_image_graphic != nullptr) {
+		CGraphic::most_recently_used_image_graphic->next_image_used = this;
+	} else {
+		CGraphic::least_recently_used_image_graphic = this;
+	}
+	CGraphic::most_recently_used_image_graphic = this;
+}
+
+void CGraphic::unlink_image() const
+{
+	if (this->previous_image_used == nullptr && CGraphic::least_recently_used_image_graphic != this) {
+		return; //not in the list
+	}
+
+	if (this->previous_image_used != nullptr) {
+		this->previous_image_used->next_image_used = this->next_image_used;
+	} else {
+		CGraphic::least_recently_used_image_graphic = this->next_image_used;
+	}
+
+	if (this->next_image_used != nullptr) {
+		this->next_image_used->previous_image_used = this->previous_image_used;
+	} else {
+		CGraphic::most_recently_used_image_graphic = this->previous_image_used;
+	}
+
+	this->previous_image_used = nullptr;
+	this->next_image_used = nullptr;
+}
+
+void CGraphic::clear_image()
+{
+	if (this->image_reloadable && !this->image_released) {
+		this->unlink_image();
+		CGraphic::decoded_image_memory_usage -= static_cast<size_t>(this->image.sizeInBytes());
+	}
+
+	if (this->image_future.valid()) {
+		//wait for the worker thread to finish decoding the image, which is then discarded
+		this->image_future = std::future<QImage>();
+		wyrmgus::vector::remove(CGraphic::image_decoding_graphics, this);
+	}
+
+	this->image = QImage();
+	this->image_reloadable = false;
+	this->image_released = false;
+	this->grayscale_textures_deferred = false;
+}
+
+/**
+**  Release the least recently used decoded images if their memory usage is over the budget, until it is down to three quarters of the budget.
+**
+**  The most recently used image is always kept, since it is the one about to be used. Released images are decoded again from their file when they are next needed, e.g. to create a player color or time of day texture variant.
+*/
+void CGraphic::release_least_recently_used_images()
+{
+	if (Preference.DecodedImageMemoryBudget <= 0) {
+		return;
+	}
+
+	const size_t budget = static_cast<size_t>(Preference.DecodedImageMemoryBudget) * 1024 * 1024;
+
+	if (CGraphic::decoded_image_memory_usage <= budget) {
+		return;
+	}
+
+	while (CGraphic::decoded_image_memory_usage > budget / 4 * 3) {
+		const CGraphic *graphic = CGraphic::least_recently_used_image_graphic;
+
+		if (graphic == nullptr || graphic == CGraphic::most_recently_used_image_graphic) {
+			break;
+		}
+
+		graphic->unlink_image();
+		CGraphic::decoded_image_memory_usage -= static_cast<size_t>(graphic->image.sizeInBytes());
+		graphic->image = QImage();
+		graphic->image_released = true;
 	}
 }
 
@@ -122,12 +404,12 @@ void CGraphic::DrawGrayscaleSub(int gx, int gy, int w, int h, int x, int y) cons
 CPlayerColorGraphic::~CPlayerColorGraphic()
 {
 	for (const auto &kv_pair : this->player_color_textures) {
-		glDeleteTextures(this->NumTextures, kv_pair.second.get());
+		glDeleteTextures(this->NumTextures, kv_pair.second.textures.get());
 	}
 
 	for (const auto &kv_pair : this->player_color_texture_color_modifications) {
 		for (const auto &sub_kv_pair : kv_pair.second) {
-			glDeleteTextures(this->NumTextures, sub_kv_pair.second.get());
+			glDeleteTextures(this->NumTextures, sub_kv_pair.second.textures.get());
 		}
 	}
 }
@@ -555,7 +837,8 @@ const GLuint *CPlayerColorGraphic::get_textures(const wyrmgus::player_color *pla
 
 	auto find_iterator = this->player_color_textures.find(player_color);
 	if (find_iterator != this->player_color_textures.end()) {
-		return find_iterator->second.get();
+		CGraphic::use_texture_variant(find_iterator->second);
+		return find_iterator->second.textures.get();
 	}
 
 	return nullptr;
@@ -571,7 +854,8 @@ const GLuint *CPlayerColorGraphic::get_textures(const wyrmgus::player_color *pla
 	if (find_iterator != this->player_color_texture_color_modifications.end()) {
 		auto sub_find_iterator = find_iterator->second.find(color_modification);
 		if (sub_find_iterator != find_iterator->second.end()) {
-			return sub_find_iterator->second.get();
+			CGraphic::use_texture_variant(sub_find_iterator->second);
+			return sub_find_iterator->second.textures.get();
 		}
 	}
 
@@ -651,8 +935,8 @@ static void ApplyGrayScale(QImage &image)
 			}
 
 			unsigned char *image_data = image.bits();
-			for (int x = 0; x < image.width(); ++x) {
-				for (int y = 0; y < image.height(); ++y) {
+			for (int y = 0; y < image.height(); ++y) {
+				for (int x = 0; x < image.width(); ++x) {
 					const int pixel_index = (y * image.width() + x) * bpp;
 					unsigned char &red = image_data[pixel_index];
 					unsigned char &green = image_data[pixel_index + 1];
@@ -700,8 +984,8 @@ static void ApplySepiaScale(QImage &image)
 			}
 
 			unsigned char *image_data = image.bits();
-			for (int x = 0; x < image.width(); ++x) {
-				for (int y = 0; y < image.height(); ++y) {
+			for (int y = 0; y < image.height(); ++y) {
+				for (int x = 0; x < image.width(); ++x) {
 					const int pixel_index = (y * image.width() + x) * bpp;
 					unsigned char &red = image_data[pixel_index];
 					unsigned char &green = image_data[pixel_index + 1];
@@ -782,9 +1066,108 @@ static void ConvertImageToMap(SDL_Surface *Surface, int Width, int Height)
 */
 //Wyrmgus end
 
+//the version of the player color flag cache, to be increased whenever how the flag is determined changes
+static constexpr int player_color_flag_cache_version = 1;
+
+/**
+**  Get the path of the file caching whether a graphic's image has any of the colors of its conversible player color.
+**
+**  The cache is keyed by the image file's path, size and modification time, and by the colors of the conversible player color, so that the flag is determined again if any of them changes.
+**
+**  @return  The path of the cache file, or an empty path if there is no cache location.
+*/
+static std::filesystem::path GetPlayerColorFlagCachePath(const CGraphic *g)
+{
+	const std::string cache_path_str = QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString();
+	if (cache_path_str.empty()) {
+		return std::filesystem::path();
+	}
+
+	std::error_code error_code;
+	const uintmax_t file_size = std::filesystem::file_size(g->get_filepath(), error_code);
+	if (error_code) {
+		return std::filesystem::path();
+	}
+
+	const std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(g->get_filepath(), error_code);
+	if (error_code) {
+		return std::filesystem::path();
+	}
+
+	uint64_t hash = 14695981039346656037ULL;
+	const auto hash_value = [&hash](const uint64_t value) {
+		hash ^= value;
+		hash *= 1099511628211ULL;
+		hash ^= hash >> 32;
+	};
+
+	for (const char c : g->get_filepath().string()) {
+		hash_value(static_cast<unsigned char>(c));
+	}
+	hash_value(static_cast<uint64_t>(file_size));
+	hash_value(static_cast<uint64_t>(last_write_time.time_since_epoch().count()));
+	for (const QColor &color : g->get_conversible_player_color()->get_colors()) {
+		hash_value(static_cast<uint64_t>(color.rgba()));
+	}
+
+	char filename[24];
+	snprintf(filename, sizeof(filename), "%016llx", static_cast<unsigned long long>(hash));
+	return std::filesystem::path(cache_path_str) / "player_color_flags" / ("v" + std::to_string(player_color_flag_cache_version)) / filename;
+}
+
+static std::optional<bool> LoadCachedPlayerColorFlag(const std::filesystem::path &cache_filepath)
+{
+	if (cache_filepath.empty()) {
+		return std::nullopt;
+	}
+
+	std::ifstream ifstream(cache_filepath);
+	char c = 0;
+	if (!(ifstream >> c) || (c != '0' && c != '1')) {
+		return std::nullopt;
+	}
+
+	return c == '1';
+}
+
+static void SaveCachedPlayerColorFlag(const std::filesystem::path &cache_filepath, const bool player_color)
+{
+	if (cache_filepath.empty()) {
+		return;
+	}
+
+	//write to a temporary file first, as for the scaled image cache; failing to write to the cache is not an error
+	std::error_code error_code;
+	std::filesystem::create_directories(cache_filepath.parent_path(), error_code);
+	if (error_code) {
+		return;
+	}
+
+	std::filesystem::path temp_filepath = cache_filepath;
+	temp_filepath += ".tmp";
+
+	bool success = false;
+	{
+		std::ofstream ofstream(temp_filepath);
+		ofstream << (player_color ? '1' : '0');
+		success = static_cast<bool>(ofstream);
+	}
+
+	if (success) {
+		std::filesystem::rename(temp_filepath, cache_filepath, error_code);
+		success = !error_code;
+	}
+
+	if (!success) {
+		std::filesystem::remove(temp_filepath, error_code);
+	}
+}
+
 /**
 **  Load a graphic
 **
+**  Only the size of the image is read from its file if the player color flag is cached, with the image being decoded on a worker thread when the graphic is first drawn.
+**
 **  @param grayscale  Make a grayscale surface
 */
 void CGraphic::Load(const bool create_grayscale_textures, const int scale_factor)
@@ -823,33 +1206,28 @@ void CGraphic::Load(const bool create_grayscale_textures, const int scale_factor
 
 	NumFrames = GraphicWidth / Width * GraphicHeight / Height;
 
-	this->player_color = false;
-	const wyrmgus::color_set color_set = wyrmgus::image::get_colors(this->get_image());
-	const wyrmgus::player_color *conversible_player_color = this->get_conversible_player_color();
-	for (const QColor &color : color_set) {
-		if (!this->player_color) {
-			for (const QColor &player_color : conversible_player_color->get_colors()) {
-				if (color.red() == player_color.red() && color.green() == player_color.green() && color.blue() == player_color.blue()) {
-					this->player_color = true;
-					break;
-				}
-			}
+	const std::filesystem::path player_color_flag_cache_filepath = GetPlayerColorFlagCachePath(this);
+	const std::optional<bool> cached_player_color = LoadCachedPlayerColorFlag(player_color_flag_cache_filepath);
+	if (cached_player_color.has_value()) {
+		this->player_color = cached_player_color.value();
+	} else {
+		this->player_color = wyrmgus::image::has_any_color(this->get_image(), this->get_conversible_player_color()->get_colors());
+		SaveCachedPlayerColorFlag(player_color_flag_cache_filepath, this->player_color);
+	}
 
-			if (this->player_color) {
-				break;
-			}
-		}
+	if (this->image_released) {
+		//the image hasn't been decoded, so the textures are made when the graphic is first drawn, with a placeholder being drawn until the image is ready
+		this->grayscale_textures_deferred = create_grayscale_textures;
+	} else {
+		MakeTexture(this, false, nullptr);
 
-		if (this->player_color) {
-			break; //nothing left to check
+		if (create_grayscale_textures) {
+			MakeTexture(this, true, nullptr);
 		}
 	}
-	
-	MakeTexture(this, false, nullptr);
 
-	if (create_grayscale_textures) {
-		MakeTexture(this, true, nullptr);
-	}
+	//the image is not needed again until a texture variant is created, so other images can be released to keep within the budget
+	CGraphic::release_least_recently_used_images();
 
 	CGraphic::graphics.push_back(this);
 
@@ -876,20 +1254,20 @@ void FreeOpenGLGraphics()
 		}
 		
 		for (const auto &kv_pair : graphic->texture_color_modifications) {
-			glDeleteTextures(graphic->NumTextures, kv_pair.second.get());
+			glDeleteTextures(graphic->NumTextures, kv_pair.second.textures.get());
 		}
 		graphic->texture_color_modifications.clear();
 		
 		CPlayerColorGraphic *cg = dynamic_cast<CPlayerColorGraphic *>(graphic);
 		if (cg) {
 			for (const auto &kv_pair : cg->player_color_textures) {
-				glDeleteTextures(cg->NumTextures, kv_pair.second.get());
+				glDeleteTextures(cg->NumTextures, kv_pair.second.textures.get());
 			}
 			cg->player_color_textures.clear();
 			
 			for (const auto &kv_pair : cg->player_color_texture_color_modifications) {
 				for (const auto &sub_kv_pair : kv_pair.second) {
-					glDeleteTextures(cg->NumTextures, sub_kv_pair.second.get());
+					glDeleteTextures(cg->NumTextures, sub_kv_pair.second.textures.get());
 				}
 			}
 			cg->player_color_texture_color_modifications.clear();
@@ -938,23 +1316,63 @@ static int PowerOf2(int x)
 }
 
 /**
-**  Make an OpenGL texture or textures out of a graphic object.
+**  Build the pixel data for an OpenGL texture out of a part of an image.
 **
-**  @param g        The graphic object.
-**  @param texture  Texture.
-**  @param colors   Unit colors.
-**  @param ow       Offset width.
-**  @param oh       Offset height.
+**  This does not use OpenGL, so that the texture data can be built on a worker thread.
+**
+**  @param image        The RGBA8888 image.
+**  @param ow           Offset width.
+**  @param oh           Offset height.
+**  @param time_of_day  The time of day whose color modification is applied, if any.
+**  @param w            Set to the width of the texture.
+**  @param h            Set to the height of the texture.
 */
-void MakeTextures2(const QImage &image, GLuint texture, const int ow, const int oh, const wyrmgus::time_of_day *time_of_day)
+static std::unique_ptr<unsigned char[]> MakeTextureData(const QImage &image, const int ow, const int oh, const wyrmgus::time_of_day *time_of_day, int &w, int &h)
 {
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	int maxw = std::min<int>(image.width() - ow, GLMaxTextureSize);
-	int maxh = std::min<int>(image.height() - oh, GLMaxTextureSize);
-	int w = PowerOf2(maxw);
-	int h = PowerOf2(maxh);
+	if (image.isNull()) {
+		throw std::runtime_error("Cannot generate a texture for a null image.");
+	}
+
+	const int depth = image.depth();
+	const int bpp = depth / 8;
+
+	if (bpp != 4) {
+		throw std::runtime_error("The image BPP must be 4 for generating textures.");
+	}
+
+	const int maxw = std::min<int>(image.width() - ow, GLMaxTextureSize);
+	const int maxh = std::min<int>(image.height() - oh, GLMaxTextureSize);
+	w = PowerOf2(maxw);
+	h = PowerOf2(maxh);
 	auto tex = std::make_unique<unsigned char[]>(w * h * 4);
 
+	const bool has_time_of_day_color_modification = time_of_day != nullptr && time_of_day->HasColorModification();
+
+	//copy row by row, so that both the source and the destination are accessed sequentially
+	for (int y = 0; y < maxh; ++y) {
+		const unsigned char *src_row = image.constScanLine(oh + y) + ow * bpp;
+		unsigned char *dst_row = &tex[y * w * 4];
+		memcpy(dst_row, src_row, maxw * 4);
+
+		if (has_time_of_day_color_modification) {
+			wyrmgus::image::apply_color_modification(dst_row, maxw, time_of_day->ColorModification.R, time_of_day->ColorModification.G, time_of_day->ColorModification.B);
+		}
+	}
+
+	return tex;
+}
+
+/**
+**  Upload pixel data to an OpenGL texture.
+**
+**  @param texture  Texture.
+**  @param tex      The pixel data.
+**  @param w        The width of the texture.
+**  @param h        The height of the texture.
+*/
+static void UploadTexture(GLuint texture, const unsigned char *tex, const int w, const int h)
+{
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glBindTexture(GL_TEXTURE_2D, texture);
 
 	GLenum error_code = glGetError();
@@ -967,79 +1385,272 @@ void MakeTextures2(const QImage &image, GLuint texture, const int ow, const int
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-	int time_of_day_red = 0;
-	int time_of_day_green = 0;
-	int time_of_day_blue = 0;
-	
-	const bool has_time_of_day_color_modification = time_of_day != nullptr && time_of_day->HasColorModification();
-	if (has_time_of_day_color_modification) {
-		time_of_day_red = time_of_day->ColorModification.R;
-		time_of_day_green = time_of_day->ColorModification.G;
-		time_of_day_blue = time_of_day->ColorModification.B;
+	GLint internalformat = GL_RGBA;
+#ifdef USE_OPENGL
+	if (GLTextureCompressionSupported && UseGLTextureCompression) {
+		internalformat = GL_COMPRESSED_RGBA;
 	}
+#endif
 
-	if (image.isNull()) {
-		throw std::runtime_error("Cannot generate a texture for a null image.");
+	glTexImage2D(GL_TEXTURE_2D, 0, internalformat, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex);
+
+	error_code = glGetError();
+	if (error_code != GL_NO_ERROR) {
+		throw std::runtime_error("glTexImage2D failed with error code " + std::to_string(error_code) + ".");
 	}
+}
 
-	const int depth = image.depth();
-	const int bpp = depth / 8;
+/**
+**  Make an OpenGL texture or textures out of a graphic object.
+**
+**  @param image        The RGBA8888 image.
+**  @param texture      Texture.
+**  @param ow           Offset width.
+**  @param oh           Offset height.
+**  @param time_of_day  The time of day whose color modification is applied, if any.
+*/
+void MakeTextures2(const QImage &image, GLuint texture, const int ow, const int oh, const wyrmgus::time_of_day *time_of_day)
+{
+	int w = 0;
+	int h = 0;
+	const std::unique_ptr<unsigned char[]> tex = MakeTextureData(image, ow, oh, time_of_day, w, h);
+	UploadTexture(texture, tex.get(), w, h);
+}
 
-	if (bpp != 4) {
-		throw std::runtime_error("The image BPP must be 4 for generating textures.");
+//the version of the scaled image cache, to be increased whenever the scaling (the xBRZ code or how image::scale handles frames) changes its output; the images of other versions are removed from the cache
+static constexpr int scaled_image_cache_version = 1;
+
+//the maximum size of the scaled image cache on disk; when it is exceeded, the least recently used images are removed until it is back down to three quarters of it
+static constexpr uintmax_t max_scaled_image_cache_size = 512 * 1024 * 1024;
+
+static std::mutex scaled_image_cache_mutex;
+static uintmax_t scaled_image_cache_size = 0;
+static bool scaled_image_cache_pruned = false;
+
+/**
+**  Prune the scaled image cache, removing the images of other cache versions, and the least recently used images if the cache is larger than its maximum size.
+**
+**  The scaled image cache mutex must be locked when calling this.
+**
+**  @param cache_dir_path  The directory of the current cache version.
+*/
+static void PruneScaledImageCache(const std::filesystem::path &cache_dir_path)
+{
+	std::error_code error_code;
+
+	for (const std::filesystem::directory_entry &dir_entry : std::filesystem::directory_iterator(cache_dir_path.parent_path(), error_code)) {
+		if (dir_entry.path() != cache_dir_path) {
+			std::filesystem::remove_all(dir_entry.path(), error_code);
+		}
+	}
+
+	struct cached_image_file {
+		std::filesystem::path path;
+		std::filesystem::file_time_type last_write_time;
+		uintmax_t size = 0;
+	};
+
+	std::vector<cached_image_file> files;
+	uintmax_t cache_size = 0;
+
+	for (const std::filesystem::directory_entry &dir_entry : std::filesystem::directory_iterator(cache_dir_path, error_code)) {
+		//temporary files may be being written to by other threads
+		if (!dir_entry.is_regular_file(error_code) || dir_entry.path().extension() != ".png") {
+			continue;
+		}
+
+		cached_image_file file;
+		file.path = dir_entry.path();
+		file.last_write_time = dir_entry.last_write_time(error_code);
+		file.size = dir_entry.file_size(error_code);
+		if (error_code) {
+			continue;
+		}
+
+		cache_size += file.size;
+		files.push_back(std::move(file));
+	}
+
+	if (cache_size > max_scaled_image_cache_size) {
+		std::sort(files.begin(), files.end(), [](const cached_image_file &lhs, const cached_image_file &rhs) {
+			return lhs.last_write_time < rhs.last_write_time;
+		});
+
+		for (const cached_image_file &file : files) {
+			if (cache_size <= max_scaled_image_cache_size / 4 * 3) {
+				break;
+			}
+
+			if (std::filesystem::remove(file.path, error_code)) {
+				cache_size -= file.size;
+			}
+		}
+	}
+
+	scaled_image_cache_size = cache_size;
+	scaled_image_cache_pruned = true;
+}
+
+/**
+**  Scale an image with xBRZ, reusing the result from the scaled image cache if it has been scaled before.
+**
+**  The cache is content-addressed, keyed by a hash of the source image's pixels, the scaling parameters and the xBRZ configuration, so that the player color and grayscale variants of an image are cached as well.
+**  Reading an image from the cache updates its modification time, which is used to remove the least recently used images when the cache grows too large.
+**
+**  @param image           The RGBA8888 image.
+**  @param scale_factor    The scale factor.
+**  @param old_frame_size  The frame size of the image before scaling.
+**
+**  @return  The scaled image.
+*/
+static QImage ScaleImageCached(const QImage &image, const int scale_factor, const QSize &old_frame_size)
+{
+	const std::string cache_path_str = QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString();
+	if (cache_path_str.empty()) {
+		return wyrmgus::image::scale(image, scale_factor, old_frame_size);
+	}
+
+	//FNV-1a over 64-bit words, with the high bits folded back after each step so that every input bit affects the whole hash
+	uint64_t hash = 14695981039346656037ULL;
+	const auto hash_value = [&hash](const uint64_t value) {
+		hash ^= value;
+		hash *= 1099511628211ULL;
+		hash ^= hash >> 32;
+	};
+
+	hash_value(static_cast<uint64_t>(image.width()));
+	hash_value(static_cast<uint64_t>(image.height()));
+	hash_value(static_cast<uint64_t>(scale_factor));
+	hash_value(static_cast<uint64_t>(old_frame_size.width()));
+	hash_value(static_cast<uint64_t>(old_frame_size.height()));
+
+	const xbrz::ScalerCfg scaler_config;
+	for (const double config_value : { scaler_config.luminanceWeight_, scaler_config.equalColorTolerance_, scaler_config.dominantDirectionThreshold, scaler_config.steepDirectionThreshold, scaler_config.newTestAttribute_ }) {
+		uint64_t config_word = 0;
+		memcpy(&config_word, &config_value, sizeof(uint64_t));
+		hash_value(config_word);
 	}
 
 	const unsigned char *image_data = image.constBits();
-	for (int x = 0; x < maxw; ++x) {
-		for (int y = 0; y < maxh; ++y) {
-			const int src_index = ((oh + y) * image.width() + ow + x) * bpp;
-			const unsigned char &src_red = image_data[src_index];
-			const unsigned char &src_green = image_data[src_index + 1];
-			const unsigned char &src_blue = image_data[src_index + 2];
-			const unsigned char &src_alpha = image_data[src_index + 3];
-
-			const int dst_index = (y * w + x) * 4;
-			unsigned char &dst_red = tex[dst_index];
-			unsigned char &dst_green = tex[dst_index + 1];
-			unsigned char &dst_blue = tex[dst_index + 2];
-			unsigned char &dst_alpha = tex[dst_index + 3];
-
-			dst_red = src_red;
-			dst_green = src_green;
-			dst_blue = src_blue;
-			dst_alpha = src_alpha;
-
-			if (has_time_of_day_color_modification) {
-				if (time_of_day_red != 0) {
-					dst_red = std::max<int>(0, std::min<int>(255, dst_red + time_of_day_red));
-				}
-				if (time_of_day_green != 0) {
-					dst_green = std::max<int>(0, std::min<int>(255, dst_green + time_of_day_green));
-				}
-				if (time_of_day_blue != 0) {
-					dst_blue = std::max<int>(0, std::min<int>(255, dst_blue + time_of_day_blue));
-				}
+	const size_t image_data_size = static_cast<size_t>(image.sizeInBytes());
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= image_data_size; i += sizeof(uint64_t)) {
+		uint64_t word = 0;
+		memcpy(&word, image_data + i, sizeof(uint64_t));
+		hash_value(word);
+	}
+	for (; i < image_data_size; ++i) {
+		hash_value(image_data[i]);
+	}
+
+	char filename[48];
+	snprintf(filename, sizeof(filename), "%016llx_%dx.png", static_cast<unsigned long long>(hash), scale_factor);
+	const std::filesystem::path cache_dir_path = std::filesystem::path(cache_path_str) / "scaled_graphics" / ("v" + std::to_string(scaled_image_cache_version));
+	const std::filesystem::path cache_filepath = cache_dir_path / filename;
+
+	std::error_code error_code;
+
+	{
+		std::lock_guard<std::mutex> lock(scaled_image_cache_mutex);
+		if (!scaled_image_cache_pruned) {
+			PruneScaledImageCache(cache_dir_path);
+		}
+	}
+
+	if (std::filesystem::exists(cache_filepath, error_code)) {
+		QImage cached_image(QString::fromStdString(cache_filepath.string()));
+		if (!cached_image.isNull() && cached_image.size() == image.size() * scale_factor) {
+			std::filesystem::last_write_time(cache_filepath, std::filesystem::file_time_type::clock::now(), error_code);
+
+			if (cached_image.format() != QImage::Format_RGBA8888) {
+				cached_image = cached_image.convertToFormat(QImage::Format_RGBA8888);
 			}
+			return cached_image;
 		}
 	}
 
-	GLint internalformat = GL_RGBA;
-#ifdef USE_OPENGL
-	if (GLTextureCompressionSupported && UseGLTextureCompression) {
-		internalformat = GL_COMPRESSED_RGBA;
+	QImage scaled_image = wyrmgus::image::scale(image, scale_factor, old_frame_size);
+
+	//write to a temporary file first, so that an interrupted write cannot leave a truncated image in the cache; failing to write to the cache is not an error
+	std::filesystem::create_directories(cache_filepath.parent_path(), error_code);
+	if (!error_code) {
+		std::filesystem::path temp_filepath = cache_filepath;
+		temp_filepath += ".tmp";
+
+		bool success = scaled_image.save(QString::fromStdString(temp_filepath.string()), "PNG");
+		if (success) {
+			std::filesystem::rename(temp_filepath, cache_filepath, error_code);
+			success = !error_code;
+		}
+
+		if (success) {
+			const uintmax_t file_size = std::filesystem::file_size(cache_filepath, error_code);
+
+			std::lock_guard<std::mutex> lock(scaled_image_cache_mutex);
+			if (!error_code) {
+				scaled_image_cache_size += file_size;
+			}
+			if (scaled_image_cache_size > max_scaled_image_cache_size) {
+				PruneScaledImageCache(cache_dir_path);
+			}
+		}
+
+		if (!success) {
+			std::filesystem::remove(temp_filepath, error_code);
+		}
 	}
-#endif
 
-	glTexImage2D(GL_TEXTURE_2D, 0, internalformat, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex.get());
+	return scaled_image;
+}
 
-	error_code = glGetError();
-	if (error_code != GL_NO_ERROR) {
-		throw std::runtime_error("glTexImage2D failed with error code " + std::to_string(error_code) + ".");
+/**
+**  Make the OpenGL textures for a graphic which is split into several textures, building the texture data on worker threads.
+*/
+static void MakeTexturesParallel(const CGraphic *g, const QImage &image, const GLuint *textures, const int tw, const int th, const wyrmgus::time_of_day *time_of_day)
+{
+	//build the data for each texture on worker threads, uploading it in order on this thread, since OpenGL calls have to be made on the thread owning the context
+	std::vector<int> texture_widths(g->NumTextures);
+	std::vector<int> texture_heights(g->NumTextures);
+	std::vector<std::future<std::unique_ptr<unsigned char[]>>> texture_data_futures;
+
+	for (int j = 0; j < th; ++j) {
+		for (int i = 0; i < tw; ++i) {
+			const int index = j * tw + i;
+			texture_data_futures.push_back(std::async(std::launch::async, MakeTextureData, std::cref(image), GLMaxTextureSize * i, GLMaxTextureSize * j, time_of_day, std::ref(texture_widths[index]), std::ref(texture_heights[index])));
+		}
+	}
+
+	for (int index = 0; index < g->NumTextures; ++index) {
+		const std::unique_ptr<unsigned char[]> tex = texture_data_futures[index].get();
+		UploadTexture(textures[index], tex.get(), texture_widths[index], texture_heights[index]);
 	}
 }
 
+/**
+**  Get the estimated video memory used by a set of textures for a graphic.
+*/
+static size_t GetTextureMemorySize(const CGraphic *g)
+{
+	size_t memory_size = 0;
+
+	for (int y = 0; y < g->get_height(); y += GLMaxTextureSize) {
+		for (int x = 0; x < g->get_width(); x += GLMaxTextureSize) {
+			const int w = PowerOf2(std::min<int>(g->get_width() - x, GLMaxTextureSize));
+			const int h = PowerOf2(std::min<int>(g->get_height() - y, GLMaxTextureSize));
+			memory_size += static_cast<size_t>(w) * h * 4;
+		}
+	}
+
+	return memory_size;
+}
+
 static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::player_color *player_color, const wyrmgus::time_of_day *time_of_day)
 {
+	//texture variants are only made when drawing, so rather than waiting for the image to be decoded, a placeholder is drawn until it is ready
+	if ((player_color != nullptr || (time_of_day && time_of_day->HasColorModification())) && !g->is_image_ready()) {
+		return;
+	}
+
 	const int tw = (g->get_width() - 1) / GLMaxTextureSize + 1;
 	const int th = (g->get_height() - 1) / GLMaxTextureSize + 1;
 
@@ -1059,11 +1670,10 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 
 	CPlayerColorGraphic *cg = dynamic_cast<CPlayerColorGraphic *>(g);
 	GLuint *textures = nullptr;
+	CGraphic::texture_variant *variant = nullptr;
 	if (!player_color || !cg) {
 		if (time_of_day && time_of_day->HasColorModification()) {
-			g->texture_color_modifications[time_of_day->ColorModification] = std::make_unique<GLuint[]>(g->NumTextures);
-			textures = g->texture_color_modifications[time_of_day->ColorModification].get();
-			glGenTextures(g->NumTextures, g->texture_color_modifications[time_of_day->ColorModification].get());
+			variant = &g->texture_color_modifications[time_of_day->ColorModification];
 		} else if (grayscale) {
 			g->grayscale_textures = std::make_unique<GLuint[]>(g->NumTextures);
 			textures = g->grayscale_textures.get();
@@ -1074,13 +1684,24 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 			glGenTextures(g->NumTextures, g->textures.get());
 		}
 	} else if (time_of_day && time_of_day->HasColorModification()) {
-		cg->player_color_texture_color_modifications[player_color][time_of_day->ColorModification] = std::make_unique<GLuint[]>(cg->NumTextures);
-		textures = cg->player_color_texture_color_modifications[player_color][time_of_day->ColorModification].get();
-		glGenTextures(cg->NumTextures, cg->player_color_texture_color_modifications[player_color][time_of_day->ColorModification].get());
+		variant = &cg->player_color_texture_color_modifications[player_color][time_of_day->ColorModification];
+		variant->player_color = player_color;
 	} else {
-		cg->player_color_textures[player_color] = std::make_unique<GLuint[]>(cg->NumTextures);
-		textures = cg->player_color_textures[player_color].get();
-		glGenTextures(cg->NumTextures, cg->player_color_textures[player_color].get());
+		variant = &cg->player_color_textures[player_color];
+		variant->player_color = player_color;
+	}
+
+	if (variant != nullptr) {
+		variant->graphic = g;
+		if (time_of_day && time_of_day->HasColorModification()) {
+			variant->color_modification = time_of_day->ColorModification;
+		}
+		variant->textures = std::make_unique<GLuint[]>(g->NumTextures);
+		variant->memory_size = GetTextureMemorySize(g);
+		CGraphic::texture_variant_memory_usage += variant->memory_size;
+		CGraphic::use_texture_variant(*variant);
+		textures = variant->textures.get();
+		glGenTextures(g->NumTextures, textures);
 	}
 
 	const GLenum error_code = glGetError();
@@ -1100,31 +1721,8 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 			ApplyGrayScale(image);
 		}
 	} else if (player_color != nullptr && g->has_player_color()) {
-		const int bpp = image.depth() / 8;
-
-		if (bpp < 3) {
-			throw std::runtime_error("Image BPP must be at least 3.");
-		}
-
-		unsigned char *image_data = image.bits();
 		const wyrmgus::player_color *conversible_player_color = g->get_conversible_player_color();
-		const std::vector<QColor> &conversible_colors = conversible_player_color->get_colors();
-		const std::vector<QColor> &colors = player_color->get_colors();
-
-		for (int i = 0; i < image.sizeInBytes(); i += bpp) {
-			unsigned char &red = image_data[i];
-			unsigned char &green = image_data[i + 1];
-			unsigned char &blue = image_data[i + 2];
-
-			for (size_t z = 0; z < conversible_colors.size(); ++z) {
-				const QColor &color = conversible_colors[z];
-				if (red == color.red() && green == color.green() && blue == color.blue()) {
-					red = colors[z].red();
-					green = colors[z].green();
-					blue = colors[z].blue();
-				}
-			}
-		}
+		wyrmgus::image::replace_colors(image.bits(), static_cast<size_t>(image.width()) * image.height(), conversible_player_color->get_colors(), player_color->get_colors());
 	}
 
 	if (image.size() != g->get_size()) {
@@ -1132,7 +1730,7 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 		if (g->get_width() > image.width() && g->get_height() > image.height() && (g->get_width() % image.width()) == 0 && (g->get_height() % image.height()) == 0 && (g->get_width() / image.width()) == (g->get_height() / image.height())) {
 			//if a simple scale factor is being used for the resizing, then use xBRZ for the rescaling
 			const int scale_factor = g->get_width() / image.width();
-			image = wyrmgus::image::scale(image, scale_factor, g->get_original_frame_size());
+			image = ScaleImageCached(image, scale_factor, g->get_original_frame_size());
 		} else {
 			image = image.scaled(g->get_size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 			if (image.format() != QImage::Format_RGBA8888) {
@@ -1142,10 +1740,14 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 		}
 	}
 
-	for (int j = 0; j < th; ++j) {
-		for (int i = 0; i < tw; ++i) {
-			MakeTextures2(image, textures[j * tw + i], GLMaxTextureSize * i, GLMaxTextureSize * j, time_of_day);
-		}
+	if (g->NumTextures == 1) {
+		MakeTextures2(image, textures[0], 0, 0, time_of_day);
+	} else {
+		MakeTexturesParallel(g, image, textures, tw, th, time_of_day);
+	}
+
+	if (variant != nullptr) {
+		CGraphic::free_least_recently_used_texture_variants();
 	}
 }
 
@@ -1188,6 +1790,12 @@ void MakePlayerColorTexture(CPlayerColorGraphic *g, const wyrmgus::player_color
 		if (g->get_textures(player_color) != nullptr) {
 			return;
 		}
+
+		if (!g->has_player_color() || player_color == nullptr || player_color == g->get_conversible_player_color()) {
+			//the base textures are used, which are made when the graphic is first drawn
+			g->request_textures();
+			return;
+		}
 	}
 
 	MakeTextures(g, false, player_color, time_of_day);
@@ -1266,9 +1874,7 @@ void CGraphic::SetOriginalSize()
 		return;
 	}
 	
-	if (!this->get_image().isNull()) {
-		this->image = QImage();
-	}
+	this->clear_image();
 	this->frame_map.clear();
 
 	if (this->textures != nullptr) {
@@ -1282,7 +1888,6 @@ void CGraphic::SetOriginalSize()
 	}
 
 	this->Width = this->Height = 0;
-	this->image = QImage();
 	this->Load();
 
 	this->Resized = false;
@@ -55,6 +55,38 @@ private:
 	png_infop info_ptr;
 };
 
+/**
+**  Decode a png image file, converting it to the RGBA8888 or RGB888 format if it has 4 or 3 bytes per pixel.
+**
+**  @param filepath  The path of the image file.
+**
+**  @return  The decoded image.
+*/
+QImage LoadImagePNG(const std::filesystem::path &filepath)
+{
+	QImage image(QString::fromStdString(filepath.string()));
+	if (image.isNull()) {
+		throw std::runtime_error("Failed to load the \"" + filepath.string() + "\" image file.");
+	}
+
+	if (image.width() == 0) {
+		throw std::runtime_error("The \"" + filepath.string() + "\" image has no width.");
+	}
+
+	if (image.height() == 0) {
+		throw std::runtime_error("The \"" + filepath.string() + "\" image has no width.");
+	}
+
+	const int bpp = image.depth() / 8;
+	if (bpp == 4 && image.format() != QImage::Format_RGBA8888) {
+		image = image.convertToFormat(QImage::Format_RGBA8888);
+	} else if (bpp == 3 && image.format() != QImage::Format_RGB888) {
+		image = image.convertToFormat(QImage::Format_RGB888);
+	}
+
+	return image;
+}
+
 /**
 **  Load a png graphic file.
 **
@@ -80,29 +112,24 @@ int LoadGraphicPNG(CGraphic *g, const int scale_factor)
 	}
 
 	g->set_filepath(filepath);
-	g->image = QImage(QString::fromStdString(filepath.string()));
-	if (g->get_image().isNull()) {
-		throw std::runtime_error("Failed to load the \"" + filepath.string() + "\" image file.");
-	}
-
-	if (g->get_image().width() == 0) {
-		throw std::runtime_error("The \"" + filepath.string() + "\" image has no width.");
-	}
-
-	if (g->get_image().height() == 0) {
-		throw std::runtime_error("The \"" + filepath.string() + "\" image has no width.");
-	}
 
-	const int bpp = g->image.depth() / 8;
-	if (bpp == 4 && g->image.format() != QImage::Format_RGBA8888) {
-		g->image = g->image.convertToFormat(QImage::Format_RGBA8888);
-	} else if (bpp == 3 && g->image.format() != QImage::Format_RGB888) {
-		g->image = g->image.convertToFormat(QImage::Format_RGB888);
+	//the image is decoded from the file as it is, so it can be released and decoded again
+	g->image_reloadable = true;
+
+	//only read the size from the file's header, leaving the image to be decoded when it is first needed
+	QSize size = QImageReader(QString::fromStdString(filepath.string())).size();
+	if (size.isValid() && !size.isEmpty()) {
+		g->image_released = true;
+	} else {
+		g->image = LoadImagePNG(filepath);
+		CGraphic::decoded_image_memory_usage += static_cast<size_t>(g->image.sizeInBytes());
+		g->use_image();
+		size = g->image.size();
 	}
 
-	g->GraphicWidth = g->get_image().width();
-	g->GraphicHeight = g->get_image().height();
-	g->original_size = g->get_image().size();
+	g->GraphicWidth = size.width();
+	g->GraphicHeight = size.height();
+	g->original_size = size;
 
 	return 0;
 }
@@ -33,6 +33,9 @@
 #include "stratagus.h"
 #include "video/video.h"
 
+//the opacity of the placeholder drawn for a graphic whose image is still being decoded
+static constexpr unsigned char placeholder_alpha = 64;
+
 /** Draw a rectangular part of a CGraphic to the screen.
 **
 **  This function does not attempt to clip the CGraphic based on the
@@ -78,6 +81,13 @@ void DrawTexture(const CGraphic *g, const GLuint *textures,
 	// sx and sy coordinates are on the screen.  This function does not
 	//           know what the origin is there.
 
+	if (textures == nullptr) {
+		//the graphic's image is still being decoded, so draw a placeholder until its textures have been made
+		const_cast<CGraphic *>(g)->request_textures();
+		Video.FillTransRectangle(ColorBlack, sx_beg, sy_beg, gx_end - gx_beg, gy_end - gy_beg, placeholder_alpha);
+		return;
+	}
+
 	Assert(0 <= gx_beg);
 	Assert(0 <= gy_beg);
 	Assert(gx_beg <= gx_end); // draws nothing if equal
@@ -67,9 +67,50 @@ class CGraphic : public gcn::Image
 	};
 
 public:
+	//a set of generated textures for a variant of a graphic (e.g. for a player color or time of day), which can be freed when it has not been used recently, and is then recreated on demand
+	struct texture_variant final
+	{
+		texture_variant()
+		{
+		}
+
+		texture_variant(const texture_variant &other) = delete;
+		texture_variant &operator =(const texture_variant &other) = delete;
+
+		~texture_variant();
+
+		std::unique_ptr<GLuint[]> textures;
+		size_t memory_size = 0; //the estimated video memory used by the textures, in bytes
+		CGraphic *graphic = nullptr;
+		const wyrmgus::player_color *player_color = nullptr; //the player color of the variant, if it is a player color variant
+		std::optional<CColor> color_modification; //the color modification of the variant, if it is a time of day variant
+		mutable unsigned long last_used_frame = 0;
+		mutable const texture_variant *previous_used = nullptr; //the variant used before this one, in the list of variants ordered by when they were last used
+		mutable const texture_variant *next_used = nullptr;
+	};
+
 	static std::map<std::string, std::weak_ptr<CGraphic>> graphics_by_filepath;
 	static std::list<CGraphic *> graphics;
 
+	//the texture variants ordered by when they were last used, so that the least recently used ones can be freed when over the memory budget
+	static inline const texture_variant *least_recently_used_texture_variant = nullptr;
+	static inline const texture_variant *most_recently_used_texture_variant = nullptr;
+	static inline size_t texture_variant_memory_usage = 0;
+
+	//the graphics whose decoded image can be released, ordered by when their image was last used; images are only decoded and used on the main thread
+	static inline const CGraphic *least_recently_used_image_graphic = nullptr;
+	static inline const CGraphic *most_recently_used_image_graphic = nullptr;
+	static inline size_t decoded_image_memory_usage = 0;
+
+	//the graphics whose image is being decoded on a worker thread, since they were drawn before it had been decoded; at most a few images are decoded at the same time
+	static constexpr size_t max_image_decoding_graphics = 8;
+	static inline std::vector<const CGraphic *> image_decoding_graphics;
+
+	static void use_texture_variant(const texture_variant &variant);
+	static void unlink_texture_variant(const texture_variant &variant);
+	static void free_least_recently_used_texture_variants();
+	static void release_least_recently_used_images();
+
 protected:
 	static inline std::shared_mutex mutex;
 
@@ -124,7 +165,7 @@ public:
 	void Resize(int w, int h);
 	void SetOriginalSize();
 
-	inline bool IsLoaded() const { return !this->image.isNull(); }
+	inline bool IsLoaded() const { return !this->image.isNull() || this->image_released; }
 
 	const std::filesystem::path &get_filepath() const
 	{
@@ -197,10 +238,9 @@ public:
 	int get_frame_index(const QPoint &frame_pos) const;
 	QPoint get_frame_pos(const int frame_index) const;
 
-	const QImage &get_image() const
-	{
-		return this->image;
-	}
+	const QImage &get_image() const;
+	bool is_image_ready() const;
+	void request_textures();
 
 	const wyrmgus::player_color *get_conversible_player_color() const;
 
@@ -218,7 +258,8 @@ public:
 	{
 		auto find_iterator = this->texture_color_modifications.find(color_modification);
 		if (find_iterator != this->texture_color_modifications.end()) {
-			return find_iterator->second.get();
+			CGraphic::use_texture_variant(find_iterator->second);
+			return find_iterator->second.textures.get();
 		}
 
 		return nullptr;
@@ -234,7 +275,17 @@ private:
 public:
 	std::string HashFile;      /// Filename used in hash
 private:
-	QImage image;
+	void use_image() const;
+	void unlink_image() const;
+	void clear_image();
+
+	mutable QImage image;
+	bool image_reloadable = false; //whether the image is decoded from the graphic's file as it is, so that it can be released when not in use and decoded again when needed
+	mutable bool image_released = false;
+	mutable const CGraphic *previous_image_used = nullptr; //the graphic whose image was used before this one's, in the list of graphics ordered by when their image was last used
+	mutable const CGraphic *next_image_used = nullptr;
+	mutable std::future<QImage> image_future; //the image being decoded on a worker thread, if it was needed for drawing before it had been decoded
+	bool grayscale_textures_deferred = false; //whether the grayscale textures are to be made once the image has been decoded
 public:
 	std::vector<frame_pos_t> frame_map;
 	std::vector<frame_pos_t> frameFlip_map;
@@ -255,7 +306,7 @@ public:
 	GLfloat TextureHeight = 0.f;     /// Height of the texture
 	std::unique_ptr<GLuint[]> textures; //texture names
 	std::unique_ptr<GLuint[]> grayscale_textures;
-	std::map<CColor, std::unique_ptr<GLuint[]>> texture_color_modifications; //textures with a color modification applied to them
+	std::map<CColor, texture_variant> texture_color_modifications; //textures with a color modification applied to them
 	int NumTextures = 0;           /// Number of textures
 private:
 	int custom_scale_factor = 1; //the scale factor of the loaded image, if it is a custom scaled image
@@ -294,8 +345,8 @@ public:
 	const GLuint *get_textures(const wyrmgus::player_color *player_color) const;
 	const GLuint *get_textures(const wyrmgus::player_color *player_color, const CColor &color_modification) const;
 
-	std::map<const wyrmgus::player_color *, std::unique_ptr<GLuint[]>> player_color_textures;
-	std::map<const wyrmgus::player_color *, std::map<CColor, std::unique_ptr<GLuint[]>>> player_color_texture_color_modifications; //player color textures with a color modification applied to them
+	std::map<const wyrmgus::player_color *, texture_variant> player_color_textures;
+	std::map<const wyrmgus::player_color *, std::map<CColor, texture_variant>> player_color_texture_color_modifications; //player color textures with a color modification applied to them
 };
 
 /**
@@ -522,6 +573,7 @@ void DeInitVideo();
 extern int VideoValidResolution(int w, int h);
 
 /// Load graphic from PNG file
+extern QImage LoadImagePNG(const std::filesystem::path &filepath);
 extern int LoadGraphicPNG(CGraphic *g, const int scale_factor);
 
 #if defined(USE_OPENGL) || defined(USE_GLES)